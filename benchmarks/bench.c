@@ -0,0 +1,675 @@
+/**
+ * @file bench.c
+ * @brief Throughput microbenchmarks for every library module.
+ *
+ * Each kernel is called repeatedly until --min-time ms have elapsed; the
+ * best of three such runs is reported as millions of items per second
+ * (samples, symbols or bits — see the unit column).  Results can be
+ * written as JSON and compared against a stored baseline, flagging any
+ * kernel that got slower than the tolerance allows.
+ *
+ * Build:  make build/bin/bench
+ * Run:    make bench                 (writes build/bench.json)
+ *         make bench_baseline        (stores benchmarks/baseline.json)
+ *         make bench_compare         (exit 1 on regression)
+ *
+ * Options:
+ *   --json FILE        write results as JSON
+ *   --compare FILE     compare against a baseline JSON file
+ *   --tolerance F      allowed slowdown before flagging (default 0.10)
+ *   --filter STR       run only benchmarks whose name contains STR
+ *   --min-time MS      time per measurement run (default 50)
+ *   --quick            same as --min-time 5
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/comms_utils.h"
+#include "../include/modulation.h"
+#include "../include/coding.h"
+#include "../include/channel.h"
+#include "../include/sync.h"
+#include "../include/ofdm.h"
+#include "../include/spread_spectrum.h"
+#include "../include/equaliser.h"
+#include "../include/phy.h"
+#include "../include/analog_demod.h"
+#include "../include/fixed_point.h"
+
+#define MAX_N        65536
+#define MAX_RESULTS  256
+
+/* ── Result table ────────────────────────────────────────────────── */
+
+typedef struct {
+    char   name[64];
+    char   unit[16];
+    double value;            /* millions of units per second */
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int         n_results;
+static double      min_ms = 50.0;
+static const char *filter;
+
+/* ── Shared buffers (sized for the largest case) ─────────────────── */
+
+static Cplx    src[MAX_N], work[MAX_N], out[MAX_N];
+static real_t  rsrc[MAX_N], rout[MAX_N + 256];
+static real_t  llr[MAX_N];
+static double  dout[MAX_N];
+static uint8_t bits[MAX_N], bits2[MAX_N];
+static CplxBuf soa;
+static CplxQ15 q15buf[MAX_N], q15src[MAX_N];
+static q15_t   llr_q[MAX_N];
+static CommsArena arena;
+static Cplx    sync_in[MAX_N];
+
+/* Current problem size / parameters for the kernel under test */
+static int     cur_n;
+static int     cur_taps;
+static ModScheme cur_mod;
+static OfdmParams cur_ofdm;
+static OfdmSync cur_sync;
+static PfbChanneliser cur_pfb;
+static FastConv cur_fc;
+static OfdmPool cur_pool;
+static ViterbiDecoder cur_vit;
+static HuffmanTable cur_huff;
+static int     cur_nbits;
+static uint8_t mt_bits[2 * MAX_N];
+static LoraParams cur_lora;
+static LmsEqualiser cur_lms;
+static RlsEqualiser cur_rls;
+static DfeEqualiser cur_dfe;
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Timing harness
+ * ════════════════════════════════════════════════════════════════════ */
+
+static int selected(const char *name)
+{
+    return !filter || strstr(name, filter) != NULL;
+}
+
+/* Best-of-three mean time per call, in ms */
+static double time_kernel(void (*fn)(void))
+{
+    fn();   /* warm caches and lazy tables */
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        long iters = 0;
+        double t0 = get_time_ms(), elapsed;
+        do {
+            fn();
+            iters++;
+            elapsed = get_time_ms() - t0;
+        } while (elapsed < min_ms);
+        if (elapsed / iters < best) best = elapsed / iters;
+    }
+    return best;
+}
+
+/* Time fn and record items_per_call / time as M<unit>/s */
+static void run(const char *name, const char *unit, double items_per_call,
+                void (*fn)(void))
+{
+    if (!selected(name) || n_results >= MAX_RESULTS) return;
+    double ms = time_kernel(fn);
+    BenchResult *r = &results[n_results++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    snprintf(r->unit, sizeof(r->unit), "M%s/s", unit);
+    r->value = items_per_call / (ms * 1e3);
+    printf("  %-32s %12.3f %s\n", r->name, r->value, r->unit);
+    fflush(stdout);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Kernels
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* FFTs run on a fresh copy each call so magnitudes stay bounded */
+static void k_fft(void)
+{
+    memcpy(work, src, cur_n * sizeof(Cplx));
+    fft(work, cur_n);
+}
+
+static const FftPlan *cur_plan;
+
+/* Out-of-place planned FFT: no copy, no scratch for mixed radix */
+static void k_fft_plan(void)
+{
+    fft_execute(cur_plan, src, work);
+}
+
+/* Real input: one half-length FFT + split */
+static void k_rfft(void)
+{
+    rfft(rsrc, work, cur_n);
+}
+
+/* Long real FIR: direct loop vs overlap-save (rsrc doubles as taps) */
+static void k_fir_direct(void)
+{
+    memset(rout, 0, sizeof(rout));
+    for (int i = 0; i + cur_taps < cur_n; i++)
+        for (int k = 0; k < cur_taps; k++)
+            rout[i + k] += rsrc[i] * rsrc[MAX_N - 1 - k];
+}
+
+static void k_fastconv(void)
+{
+    fastconv_process_real(&cur_fc, rsrc, cur_n, rout);
+}
+
+static void k_fft_soa(void)
+{
+    cplxbuf_from_cplx(&soa, src, cur_n);
+    fft_soa(&soa, cur_n);
+}
+
+static void k_fft_q15(void)
+{
+    memcpy(q15buf, q15src, cur_n * sizeof(CplxQ15));
+    fft_q15(q15buf, cur_n);
+}
+
+static void k_conv_encode(void)      { conv_encode(bits, cur_n, bits2); }
+static void k_conv_encode_bytes(void)
+{
+    conv_encode_bytes(0, bits, cur_n / 8, bits2);
+}
+static void k_viterbi_hard(void)     { viterbi_decode(bits2, 2 * cur_n, bits); }
+static void k_viterbi_soft(void)     { viterbi_decode_soft(llr, 2 * cur_n, bits); }
+static void k_viterbi_q15(void)      { viterbi_decode_soft_q15(llr_q, 2 * cur_n, bits); }
+static void k_viterbi_stream(void)
+{
+    int m = 0;
+    for (int i = 0; i < 2 * cur_n; i += 1500) {
+        int c = 2 * cur_n - i < 1500 ? 2 * cur_n - i : 1500;
+        m += viterbi_process_soft(&cur_vit, llr + i, c, bits + m);
+    }
+    viterbi_flush(&cur_vit, bits + m);
+}
+static void k_viterbi_punct(void)
+{
+    int n = conv_punctured_len(CONV_RATE_3_4, 2 * cur_n);
+    viterbi_decode_punctured(CONV_RATE_3_4, llr, n, bits);
+}
+static void k_crc32(void)            { crc32(bits, cur_n); }
+static void k_crc16(void)            { crc16_ccitt(bits, cur_n); }
+static void k_crc24(void)            { crc24_adsb(bits, cur_n); }
+static void k_huff_enc(void)
+{
+    huffman_encode_packed(&cur_huff, bits, cur_n, bits2, MAX_N);
+}
+static void k_huff_dec(void)
+{
+    huffman_decode_packed(&cur_huff, bits2, cur_nbits, mt_bits, cur_n);
+}
+static void k_scrambler(void)        { scrambler(0x48, 0x7F, bits, cur_n); }
+
+static void k_mod(void)
+{
+    mod_modulate(cur_mod, bits, cur_n * mod_bits_per_symbol(cur_mod), out);
+}
+
+static void k_demod_hard(void)       { mod_demodulate(cur_mod, src, cur_n, bits2); }
+static void k_demod_soft(void)       { mod_demodulate_soft(cur_mod, src, cur_n, 0.3, llr); }
+static void k_awgn(void)             { channel_awgn(src, cur_n, 10.0, out); }
+
+static void k_pulse_shape(void)
+{
+    static real_t h[8 * 4 + 1];
+    static int hlen;
+    if (!hlen) hlen = root_raised_cosine(0.35, 4, 8, h);
+    pulse_shape(rsrc, cur_n, h, hlen, 4, rout);
+}
+
+static void k_costas(void)
+{
+    CarrierSync cs;
+    carrier_init(&cs, 0.02, 0.707);
+    carrier_costas_qpsk(&cs, src, cur_n, out);
+}
+
+static void k_gardner(void)
+{
+    TimingRecovery tr;
+    timing_init(&tr, 4, 0.01, 0.707);
+    timing_recover_gardner(&tr, src, cur_n, out);
+}
+
+static void k_ofdm_mod(void)
+{
+    int n_sym = cur_n / (cur_ofdm.n_fft + cur_ofdm.n_cp);
+    ofdm_modulate_block(&cur_ofdm, n_sym, src, out);
+}
+
+static void k_ofdm_demod(void)
+{
+    int sym = cur_ofdm.n_fft + cur_ofdm.n_cp;
+    for (int s = 0; s + sym <= cur_n; s += sym)
+        ofdm_demodulate_ws(&cur_ofdm, src + s, work, NULL, &arena);
+}
+
+static void k_ofdm_demod_block(void)
+{
+    int n_sym = cur_n / (cur_ofdm.n_fft + cur_ofdm.n_cp);
+    ofdm_demodulate_block_ws(&cur_ofdm, n_sym, src, work, &arena);
+}
+
+static void k_ofdm_demod_frame(void)
+{
+    int n_sym = cur_n / (cur_ofdm.n_fft + cur_ofdm.n_cp);
+    ofdm_demodulate_frame(&cur_ofdm, n_sym, src, work, NULL, &arena);
+}
+
+static void k_ofdm_demod_mt(void)
+{
+    int n_sym = cur_n / (cur_ofdm.n_fft + cur_ofdm.n_cp);
+    OfdmDemap dm = { MOD_QPSK, 0.1, mt_bits, NULL };
+    ofdm_demodulate_frame_mt(&cur_pool, &cur_ofdm, n_sym, src, work, NULL,
+                             &dm);
+}
+
+static void k_ofdm_sync(void)
+{
+    ofdm_sync_process(&cur_sync, sync_in, cur_n, out);
+}
+
+static void k_pfb(void)
+{
+    pfb_process(&cur_pfb, src, cur_n, out);
+}
+
+static void k_dsss(void)
+{
+    static int pn[11] = { 1, -1, 1, 1, -1, 1, 1, 1, -1, -1, -1 };
+    dsss_spread(bits, cur_n, pn, 11, dout);
+    dsss_despread(dout, cur_n * 11, pn, 11, bits2);
+}
+
+static void k_lms(void)
+{
+    for (int i = 0; i < cur_n; i++)
+        eq_lms_step(&cur_lms, src[i], src[i], NULL);
+}
+
+static void k_rls(void)
+{
+    for (int i = 0; i < cur_n; i++)
+        eq_rls_step(&cur_rls, src[i], src[i], NULL);
+}
+
+static void k_dfe(void)
+{
+    for (int i = 0; i < cur_n; i++)
+        eq_dfe_step(&cur_dfe, src[i], src[i], NULL);
+}
+
+static void k_lora_mod(void)    { lora_modulate_symbol(&cur_lora, 77, out); }
+static void k_lora_demod(void)  { lora_demodulate_symbol_ws(&cur_lora, src, &arena); }
+static void k_fm_demod(void)    { fm_demodulate(src, cur_n, dout); }
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Suites
+ * ════════════════════════════════════════════════════════════════════ */
+
+static void bench_fft(void)
+{
+    char name[64];
+    for (int n = 64; n <= MAX_N; n *= 4) {
+        cur_n = n;
+        snprintf(name, sizeof(name), "fft/%d", n);
+        run(name, "samples", n, k_fft);
+        snprintf(name, sizeof(name), "rfft/%d", n);
+        run(name, "samples", n, k_rfft);
+        snprintf(name, sizeof(name), "fft_soa/%d", n);
+        run(name, "samples", n, k_fft_soa);
+        if (n <= FXP_FFT_MAX_N) {
+            snprintf(name, sizeof(name), "fft_q15/%d", n);
+            run(name, "samples", n, k_fft_q15);
+        }
+    }
+
+    /* FIR crossover: dense real filters, direct vs overlap-save */
+    static const int fir_taps[] = { 32, 128, 512 };
+    cur_n = 8192;
+    for (int i = 0; i < 3; i++) {
+        cur_taps = fir_taps[i];
+        snprintf(name, sizeof(name), "fir_direct/%d", cur_taps);
+        run(name, "samples", cur_n, k_fir_direct);
+        if (fastconv_init_real(&cur_fc, rsrc + MAX_N - cur_taps, cur_taps,
+                               0) == 0) {
+            snprintf(name, sizeof(name), "fastconv/%d", cur_taps);
+            run(name, "samples", cur_n, k_fastconv);
+            fastconv_free(&cur_fc);
+        }
+    }
+
+    /* Mixed radix (12·2^k, 1200) and Bluestein (prime) sizes */
+    static const int odd_sizes[] = { 1200, 1536, 3072, 12288, 1009 };
+    for (int i = 0; i < (int)(sizeof(odd_sizes) / sizeof(odd_sizes[0])); i++) {
+        cur_n = odd_sizes[i];
+        cur_plan = fft_plan_get(cur_n);
+        snprintf(name, sizeof(name), "fft_plan/%d", cur_n);
+        run(name, "samples", cur_n, k_fft_plan);
+    }
+}
+
+static void bench_coding(void)
+{
+    char name[64];
+    /* 256-bit frames (the q15 decoder's cap): full-frame traceback */
+    cur_n = 256;
+    conv_encode(bits, cur_n, bits2);
+    for (int i = 0; i < 2 * cur_n; i++) {
+        llr[i] = bits2[i] ? -4.0 : 4.0;
+        llr_q[i] = bits2[i] ? -2048 : 2048;
+    }
+    run("viterbi_hard/256", "bit", cur_n, k_viterbi_hard);
+    run("viterbi_soft/256", "bit", cur_n, k_viterbi_soft);
+    run("viterbi_q15/256", "bit", cur_n, k_viterbi_q15);
+
+    /* Long stream through the sliding-window decoder in 1500-LLR chunks */
+    cur_n = 16384;
+    conv_encode(bits, cur_n, bits2);
+    for (int i = 0; i < 2 * cur_n; i++) llr[i] = bits2[i] ? -4.0 : 4.0;
+    if (viterbi_init(&cur_vit, 0) == 0) {
+        run("viterbi_stream/16384", "bit", cur_n, k_viterbi_stream);
+        viterbi_free(&cur_vit);
+    }
+    conv_encode_punctured(CONV_RATE_3_4, bits, cur_n, bits2);
+    for (int i = 0; i < conv_punctured_len(CONV_RATE_3_4, 2 * cur_n); i++)
+        llr[i] = bits2[i] ? -4.0 : 4.0;
+    run("viterbi_punct34/16384", "bit", cur_n, k_viterbi_punct);
+
+    cur_n = 8192;
+    run("conv_encode/8192", "bit", cur_n, k_conv_encode);
+    run("conv_encode_bytes/8192", "bit", cur_n, k_conv_encode_bytes);
+    run("scrambler/8192", "bit", cur_n, k_scrambler);
+    cur_n = 1500;
+    snprintf(name, sizeof(name), "crc32/%d", cur_n);
+    run(name, "bit", 8.0 * cur_n, k_crc32);
+    snprintf(name, sizeof(name), "crc16/%d", cur_n);
+    run(name, "bit", 8.0 * cur_n, k_crc16);
+    snprintf(name, sizeof(name), "crc24/%d", cur_n);
+    run(name, "bit", 8.0 * cur_n, k_crc24);
+
+    /* 256-symbol geometric source, p ∝ e^(−i/20): ~5.8 bits/symbol */
+    double hp[256];
+    for (int i = 0; i < 256; i++) hp[i] = exp(-0.05 * i);
+    if (huffman_build(hp, 256, &cur_huff) == 0) {
+        cur_n = MAX_N / 2;
+        for (int i = 0; i < cur_n; i++) {
+            double sym = floor(-20.0 * log(1.0 - rng_uniform()));
+            bits[i] = (uint8_t)(sym < 255 ? sym : 255);
+        }
+        cur_nbits = huffman_encode_packed(&cur_huff, bits, cur_n, bits2,
+                                          MAX_N);
+        run("huffman_enc/32768", "sym", cur_n, k_huff_enc);
+        run("huffman_dec/32768", "sym", cur_n, k_huff_dec);
+    }
+}
+
+static void bench_modulation(void)
+{
+    static const struct { ModScheme m; const char *tag; } mods[] = {
+        { MOD_BPSK, "bpsk" }, { MOD_QPSK, "qpsk" },
+        { MOD_16QAM, "16qam" }, { MOD_64QAM, "64qam" },
+    };
+    char name[64];
+    cur_n = 4096;
+    for (int i = 0; i < 4; i++) {
+        cur_mod = mods[i].m;
+        mod_modulate(cur_mod, bits, cur_n * mod_bits_per_symbol(cur_mod), src);
+        channel_awgn(src, cur_n, 20.0, src);
+        snprintf(name, sizeof(name), "mod/%s", mods[i].tag);
+        run(name, "sym", cur_n, k_mod);
+        snprintf(name, sizeof(name), "demod_hard/%s", mods[i].tag);
+        run(name, "sym", cur_n, k_demod_hard);
+        snprintf(name, sizeof(name), "demod_soft/%s", mods[i].tag);
+        run(name, "sym", cur_n, k_demod_soft);
+    }
+    run("pulse_shape_rrc/4096x4", "samples", 4.0 * cur_n, k_pulse_shape);
+}
+
+static void bench_channel_sync(void)
+{
+    cur_n = 16384;
+    run("channel_awgn/16384", "samples", cur_n, k_awgn);
+    run("costas_qpsk/16384", "samples", cur_n, k_costas);
+    run("gardner/16384", "samples", cur_n, k_gardner);
+    run("fm_demod/16384", "samples", cur_n, k_fm_demod);
+    cur_n = 2048;
+    run("dsss_11chip/2048", "bit", cur_n, k_dsss);
+}
+
+static void bench_ofdm(void)
+{
+    static const int sizes[] = { 64, 256, 1024 };
+    char name[64];
+    for (int i = 0; i < 3; i++) {
+        ofdm_init(&cur_ofdm, sizes[i], sizes[i] / 4, sizes[i] / 16);
+        int sym = cur_ofdm.n_fft + cur_ofdm.n_cp;
+        cur_n = (16384 / sym) * sym;
+        snprintf(name, sizeof(name), "ofdm_mod/%d", sizes[i]);
+        run(name, "samples", cur_n, k_ofdm_mod);
+        snprintf(name, sizeof(name), "ofdm_demod/%d", sizes[i]);
+        run(name, "samples", cur_n, k_ofdm_demod);
+        snprintf(name, sizeof(name), "ofdm_demod_block/%d", sizes[i]);
+        run(name, "samples", cur_n, k_ofdm_demod_block);
+        snprintf(name, sizeof(name), "ofdm_demod_frame/%d", sizes[i]);
+        run(name, "samples", cur_n, k_ofdm_demod_frame);
+
+        /* Back-to-back frames: preamble + 8 data symbols */
+        int frame = 10 * sym;
+        cur_n = (16384 / frame) * frame;
+        for (int f = 0; f < cur_n; f += frame) {
+            ofdm_sync_preamble(&cur_ofdm, sync_in + f);
+            ofdm_modulate_block(&cur_ofdm, 8, src, sync_in + f + 2 * sym);
+        }
+        if (ofdm_sync_init(&cur_sync, &cur_ofdm, 0.5, 8) == 0) {
+            snprintf(name, sizeof(name), "ofdm_sync/%d", sizes[i]);
+            run(name, "samples", cur_n, k_ofdm_sync);
+            ofdm_sync_free(&cur_sync);
+        }
+    }
+
+    /* Long 4096-point frames (frame estimate + QPSK demap) on 1-8 workers */
+    ofdm_init(&cur_ofdm, 4096, 256, 32);
+    cur_n = (MAX_N / 4352) * 4352;
+    for (int t = 1; t <= 8; t *= 2) {
+        if (ofdm_pool_init(&cur_pool, t) != 0) continue;
+        snprintf(name, sizeof(name), "ofdm_demod_mt%d/4096", t);
+        run(name, "samples", cur_n, k_ofdm_demod_mt);
+        ofdm_pool_free(&cur_pool);
+    }
+
+    /* Channelisers: Zigbee-like 16 and Bluetooth 79 channels */
+    static const int chans[] = { 16, 79 };
+    cur_n = 16384;
+    for (int i = 0; i < 2; i++) {
+        for (int os = 1; os <= 2; os++) {
+            if (pfb_init(&cur_pfb, chans[i], chans[i] / os, 8, NULL) != 0)
+                continue;
+            snprintf(name, sizeof(name), "pfb%s/%d", os == 2 ? "_os" : "",
+                     chans[i]);
+            run(name, "samples", cur_n, k_pfb);
+            pfb_free(&cur_pfb);
+        }
+    }
+}
+
+static void bench_equalisers(void)
+{
+    static const int taps[] = { 5, 11, 21, 31 };
+    char name[64];
+    cur_n = 1024;
+    for (int i = 0; i < 4; i++) {
+        cur_taps = taps[i];
+        eq_lms_init(&cur_lms, cur_taps, 0.001);
+        eq_rls_init(&cur_rls, cur_taps, 0.99, 100.0);
+        eq_dfe_init(&cur_dfe, cur_taps, cur_taps / 2 + 1, 0.001);
+        snprintf(name, sizeof(name), "eq_lms/%d", cur_taps);
+        run(name, "samples", cur_n, k_lms);
+        snprintf(name, sizeof(name), "eq_rls/%d", cur_taps);
+        run(name, "samples", cur_n, k_rls);
+        snprintf(name, sizeof(name), "eq_dfe/%d", cur_taps);
+        run(name, "samples", cur_n, k_dfe);
+        eq_lms_free(&cur_lms);
+        eq_rls_free(&cur_rls);
+        eq_dfe_free(&cur_dfe);
+    }
+}
+
+static void bench_lora(void)
+{
+    char name[64];
+    for (int sf = 7; sf <= 12; sf++) {
+        lora_init(&cur_lora, sf, 125000, 1);
+        lora_modulate_symbol(&cur_lora, 77, src);
+        snprintf(name, sizeof(name), "lora_mod/sf%d", sf);
+        run(name, "samples", cur_lora.n_fft, k_lora_mod);
+        snprintf(name, sizeof(name), "lora_demod/sf%d", sf);
+        run(name, "samples", cur_lora.n_fft, k_lora_demod);
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  JSON output and baseline comparison
+ * ════════════════════════════════════════════════════════════════════ */
+
+static int write_json(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+    fprintf(fp, "{\n  \"suite\": \"wireless-comms-suite\",\n");
+    fprintf(fp, "  \"min_time_ms\": %.1f,\n  \"results\": [\n", min_ms);
+    for (int i = 0; i < n_results; i++)
+        fprintf(fp, "    {\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.6g}%s\n",
+                results[i].name, results[i].unit, results[i].value,
+                i + 1 < n_results ? "," : "");
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Reads the one-result-per-line layout written by write_json() */
+static int load_json(const char *path, BenchResult *base, int max)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    char line[256];
+    int n = 0;
+    while (n < max && fgets(line, sizeof(line), fp)) {
+        BenchResult *r = &base[n];
+        if (sscanf(line, " {\"name\": \"%63[^\"]\", \"unit\": \"%15[^\"]\", "
+                         "\"value\": %lf", r->name, r->unit, &r->value) == 3)
+            n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+/* @return Number of regressions beyond tol */
+static int compare(const char *path, double tol)
+{
+    static BenchResult base[MAX_RESULTS];
+    int nb = load_json(path, base, MAX_RESULTS);
+    if (nb < 0) {
+        fprintf(stderr, "bench: cannot read baseline %s\n", path);
+        return -1;
+    }
+
+    int regressions = 0;
+    printf("\n  %-32s %12s %12s %8s\n", "benchmark", "baseline", "current",
+           "change");
+    for (int i = 0; i < n_results; i++) {
+        const BenchResult *b = NULL;
+        for (int j = 0; j < nb; j++)
+            if (strcmp(base[j].name, results[i].name) == 0) b = &base[j];
+        if (!b) {
+            printf("  %-32s %12s %12.3f %8s\n", results[i].name, "-",
+                   results[i].value, "new");
+            continue;
+        }
+        double change = results[i].value / b->value - 1.0;
+        int bad = change < -tol;
+        regressions += bad;
+        printf("  %-32s %12.3f %12.3f %+7.1f%%%s\n", results[i].name,
+               b->value, results[i].value, 100.0 * change,
+               bad ? "  REGRESSION" : "");
+    }
+    printf("\n  %d regression(s) beyond %.0f%% against %s\n", regressions,
+           100.0 * tol, path);
+    return regressions;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Main
+ * ════════════════════════════════════════════════════════════════════ */
+
+int main(int argc, char **argv)
+{
+    const char *json_path = NULL, *baseline = NULL;
+    double tol = 0.10;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json") && i + 1 < argc)           json_path = argv[++i];
+        else if (!strcmp(argv[i], "--compare") && i + 1 < argc)   baseline = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) tol = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc)    filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)  min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--quick"))                     min_ms = 5.0;
+        else {
+            fprintf(stderr, "usage: %s [--json FILE] [--compare FILE] "
+                    "[--tolerance F] [--filter STR] [--min-time MS] [--quick]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    /* Deterministic inputs shared by all kernels */
+    rng_seed(9);
+    random_bits(bits, MAX_N);
+    for (int i = 0; i < MAX_N; i++) {
+        src[i] = cplx(rng_gaussian() * 0.5, rng_gaussian() * 0.5);
+        rsrc[i] = (real_t)(bits[i] ? 1.0 : -1.0);
+    }
+    cplxq15_from_cplx(src, MAX_N, 8192.0, q15src);
+    if (cplxbuf_alloc(&soa, MAX_N) != 0 || arena_init(&arena, 1 << 20) != 0) {
+        fprintf(stderr, "bench: out of memory\n");
+        return 2;
+    }
+
+    print_separator("Throughput benchmarks (best of 3)");
+    bench_fft();
+    bench_coding();
+    bench_modulation();
+    bench_channel_sync();
+    bench_ofdm();
+    bench_equalisers();
+    bench_lora();
+
+    int status = 0;
+    if (json_path) {
+        if (write_json(json_path) != 0) {
+            fprintf(stderr, "bench: cannot write %s\n", json_path);
+            status = 2;
+        } else {
+            printf("\n  %d results written to %s\n", n_results, json_path);
+        }
+    }
+    if (baseline) {
+        int reg = compare(baseline, tol);
+        if (reg != 0) status = reg < 0 ? 2 : 1;
+    }
+
+    cplxbuf_free(&soa);
+    arena_free(&arena);
+    return status;
+}
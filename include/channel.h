@@ -29,7 +29,13 @@
 double channel_awgn(const Cplx *in, int n, double snr_db, Cplx *out);
 
 /** Real-valued AWGN. */
-double channel_awgn_real(const double *in, int n, double snr_db, double *out);
+double channel_awgn_real(const real_t *in, int n, double snr_db, real_t *out);
+
+/** Reentrant AWGN — noise is drawn from the caller's generator. */
+double channel_awgn_r(RngState *rng, const Cplx *in, int n, double snr_db,
+                      Cplx *out);
+double channel_awgn_real_r(RngState *rng, const real_t *in, int n,
+                           double snr_db, real_t *out);
 
 /* ── Eb/N0 ↔ SNR conversion ─────────────────────────────────────── */
 
@@ -53,6 +59,10 @@ void channel_rayleigh_flat(RayleighChannel *ch, const Cplx *in, int n,
 /** Generate n independent Rayleigh fading coefficients. */
 void channel_rayleigh_gen(int n, Cplx *coeffs);
 
+void channel_rayleigh_flat_r(RngState *rng, RayleighChannel *ch,
+                             const Cplx *in, int n, Cplx *out, Cplx *h_est);
+void channel_rayleigh_gen_r(RngState *rng, int n, Cplx *coeffs);
+
 /* ── Rician fading ───────────────────────────────────────────────── */
 
 typedef struct {
@@ -62,6 +72,8 @@ typedef struct {
 
 void channel_rician_flat(RicianChannel *ch, const Cplx *in, int n,
                          Cplx *out, Cplx *h_est);
+void channel_rician_flat_r(RngState *rng, RicianChannel *ch,
+                           const Cplx *in, int n, Cplx *out, Cplx *h_est);
 
 /* ── Multipath (tapped delay line) ───────────────────────────────── */
 
@@ -83,6 +95,8 @@ typedef struct {
  */
 void channel_multipath_init(MultipathChannel *ch, int n_taps,
                             const int *delays, const double *gains_db);
+void channel_multipath_init_r(RngState *rng, MultipathChannel *ch, int n_taps,
+                              const int *delays, const double *gains_db);
 
 /**
  * @brief Apply multipath channel to signal.
@@ -103,7 +117,7 @@ void channel_doppler(const Cplx *in, int n, double fd, Cplx *out);
 /* ── Signal power measurement ────────────────────────────────────── */
 
 double signal_power(const Cplx *x, int n);
-double signal_power_real(const double *x, int n);
+double signal_power_real(const real_t *x, int n);
 double compute_snr_db(const Cplx *signal, const Cplx *noisy, int n);
 
 #endif /* CHANNEL_H */
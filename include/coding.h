@@ -12,6 +12,7 @@
 #ifndef CODING_H
 #define CODING_H
 
+#include "comms_utils.h"
 #include <stdint.h>
 #include <stddef.h>
 
@@ -23,21 +24,44 @@ double entropy(const double *probs, int n_symbols);
 /* ── Huffman coding ──────────────────────────────────────────────── */
 
 #define HUFFMAN_MAX_SYMBOLS 256
-#define HUFFMAN_MAX_CODELEN  32
+#define HUFFMAN_MAX_CODELEN  16
+#define HUFFMAN_LOOKUP_BITS  10      /* primary decode table index     */
+#define HUFFMAN_TABLE_SIZE   (1024 + 40 * 64)  /* + subtables: ≤ 2^6 each,
+                                        a 6-bit one needs ≥ 7 symbols  */
 
+/**
+ * Canonical code: lengths are optimal subject to HUFFMAN_MAX_CODELEN
+ * (package-merge), codes of one length are consecutive in symbol
+ * order.  Zero-probability symbols get no code.  lookup[] decodes
+ * HUFFMAN_LOOKUP_BITS at a time: a primary slot either holds a symbol
+ * or links to a subtable for the longer codes under that prefix.
+ */
 typedef struct {
     int    n_symbols;
     uint32_t codes[HUFFMAN_MAX_SYMBOLS];     /* bit pattern          */
     int      lengths[HUFFMAN_MAX_SYMBOLS];   /* code length in bits  */
     double   avg_length;                     /* weighted average     */
+    int      max_len;                        /* longest code         */
+    uint32_t lookup[HUFFMAN_TABLE_SIZE];     /* decode tables        */
 } HuffmanTable;
 
 int huffman_build(const double *probs, int n_symbols, HuffmanTable *ht);
+
+/** One bit per output byte.  Returns bits written, -1 if a symbol has
+ *  no code or max_bits is exceeded. */
 int huffman_encode(const HuffmanTable *ht, const uint8_t *syms, int n,
                    uint8_t *bits, int max_bits);
 int huffman_decode(const HuffmanTable *ht, const uint8_t *bits, int nbits,
                    uint8_t *syms, int max_syms);
 
+/** Packed MSB-first through a 64-bit bit buffer; the last byte is
+ *  zero-padded.  Returns bits written, -1 as huffman_encode(). */
+int huffman_encode_packed(const HuffmanTable *ht, const uint8_t *syms,
+                          int n, uint8_t *out, int max_bytes);
+/** Decode up to max_syms symbols from nbits packed bits. */
+int huffman_decode_packed(const HuffmanTable *ht, const uint8_t *in,
+                          int nbits, uint8_t *syms, int max_syms);
+
 /* ── Run-length encoding ─────────────────────────────────────────── */
 
 int rle_encode(const uint8_t *data, int n, uint8_t *out, int max_out);
@@ -49,6 +73,26 @@ uint16_t crc16_ccitt(const uint8_t *data, int n);
 uint32_t crc32(const uint8_t *data, int n);
 uint32_t crc24_adsb(const uint8_t *data, int n);  /* Mode-S CRC-24 */
 
+/** Incremental form of the three CRCs above, table-driven 8 bytes per
+ *  step: crc_init(), crc_update() over the data in any split, then
+ *  crc_finalize() gives the one-shot value. */
+typedef enum { CRC_16_CCITT, CRC_32, CRC_24_ADSB, CRC_N_KINDS } CrcKind;
+
+typedef struct {
+    CrcKind  kind;
+    uint32_t reg;                    /* shift register, MSB-first kinds
+                                        left-aligned                    */
+} CrcCtx;
+
+void     crc_init(CrcCtx *c, CrcKind kind);
+void     crc_update(CrcCtx *c, const uint8_t *data, int n);
+uint32_t crc_finalize(const CrcCtx *c);
+
+/** CRC-32 of A‖B from crc32(A), crc32(B) and B's length in bytes, in
+ *  O(log len_b) — chunks may be checksummed independently (in parallel)
+ *  and merged. */
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, long len_b);
+
 /* ── Parity ──────────────────────────────────────────────────────── */
 
 uint8_t parity_even(const uint8_t *bits, int n);
@@ -70,12 +114,131 @@ int  hamming74_decode(const uint8_t *code7, uint8_t *data4); /* returns 0 or cor
 /** Encode `n` input bits → `2*n` output bits. */
 void conv_encode(const uint8_t *in, int n, uint8_t *out);
 
+/** Encode packed MSB-first bytes a byte per lookup: `n_bytes` in →
+ *  `2*n_bytes` out, each input bit giving its G0 then G1 bit.  `state`
+ *  is the last CONV_K − 1 input bits (0 at frame start); returns the
+ *  state to pass to the next call, so a stream may be split anywhere on
+ *  byte boundaries. */
+unsigned int conv_encode_bytes(unsigned int state, const uint8_t *in,
+                               int n_bytes, uint8_t *out);
+
+/** Branch outputs shared by the encoders and Viterbi decoders: entry r
+ *  (2·CONV_STATES of them) is the coded pair for encoder register r,
+ *  newest input in bit 0 — bit 1 the G0 output, bit 0 the G1 output. */
+const uint8_t *conv_branch_table(void);
+
 /** Viterbi hard-decision decode. `n_coded` = length of coded bits (must be even).
- *  Returns decoded length = n_coded/2.  */
+ *  Returns decoded length = n_coded/2.  Decoded through a stack-resident
+ *  ViterbiDecoder whose 1024-step ring gives frames of up to 1024 data
+ *  bits a full-frame traceback.  */
 int  viterbi_decode(const uint8_t *coded, int n_coded, uint8_t *decoded);
 
-/** Viterbi soft-decision decode (LLR input, positive = more likely 0). */
-int  viterbi_decode_soft(const double *llr, int n_coded, uint8_t *decoded);
+/** Viterbi soft-decision decode (LLR input, positive = more likely 0;
+ *  quantised as for ViterbiDecoder). */
+int  viterbi_decode_soft(const real_t *llr, int n_coded, uint8_t *decoded);
+
+/* ── Punctured rates (802.11) ────────────────────────────────────── */
+
+/** Code rates obtained by puncturing the rate-1/2 mother code with the
+ *  802.11 patterns (kept bits of each A0 B0 A1 B1 ... period):
+ *  2/3 keeps A0 B0 A1; 3/4 keeps A0 B0 A1 B2; 5/6 keeps A0 B0 A1 B2 A3 B4. */
+typedef enum {
+    CONV_RATE_1_2,
+    CONV_RATE_2_3,
+    CONV_RATE_3_4,
+    CONV_RATE_5_6,
+    CONV_N_RATES
+} ConvRate;
+
+/** Transmitted length of `n` mother-code bits at `rate`. */
+int  conv_punctured_len(ConvRate rate, int n);
+
+/** Mother-code length (even) that `n` received bits expand to. */
+int  conv_depunctured_len(ConvRate rate, int n);
+
+/** Drop the punctured positions of `n` mother-code bits.
+ *  Returns conv_punctured_len(rate, n). */
+int  conv_puncture(ConvRate rate, const uint8_t *in, int n, uint8_t *out);
+
+/** Reinsert punctured positions as erasures (zero LLRs).
+ *  Returns conv_depunctured_len(rate, n). */
+int  conv_depuncture(ConvRate rate, const real_t *in, int n, real_t *out);
+
+/** conv_encode() then conv_puncture(): `n` bits in, returns coded length. */
+int  conv_encode_punctured(ConvRate rate, const uint8_t *in, int n,
+                           uint8_t *out);
+
+/** Soft decode `n` received LLRs at `rate`: depunctured in runs and fed
+ *  through the same decoder as viterbi_decode_soft(), with the same
+ *  output for the equivalent depunctured frame.  Returns
+ *  conv_depunctured_len(rate, n) / 2. */
+int  viterbi_decode_punctured(ConvRate rate, const real_t *llr, int n,
+                              uint8_t *decoded);
+
+/* ── Streaming Viterbi ───────────────────────────────────────────── */
+
+#define VITERBI_DEPTH     128        /* default traceback depth (steps) */
+#define VITERBI_LLR_SCALE 2          /* soft input quantisation, 1/2    */
+#define VITERBI_LLR_MAX   15         /* ... and clamp, in those steps   */
+
+/**
+ * Sliding-window decoder for an unbounded coded stream.  Survivor
+ * decisions are packed one bit per state (a uint64_t per trellis step)
+ * in a ring of 2·depth steps.  Whenever the ring fills, the decoder
+ * traces back from the best current state and releases the oldest
+ * depth bits, so memory is fixed and the decision delay is depth to
+ * 2·depth steps.
+ *
+ * The add-compare-select runs on uint8 saturating path metrics through
+ * the dispatched viterbi_acs8 kernel.  LLRs are quantised to 5 bits,
+ * round(llr · VITERBI_LLR_SCALE) clamped to ±VITERBI_LLR_MAX; hard bits
+ * enter as ±1, which decides exactly as the Hamming metric.  Decoded bit t is
+ * input bit t, as with viterbi_decode().
+ */
+typedef struct {
+    int       depth;                 /* traceback depth (steps)          */
+    int       len;                   /* ring length (2·depth when owned) */
+    uint64_t *surv;                  /* surv[t % len]: bit s set when
+                                        state s took its lower
+                                        predecessor                     */
+    int       owned;                 /* surv allocated by viterbi_init() */
+    uint8_t   pm[CONV_STATES];       /* path metrics                     */
+    uint8_t   br[CONV_STATES / 2];   /* butterfly pairs (viterbi_acs8)   */
+    long      t;                     /* trellis steps taken              */
+    long      n_out;                 /* bits released                    */
+    int       have_half;             /* odd coded value held over        */
+    int8_t    half;                  /* ... quantised                    */
+} ViterbiDecoder;
+
+/**
+ * @brief Allocate the survivor ring and start in state 0.
+ * @param depth  Traceback depth; ≤ 0 selects VITERBI_DEPTH
+ * @return 0, or −1 on OOM
+ */
+int  viterbi_init(ViterbiDecoder *v, int depth);
+void viterbi_free(ViterbiDecoder *v);
+
+/** Restart at state 0 for a new stream (keeps the ring). */
+void viterbi_reset(ViterbiDecoder *v);
+
+/**
+ * @brief Feed n coded bits (hard) or LLRs (soft), any chunking.
+ *
+ * out must have room for (n + 1)/2 + depth bits.
+ * @return Decoded bits written to out
+ */
+int  viterbi_process(ViterbiDecoder *v, const uint8_t *coded, int n,
+                     uint8_t *out);
+int  viterbi_process_soft(ViterbiDecoder *v, const real_t *llr, int n,
+                          uint8_t *out);
+
+/**
+ * @brief End of stream: trace back from the best state, release the rest.
+ *
+ * out needs room for 2·depth bits.  The decoder is reset afterwards.
+ * @return Decoded bits written to out
+ */
+int  viterbi_flush(ViterbiDecoder *v, uint8_t *out);
 
 /* ── Interleaver ─────────────────────────────────────────────────── */
 
@@ -93,4 +256,20 @@ void interleaver_apply(const Interleaver *itl,
 void interleaver_deapply(const Interleaver *itl,
                          const uint8_t *in, uint8_t *out, int n);
 
+/* ── Packed-bit variants (BitVec, see comms_utils.h) ─────────────── */
+
+/** Encode in->n bits → 2*in->n bits.  out->cap must be ≥ 2*in->n. */
+void conv_encode_packed(const BitVec *in, BitVec *out);
+
+/**
+ * Bit permutation on packed data.  The first min(in->n, rows*cols)
+ * bits are permuted; out->n is always rows*cols, with the positions a
+ * short input does not reach left zero.
+ * @return 0, or -1 (out untouched) if out->cap < rows*cols
+ */
+int  interleaver_apply_packed(const Interleaver *itl,
+                              const BitVec *in, BitVec *out);
+int  interleaver_deapply_packed(const Interleaver *itl,
+                                const BitVec *in, BitVec *out);
+
 #endif /* CODING_H */
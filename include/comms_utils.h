@@ -12,11 +12,28 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* ── Sample precision ────────────────────────────────────────────── */
+
+/**
+ * Storage type for signal samples, filter taps and LLRs.
+ *
+ * Defaults to double.  Building with -DCOMMS_USE_FLOAT (make lib_f32)
+ * switches sample storage to float, doubling SIMD width and halving
+ * cache footprint.  Scalar parameters (SNR, step sizes) and long-lived
+ * loop state (PLL/Costas integrators, RLS inverse correlation matrix)
+ * stay double in both builds.
+ */
+#ifdef COMMS_USE_FLOAT
+typedef float  real_t;
+#else
+typedef double real_t;
+#endif
+
 /* ── Complex number ──────────────────────────────────────────────── */
 
 typedef struct {
-    double re;
-    double im;
+    real_t re;
+    real_t im;
 } Cplx;
 
 Cplx   cplx(double re, double im);
@@ -31,21 +48,153 @@ double cplx_phase(Cplx z);
 Cplx   cplx_from_polar(double mag, double phase);
 Cplx   cplx_exp_j(double theta);   /* e^{j*theta} */
 
+/* ── Split-complex (SoA) buffers ─────────────────────────────────── */
+
+/**
+ * Complex samples stored as separate real and imaginary arrays.
+ *
+ * The interleaved Cplx layout forces every kernel through cplx_mul()
+ * calls on {re, im} pairs; with split arrays the hot loops below are
+ * plain double arithmetic the compiler can vectorise 2–8 lanes wide.
+ * Both arrays are 64-byte aligned and hold real_t samples.
+ */
+typedef struct {
+    real_t *re;
+    real_t *im;
+    int     n;               /* capacity in samples */
+} CplxBuf;
+
+int    cplxbuf_alloc(CplxBuf *b, int n);      /* 0 on success, -1 on OOM */
+void   cplxbuf_free(CplxBuf *b);
+void   cplxbuf_from_cplx(CplxBuf *dst, const Cplx *src, int n);
+void   cplxbuf_to_cplx(const CplxBuf *src, Cplx *dst, int n);
+
+/** acc[i] += a[i] * b[i]  (element-wise complex multiply-accumulate) */
+void   cplxbuf_mac(CplxBuf *acc, const CplxBuf *a, const CplxBuf *b, int n);
+
+/** Σ a[i] * b[i]  (complex dot product, e.g. FIR tap or correlator) */
+Cplx   cplxbuf_dot(const CplxBuf *a, const CplxBuf *b, int n);
+
+/** out[i] = |x[i]|^2 */
+void   cplxbuf_mag2(const CplxBuf *x, real_t *out, int n);
+
+/**
+ * @brief x[i] *= phasor * step^i, in place (frequency shift / derotation).
+ * @return Phasor for sample n, to continue rotation in the next block.
+ */
+Cplx   cplxbuf_rotate(CplxBuf *x, int n, Cplx phasor, Cplx step);
+
+/* ── Scratch arena ───────────────────────────────────────────────── */
+
+/**
+ * Bump allocator for per-call scratch memory.
+ *
+ * A receiver allocates one arena up front and passes it to the `_ws`
+ * variants of functions that need size-dependent scratch (OFDM demod,
+ * LoRa dechirp, ...), so the steady-state loop never touches the heap.
+ * Blocks are 64-byte aligned and NOT zeroed.  Passing ws = NULL to a
+ * `_ws` function falls back to malloc/free, as does an exhausted arena.
+ */
+typedef struct {
+    uint8_t *base;
+    size_t   size;           /* capacity in bytes    */
+    size_t   used;           /* current bump offset  */
+} CommsArena;
+
+#define ARENA_ALIGN 64
+
+int    arena_init(CommsArena *a, size_t bytes);    /* 0 or -1 on OOM */
+void   arena_free(CommsArena *a);
+void  *arena_alloc(CommsArena *a, size_t bytes);   /* NULL if full   */
+void   arena_reset(CommsArena *a);
+
+/** Scratch from ws (or the heap if ws is NULL / full). */
+void  *arena_scratch(CommsArena *ws, size_t bytes);
+
+/** Release p and everything allocated from ws after it (LIFO). */
+void   arena_scratch_free(CommsArena *ws, void *p);
+
 /* ── PRNG / noise ────────────────────────────────────────────────── */
 
+/** Xoshiro256** generator state.  One per thread for reentrant use. */
+typedef struct {
+    uint64_t s[4];
+} RngState;
+
+/* Global-state convenience API (single-threaded programs, demos) */
 void   rng_seed(uint64_t seed);
 double rng_uniform(void);          /* [0, 1)  */
 double rng_gaussian(void);         /* N(0,1)  */
 int    rng_bernoulli(double p);    /* 1 with probability p */
 
+/* Reentrant API — the caller owns the state */
+void     rng_state_seed(RngState *rng, uint64_t seed);
+uint64_t rng_next_r(RngState *rng);
+double   rng_uniform_r(RngState *rng);
+double   rng_gaussian_r(RngState *rng);
+int      rng_bernoulli_r(RngState *rng, double p);
+
+/**
+ * @brief Advance the state by 2^128 steps (2^192 for the long jump).
+ *
+ * Seed one state, then hand a copy to each worker and jump it i times:
+ * the resulting streams are guaranteed not to overlap.
+ */
+void     rng_jump(RngState *rng);
+void     rng_long_jump(RngState *rng);
+
+/**
+ * @brief Fill buf[0..n-1] with N(0,1) samples (bulk noise generation).
+ *
+ * Uses a 128-layer Ziggurat: one 64-bit draw and a multiply per sample
+ * on ~99% of calls, no log/sqrt/cos.  Several times faster than calling
+ * rng_gaussian() in a loop; the stream differs from rng_gaussian().
+ */
+void   rng_gaussian_fill(double *buf, int n);
+void   rng_gaussian_fill_r(RngState *rng, double *buf, int n);
+
+/** State behind the global-state API (for wrappers in other modules). */
+RngState *rng_global_state(void);
+
 /* ── Bit manipulation ────────────────────────────────────────────── */
 
 void   bits_from_bytes(const uint8_t *bytes, int nbytes, uint8_t *bits);
 void   bytes_from_bits(const uint8_t *bits, int nbits, uint8_t *bytes);
 void   random_bits(uint8_t *bits, int n);
+void   random_bits_r(RngState *rng, uint8_t *bits, int n);
 int    bit_errors(const uint8_t *a, const uint8_t *b, int n);
 void   print_bits(const uint8_t *bits, int n, const char *label);
 
+/* ── Packed bitstreams ───────────────────────────────────────────── */
+
+/**
+ * Bitstream packed 64 bits per word, MSB first: bit i lives in
+ * w[i / 64] at position 63 - i % 64, so byte order matches
+ * bits_from_bytes().  Bits past n in the last word are kept zero.
+ */
+typedef struct {
+    uint64_t *w;
+    int       n;             /* length in bits      */
+    int       cap;           /* capacity in bits    */
+} BitVec;
+
+#define BITVEC_WORDS(nbits) (((nbits) + 63) / 64)
+
+int    bitvec_init(BitVec *bv, int cap_bits);  /* zeroed; 0 or -1 on OOM */
+void   bitvec_free(BitVec *bv);
+int    bitvec_get(const BitVec *bv, int i);
+void   bitvec_set(BitVec *bv, int i, int v);
+void   bitvec_from_bits(BitVec *bv, const uint8_t *bits, int n);
+void   bitvec_to_bits(const BitVec *bv, uint8_t *bits);
+void   bitvec_from_bytes(BitVec *bv, const uint8_t *bytes, int nbytes);
+
+/** Fill bv->n random bits, 64 per rng_next_r() call. */
+void   random_bits_packed(BitVec *bv);
+void   random_bits_packed_r(RngState *rng, BitVec *bv);
+
+/** Differing bits over min(a->n, b->n): XOR + popcount per word. */
+int    bit_errors_packed(const BitVec *a, const BitVec *b);
+
 /* ── ASCII helpers ───────────────────────────────────────────────── */
 
 void   print_signal_ascii(const char *title, const double *x, int n, int max_show);
@@ -0,0 +1,131 @@
+/**
+ * @file cpu_dispatch.h
+ * @brief Runtime CPU feature detection and SIMD kernel dispatch.
+ *
+ * The hot inner loops of the library — FFT butterflies, Viterbi
+ * add-compare-select, FIR accumulation, complex MAC/dot and max-log LLR
+ * demapping — are compiled several times, once per x86 ISA level, and
+ * the best version the running CPU supports is selected through a
+ * function-pointer table on first use.  One binary therefore runs on
+ * SSE4.2-only machines and still uses AVX2 / AVX-512 where present.
+ *
+ * Every variant is built from the same C source with FP contraction
+ * off (-std=c99), so all levels produce bit-identical results.  The
+ * CRC-32 fold at the AVX2 and AVX-512 levels uses PCLMULQDQ, which the
+ * AVX2 level therefore also requires; the AVX-512 level requires
+ * AVX512BW and AVX512VBMI for the Viterbi kernel.
+ *
+ * Override for testing:  COMMS_SIMD=generic|sse4.2|avx2|avx512
+ * (a level above what the CPU supports is clamped down).
+ */
+
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include "comms_utils.h"
+#include <stdint.h>
+
+typedef enum {
+    SIMD_GENERIC = 0,        /* compiler baseline (SSE2 on x86-64)   */
+    SIMD_SSE42,
+    SIMD_AVX2,
+    SIMD_AVX512,
+    SIMD_N_LEVELS
+} SimdLevel;
+
+/* ── Kernel table ────────────────────────────────────────────────── */
+
+typedef struct {
+    SimdLevel level;
+
+    /** One radix-2 DIT butterfly row: (e, o) ← (e + w·o, e − w·o). */
+    void (*fft_bfly)(real_t *er, real_t *ei, real_t *or_, real_t *oi,
+                     const real_t *wr, const real_t *wi, int half);
+
+    /**
+     * One radix-4 DIT pass of an n-point FFT run on B transforms at
+     * once, sample k of transform b at re[k·B + b].  Blocks of 4h hold
+     * sub-DFTs ordered F0, F2, F1, F3, merged with twiddles
+     * w = {w1r, w1i, w2r, w2i, w3r, w3i}; sg = −1 for the inverse.
+     */
+    void (*fft_r4_lanes)(real_t *re, real_t *im, int n, int h,
+                         const real_t *const w[6], real_t sg, int B);
+
+    /**
+     * n_steps ACS steps of the 64-state rate-1/2 trellis on uint8
+     * saturating path metrics pm[64], updated in place.  Butterfly j
+     * takes predecessors j and j + 32 to states 2j and 2j + 1.  br[j]
+     * (j < 32) is the coded pair on branch j → 2j, first bit in bit 1,
+     * as in conv_branch_table(); j + 32 → 2j + 1 carries the same pair
+     * and the two crossing branches its complement.  A branch costs the
+     * sum of |llr| over its coded bits that disagree with the sign of
+     * llr[2t], llr[2t + 1] (0 expects llr > 0), |llr| ≤ 127; adds
+     * saturate at 255.  Bit s of dec[t] is state s's decision, set when
+     * the lower predecessor's sum is smaller (ties → upper).  Metrics
+     * never fall, so after every 4th step pm drops by the minimum it had
+     * 4 steps earlier (on entry for the first), which clips nothing.
+     */
+    void (*viterbi_acs8)(uint8_t *pm, const int8_t *llr, int n_steps,
+                         const uint8_t *br, uint64_t *dec);
+
+    /**
+     * q[i] = x[i] · scale rounded half up and clamped to ±lim (NaN →
+     * +lim), 0 < lim < 127: the Viterbi decoders' soft input.
+     */
+    void (*llr_quant8)(const real_t *x, int n, real_t scale, int lim,
+                       int8_t *q);
+
+    /** y[i] += a · h[i]  (FIR scatter / polyphase accumulation) */
+    void (*fir_axpy)(real_t *y, const real_t *h, real_t a, int n);
+
+    /** acc[i] += a[i] · b[i] on split-complex arrays */
+    void (*cplx_mac)(real_t *yr, real_t *yi, const real_t *ar,
+                     const real_t *ai, const real_t *br, const real_t *bi,
+                     int n);
+
+    /** Σ a[i] · b[i] on split-complex arrays */
+    Cplx (*cplx_dot)(const real_t *ar, const real_t *ai, const real_t *br,
+                     const real_t *bi, int n);
+
+    /**
+     * Max-log LLRs for nsyms symbols against an M = 2^bps point
+     * constellation: llr = max_{bit=0} m − max_{bit=1} m with
+     * m = −|y − p|² / two_sigma2.
+     */
+    void (*llr_maxlog)(const Cplx *syms, int nsyms, const Cplx *pts,
+                       int bps, double two_sigma2, real_t *llr);
+
+    /**
+     * Reflected CRC-32 register *reg (no final xor) over a prefix of
+     * data: with n ≥ 64, folds the first n & ~15 bytes by carry-less
+     * multiplication and returns that count.  Returns 0, consuming
+     * nothing, at levels without PCLMULQDQ; the caller finishes with
+     * its table-driven loop.
+     */
+    int  (*crc32_fold)(uint32_t *reg, const uint8_t *data, int n);
+} CommsKernels;
+
+/* ── API ─────────────────────────────────────────────────────────── */
+
+/** Highest level supported by this CPU and OS (cpuid + xgetbv). */
+SimdLevel   cpu_detect_simd(void);
+
+/**
+ * @brief (Re)select kernels: detected level, lowered by COMMS_SIMD.
+ *
+ * Runs once automatically on first use, from any thread; call it
+ * explicitly only after changing COMMS_SIMD.
+ * @return Active level
+ */
+SimdLevel   simd_init(void);
+
+/** Force a level (clamped to the detected one).  @return Active level */
+SimdLevel   simd_set_level(SimdLevel level);
+
+SimdLevel   simd_level(void);
+const char *simd_level_name(SimdLevel level);
+
+/** Active kernel table. */
+const CommsKernels *comms_kernels(void);
+
+#endif /* CPU_DISPATCH_H */
@@ -0,0 +1,278 @@
+/**
+ * @file dsp.h
+ * @brief Generic DSP engines — FFT plans, real-input FFT, polyphase
+ *        channeliser and overlap-save fast convolution.
+ *
+ * Mixed-radix FFT/IFFT of any size with precomputed, cached plans, and
+ * the FFT-based filters built on it.  OFDM (ofdm.h), the channel models
+ * and the demodulators all share these.
+ */
+
+#ifndef DSP_H
+#define DSP_H
+
+#include "comms_utils.h"
+#include <stdint.h>
+
+/* ── FFT plans ───────────────────────────────────────────────────── */
+
+#define FFT_MAX_LOG2     24          /* 2^k sizes always kept, k ≤ this   */
+#define FFT_PLAN_CACHE   32          /* slots for all other sizes         */
+#define FFT_MAX_FACTORS  32
+
+typedef enum {
+    FFT_RADIX2 = 0,                  /* n = 2^k: radix-4 (+1 radix-2) DIT */
+    FFT_MIXED,                       /* n = 2^a·3^b·5^c: radix 2/3/4/5    */
+    FFT_BLUESTEIN                    /* other prime factors: chirp-z      */
+} FftKind;
+
+/**
+ * Precomputed state for one FFT size.  Twiddles come straight from
+ * cos/sin, so accuracy does not degrade with n.
+ *
+ * Radix-2 plans hold the bit-reversal permutation and per-stage
+ * twiddles laid out contiguously, stage `half` reading
+ * tw[half - 1 .. 2·half - 2].  Mixed-radix plans hold the factorisation
+ * and one e^{−2πjk/n} table; Bluestein plans a chirp and the FFT of its
+ * conjugate, convolved on an m = 2^k ≥ 2n − 1 sub-plan.
+ */
+typedef struct FftPlan {
+    int     n;
+    FftKind kind;
+    int     log2n;                   /* radix-2 only                      */
+    int    *rev;                     /* rev[i] = bit-reversed i           */
+    real_t *twr, *twi;               /* n − 1 stage twiddles, e^{−jπk/h}  */
+    real_t *tw3r, *tw3i;             /* radix-4 third twiddle, e^{−j3πk/2h} */
+
+    int     n_factors;
+    int     factors[2 * FFT_MAX_FACTORS];  /* (radix, remaining length) */
+    Cplx   *tw;                      /* mixed: e^{−2πjk/n}, k < n         */
+
+    int     m;                       /* Bluestein convolution length      */
+    Cplx   *chirp;                   /* e^{−jπk²/n}, k < n                */
+    Cplx   *chirp_fft;               /* FFT of the conjugate chirp, / m   */
+    struct FftPlan *sub;             /* m-point radix-2 plan              */
+} FftPlan;
+
+/** Build a plan for any n ≥ 1.  0 on success, -1 on bad n / OOM. */
+int  fft_plan_init(FftPlan *plan, int n);
+void fft_plan_free(FftPlan *plan);
+
+/**
+ * @brief Shared plan for size n from a lazily filled process-wide cache.
+ *
+ * Plans are built on first request and live until exit.  Every power
+ * of two up to 2^FFT_MAX_LOG2 has a reserved slot; other sizes share
+ * FFT_PLAN_CACHE slots, first come first served, and once those are
+ * taken a new size misses (NULL) on every call.  fft()/ifft() then
+ * build and drop a one-off plan per call and ofdm_init() leaves
+ * OfdmParams.plan NULL, so code cycling through many odd sizes should
+ * keep its own plans with fft_plan_init().  Thread-safe: lookups and
+ * builds are serialised, and a returned plan is read-only.
+ * @return Plan, or NULL if n < 1, out of memory or the cache is full
+ */
+const FftPlan *fft_plan_get(int n);
+
+/** Forward FFT, out-of-place or in place (in == out). */
+void fft_execute(const FftPlan *plan, const Cplx *in, Cplx *out);
+/** Inverse FFT with 1/N scaling, out-of-place or in place. */
+void ifft_execute(const FftPlan *plan, const Cplx *in, Cplx *out);
+
+/**
+ * fft_execute()/ifft_execute() with scratch from ws.  Radix-2 plans and
+ * out-of-place mixed-radix plans need none; in-place mixed radix needs
+ * n samples and Bluestein m (heap when ws is NULL or full).
+ */
+void fft_execute_ws(const FftPlan *plan, const Cplx *in, Cplx *out,
+                    CommsArena *ws);
+void ifft_execute_ws(const FftPlan *plan, const Cplx *in, Cplx *out,
+                     CommsArena *ws);
+
+/* ── FFT (any size, in-place, cached plan) ───────────────────────── */
+
+void fft(Cplx *x, int n);     /* Forward FFT   */
+void ifft(Cplx *x, int n);    /* Inverse FFT   */
+
+/**
+ * Split-complex FFT on x->re / x->im (n ≤ x->n).  Powers of two run
+ * the vectorised split butterflies; other sizes are gathered through
+ * the interleaved plan (one n-sample heap temporary per call).
+ */
+void fft_soa(CplxBuf *x, int n);
+void ifft_soa(CplxBuf *x, int n);   /* includes 1/N scaling */
+
+/* ── Real-input FFT ──────────────────────────────────────────────── */
+
+/**
+ * Plan for an n-point FFT of real data.  Even n packs the samples as
+ * z[k] = x[2k] + j·x[2k+1], runs one n/2-point complex FFT and splits
+ * the result with a post-twiddle; odd n uses an n-point complex FFT.
+ */
+typedef struct {
+    int     n;
+    FftPlan half;                    /* n/2 points (even n), else n       */
+    Cplx   *tw;                      /* e^{−2πjk/n}, k ≤ n/4              */
+} RfftPlan;
+
+/** Build a plan for any n ≥ 1.  0 on success, -1 on bad n / OOM. */
+int  rfft_plan_init(RfftPlan *plan, int n);
+void rfft_plan_free(RfftPlan *plan);
+
+/** Shared plan for size n; cached (and missed) like fft_plan_get(). */
+const RfftPlan *rfft_plan_get(int n);
+
+/**
+ * @brief Forward FFT of n real samples, Hermitian-packed.
+ *
+ * Writes bins 0 .. n/2 (n/2 + 1 values); the rest follow from
+ * X[n − k] = conj(X[k]).  X[0], and X[n/2] for even n, are real.
+ * Scratch: none for even n with a radix-2 half plan, else up to n
+ * samples (heap when ws is NULL or full).
+ */
+void rfft_execute_ws(const RfftPlan *plan, const real_t *in, Cplx *out,
+                     CommsArena *ws);
+/** Inverse of rfft_execute() with 1/N scaling: n/2 + 1 bins → n reals. */
+void irfft_execute_ws(const RfftPlan *plan, const Cplx *in, real_t *out,
+                      CommsArena *ws);
+void rfft_execute(const RfftPlan *plan, const real_t *in, Cplx *out);
+void irfft_execute(const RfftPlan *plan, const Cplx *in, real_t *out);
+
+void rfft(const real_t *x, Cplx *X, int n);     /* X: n/2 + 1 bins  */
+void irfft(const Cplx *X, real_t *x, int n);    /* includes 1/N     */
+
+/* ── Polyphase filter-bank channeliser ──────────────────────────── */
+
+/**
+ * Splits one wideband stream into M sub-bands centred on k·fs/M
+ * (k > M/2 are the negative frequencies), each decimated by D:
+ *
+ *   y_k[m] = Σ_i h[i] · x[mD − i] · e^{−j2πk(mD − i)/M}
+ *
+ * i.e. mix channel k to DC, low-pass with the prototype h and keep
+ * every D-th sample — for all k at once.  Per output block the last
+ * M·P samples are weighted by h and folded into M sums (the polyphase
+ * FIR), rotated by mD mod M and passed through one M-point FFT.
+ * D = M is critically sampled; D = M/2 is 2× oversampled, which keeps
+ * the band edges alias-free for channels that straddle them.  Any M
+ * with an FFT plan works (16 Zigbee or 79 Bluetooth channels alike).
+ */
+typedef struct {
+    int      n_chan;         /* M: channels and FFT size            */
+    int      decim;          /* D: input samples per output block   */
+    int      len;            /* prototype length M·P                */
+    real_t  *h;              /* prototype, time-reversed, times M   */
+    Cplx    *hist;           /* delay line, written twice (2·len)   */
+    int      pos;
+    int64_t  t;              /* samples consumed                    */
+    Cplx    *fold;           /* M polyphase sums                    */
+    const FftPlan *plan;     /* shared plan, or &own on a cache miss */
+    FftPlan  own;
+} PfbChanneliser;
+
+/**
+ * @brief Default prototype: Blackman-windowed sinc, cut-off fs/(2M),
+ *        unit DC gain, M·taps_per_branch taps.
+ */
+void pfb_prototype(int n_chan, int taps_per_branch, real_t *h);
+
+/**
+ * @brief Set up an M-channel bank decimating by D (1 ≤ D ≤ M).
+ * @param proto  M·taps_per_branch prototype taps, or NULL for
+ *               pfb_prototype()
+ * @return 0 on success, -1 on bad arguments or allocation failure
+ */
+int  pfb_init(PfbChanneliser *c, int n_chan, int decim, int taps_per_branch,
+              const real_t *proto);
+void pfb_free(PfbChanneliser *c);
+
+/**
+ * @brief Channelise n input samples.
+ *
+ * Every D-th sample completes a block of M channel outputs: sample m of
+ * channel k lands at out[m·M + k].  At most n / D + 1 blocks per call.
+ * @return Number of blocks written
+ */
+int  pfb_process(PfbChanneliser *c, const Cplx *in, int n, Cplx *out);
+
+/* ── Fast convolution (overlap-save) ────────────────────────────── */
+
+/**
+ * Streaming FIR filtering through the FFT.  Each block of N samples
+ * (the last L − 1 inputs plus S = N − L + 1 new ones) is transformed,
+ * multiplied by the filter spectrum and transformed back; the S
+ * outputs free of wrap-around are kept.  Cost per output is about
+ * 2·N·log2 N / S instead of L multiply-adds.  Real filters on real
+ * data use the half-length real FFT.
+ *
+ * Outputs are the full convolution y[m] = Σ h[i]·x[m − i], x = 0
+ * before the stream starts, emitted S at a time;
+ * fastconv_flush() returns the last L − 1 + pending samples.
+ */
+typedef struct {
+    int      taps;           /* L                                   */
+    int      nfft;           /* N (power of 2)                      */
+    int      step;           /* S = N − L + 1                       */
+    int      is_real;
+    Cplx    *H;              /* filter spectrum (N or N/2 + 1 bins) */
+    Cplx    *X;              /* block spectrum                      */
+    Cplx    *cbuf;           /* N-sample window (complex) ...       */
+    real_t  *rbuf;           /* ... or real                         */
+    int      fill;           /* new samples in the window           */
+    int64_t  n_in, n_out;
+    const FftPlan  *plan;    /* shared plans, or &own / &rown when  */
+    const RfftPlan *rplan;   /* the cache misses                    */
+    FftPlan  own;
+    RfftPlan rown;
+    CommsArena ws;           /* inverse real FFT scratch            */
+} FastConv;
+
+/**
+ * @brief Set up a complex (h, x complex) or real engine.
+ * @param nfft  Block FFT size, or 0 to pick one for the filter length
+ * @return 0 on success, -1 on bad arguments or allocation failure
+ */
+int  fastconv_init(FastConv *fc, const Cplx *h, int taps, int nfft);
+int  fastconv_init_real(FastConv *fc, const real_t *h, int taps, int nfft);
+void fastconv_free(FastConv *fc);
+
+/**
+ * @brief Filter n samples; out receives every completed block.
+ *
+ * Room for n + step − 1 outputs is always enough.
+ * @return Outputs written
+ */
+int  fastconv_process(FastConv *fc, const Cplx *in, int n, Cplx *out);
+int  fastconv_process_real(FastConv *fc, const real_t *in, int n,
+                           real_t *out);
+
+/**
+ * @brief End the stream: write the remaining outputs (pending input
+ *        plus the L − 1 tail) and reset for a new stream.
+ * @return Outputs written
+ */
+int  fastconv_flush(FastConv *fc, Cplx *out);
+int  fastconv_flush_real(FastConv *fc, real_t *out);
+
+/**
+ * @brief Would overlap-save beat direct filtering?
+ *
+ * Dense filters cross over near 64 taps (real) and 32 (complex).
+ * @param taps     Filter span L
+ * @param nonzero  Real multiply-adds per output of the direct form: L
+ *                 for a dense real filter, 4L complex, fewer for sparse
+ *                 taps or upsampled input
+ * @param is_real  Real data and filter (half-length FFTs)
+ */
+int  fastconv_faster(int taps, int nonzero, int is_real);
+
+/**
+ * @brief One-shot full convolution, y of length n + taps − 1.
+ *
+ * Direct below the crossover, overlap-save above it.
+ * @return n + taps − 1, or -1 on allocation failure
+ */
+int  fast_convolve(const Cplx *x, int n, const Cplx *h, int taps, Cplx *y);
+int  fast_convolve_real(const real_t *x, int n, const real_t *h, int taps,
+                        real_t *y);
+
+#endif /* DSP_H */
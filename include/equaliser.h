@@ -85,6 +85,7 @@ typedef struct {
     double lambda;          /* forgetting factor (e.g. 0.99)        */
     double delta;           /* initialisation constant               */
     double *P;             /* inverse correlation matrix (flat)     */
+    double *Px;            /* gain-vector scratch (n_taps)          */
 } RlsEqualiser;
 
 int  eq_rls_init(RlsEqualiser *eq, int n_taps, double lambda, double delta);
@@ -0,0 +1,171 @@
+/**
+ * @file fixed_point.h
+ * @brief Q15/Q31 fixed-point datapath for int16 IQ front-ends.
+ *
+ * SDR front-ends deliver 16-bit IQ.  This module keeps such streams in
+ * integer form through the core TX/RX chain:
+ *   symbol mapping → pulse shaping → FFT/IFFT → Costas loop → Viterbi
+ * with saturating arithmetic throughout, and provides helpers to
+ * measure the quantisation loss against the floating-point reference.
+ *
+ * Q15: int16, value = x / 2^15, range [-1, 1 - 2^-15]
+ * Q31: int32, value = x / 2^31
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include "comms_utils.h"
+#include "modulation.h"
+#include "sync.h"
+#include <stdint.h>
+
+/* ── Types ───────────────────────────────────────────────────────── */
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+typedef struct {
+    q15_t re;
+    q15_t im;
+} CplxQ15;
+
+#define Q15_MAX   32767
+#define Q15_MIN  (-32768)
+#define Q31_MAX   2147483647
+#define Q31_MIN  (-2147483647 - 1)
+
+/**
+ * Amplitude of a unit-power symbol in the Q15 datapath (-6 dBFS).
+ * Leaves 6 dB of headroom for 64-QAM corners, pulse-shaping overshoot
+ * and channel noise before anything saturates.
+ */
+#define FXP_SYM_ONE 16384
+
+/* ── Saturating scalar arithmetic ────────────────────────────────── */
+
+static inline q15_t q15_sat(int32_t x)
+{
+    return (q15_t)(x > Q15_MAX ? Q15_MAX : (x < Q15_MIN ? Q15_MIN : x));
+}
+
+static inline q15_t q15_add(q15_t a, q15_t b) { return q15_sat((int32_t)a + b); }
+static inline q15_t q15_sub(q15_t a, q15_t b) { return q15_sat((int32_t)a - b); }
+
+/** a·b with round-to-nearest; saturates the single overflow case -1·-1. */
+static inline q15_t q15_mul(q15_t a, q15_t b)
+{
+    return q15_sat(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+static inline q31_t q31_sat(int64_t x)
+{
+    return (q31_t)(x > Q31_MAX ? Q31_MAX : (x < Q31_MIN ? Q31_MIN : x));
+}
+
+static inline q31_t q31_add(q31_t a, q31_t b) { return q31_sat((int64_t)a + b); }
+static inline q31_t q31_sub(q31_t a, q31_t b) { return q31_sat((int64_t)a - b); }
+
+static inline q31_t q31_mul(q31_t a, q31_t b)
+{
+    return q31_sat(((int64_t)a * b + (1LL << 30)) >> 31);
+}
+
+/** (a + jb)(c + jd) in Q15 with rounding and saturation. */
+CplxQ15 cplxq15_mul(CplxQ15 a, CplxQ15 b);
+
+/* ── Conversion / quantisation ───────────────────────────────────── */
+
+/**
+ * @brief Quantise real samples: out = sat(round(in * scale)).
+ * @return Number of samples that saturated.
+ */
+int  fxp_quantise(const real_t *in, int n, double scale, q15_t *out);
+
+/** Complex quantisation, same convention.  @return saturated count. */
+int  cplxq15_from_cplx(const Cplx *in, int n, double scale, CplxQ15 *out);
+
+/** out = in / scale */
+void cplxq15_to_cplx(const CplxQ15 *in, int n, double scale, Cplx *out);
+
+/**
+ * @brief Signal-to-quantisation-noise ratio of q / scale against ref.
+ * @return SQNR in dB (100 dB if error is zero).
+ */
+double fxp_sqnr_db(const Cplx *ref, const CplxQ15 *q, int n, double scale);
+
+/* ── TX chain ────────────────────────────────────────────────────── */
+
+/**
+ * @brief Map bits to Q15 constellation points (unit power → FXP_SYM_ONE).
+ * @return Number of symbols generated
+ */
+int mod_modulate_q15(ModScheme scheme, const uint8_t *bits, int nbits,
+                     CplxQ15 *syms);
+
+/**
+ * @brief Upsample and filter real Q15 symbols with Q15 taps.
+ *
+ * Polyphase form: only the non-zero upsampled inputs are multiplied,
+ * accumulated in 64 bits, rounded once and saturated.  No allocation.
+ * @param out  Output (nsyms * sps + hlen - 1)
+ * @return Number of output samples
+ */
+int pulse_shape_q15(const q15_t *syms, int nsyms, const q15_t *h, int hlen,
+                    int sps, q15_t *out);
+
+/* ── FFT (block floating point) ──────────────────────────────────── */
+
+#define FXP_FFT_MAX_N 4096
+
+/**
+ * @brief In-place radix-2 FFT on Q15 data with block floating point.
+ *
+ * Before each stage the block is shifted right by one bit if any
+ * component could overflow in the butterflies, so small signals keep
+ * full precision and large ones never wrap.
+ * @param n  Power of 2, ≤ FXP_FFT_MAX_N
+ * @return Block exponent e: true DFT = x · 2^e
+ */
+int fft_q15(CplxQ15 *x, int n);
+
+/**
+ * @brief In-place Q15 IFFT.
+ * @return Block exponent e: true IFFT (with 1/N) = x · 2^e
+ */
+int ifft_q15(CplxQ15 *x, int n);
+
+/* ── Carrier recovery ────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t phase;      /* NCO phase accumulator, 2^32 = 2π          */
+    int32_t  freq;       /* NCO increment per sample, clamped ±2^30    */
+    int32_t  alpha_q;    /* proportional gain, Q16 phase units / Q15  */
+    int32_t  beta_q;     /* integral gain, same format                */
+} CarrierSyncQ15;
+
+/** Same loop design as carrier_init(), converted to NCO units. */
+void carrier_init_q15(CarrierSyncQ15 *cs, double loop_bw, double damping);
+
+/**
+ * @brief QPSK Costas loop on Q15 samples (NCO + 1024-entry sin/cos LUT).
+ * @return Final frequency estimate in radians/sample
+ */
+double carrier_costas_qpsk_q15(CarrierSyncQ15 *cs, const CplxQ15 *in, int n,
+                               CplxQ15 *out);
+
+/* ── Viterbi ─────────────────────────────────────────────────────── */
+
+/**
+ * @brief Soft Viterbi on Q15 LLRs (positive = bit 0), int32 metrics.
+ *
+ * Same trellis as viterbi_decode_soft(), on int32 metrics that are
+ * renormalised every step so they never overflow.  Survivors are packed
+ * into a ring of 2·VITERBI_DEPTH steps on the stack, traced back each
+ * time it fills, so frames of any length decode with the same decision
+ * delay as the streaming ViterbiDecoder.
+ * @return n_coded / 2 decoded bits
+ */
+int viterbi_decode_soft_q15(const q15_t *llr, int n_coded, uint8_t *decoded);
+
+#endif /* FIXED_POINT_H */
@@ -56,6 +56,12 @@ int mod_modulate(ModScheme scheme, const uint8_t *bits, int nbits, Cplx *syms);
 
 /* ── Demodulate ──────────────────────────────────────────────────── */
 
+/**
+ * @brief Map packed bits to symbols; same mapping as mod_modulate().
+ * @return Number of symbols generated (bits->n / bps)
+ */
+int mod_modulate_packed(ModScheme scheme, const BitVec *bits, Cplx *syms);
+
 /**
  * @brief Hard-decision demodulation (minimum Euclidean distance).
  * @return Number of bits produced
@@ -69,7 +75,7 @@ int mod_demodulate(ModScheme scheme, const Cplx *syms, int nsyms, uint8_t *bits)
  * @return Number of LLR values produced
  */
 int mod_demodulate_soft(ModScheme scheme, const Cplx *syms, int nsyms,
-                        double sigma, double *llr);
+                        double sigma, real_t *llr);
 
 /* ── BER theoretical ─────────────────────────────────────────────── */
 
@@ -109,6 +115,10 @@ int gfsk_demodulate(const Cplx *in, int nsamples, int sps, uint8_t *bits);
 /* ── O-QPSK with half-sine shaping (802.15.4 / Zigbee) ──────────── */
 
 int oqpsk_modulate(const uint8_t *bits, int nbits, int sps, Cplx *out);
+
+/** oqpsk_modulate() with its pulse table taken from ws (see CommsArena). */
+int oqpsk_modulate_ws(const uint8_t *bits, int nbits, int sps, Cplx *out,
+                      CommsArena *ws);
 int oqpsk_demodulate(const Cplx *in, int nsamples, int sps, uint8_t *bits);
 
 /* ── Pulse shaping ───────────────────────────────────────────────── */
@@ -121,12 +131,12 @@ int oqpsk_demodulate(const Cplx *in, int nsamples, int sps, uint8_t *bits);
  * @param h       Output coefficients (span * sps + 1)
  * @return Filter length
  */
-int raised_cosine(double alpha, int sps, int span, double *h);
+int raised_cosine(double alpha, int sps, int span, real_t *h);
 
 /**
  * @brief Generate root-raised-cosine pulse shape.
  */
-int root_raised_cosine(double alpha, int sps, int span, double *h);
+int root_raised_cosine(double alpha, int sps, int span, real_t *h);
 
 /**
  * @brief Apply pulse shaping to symbols (upsample + filter).
@@ -138,15 +148,15 @@ int root_raised_cosine(double alpha, int sps, int span, double *h);
  * @param out     Output (nsyms * sps + hlen - 1)
  * @return Number of output samples
  */
-int pulse_shape(const double *syms, int nsyms, const double *h, int hlen,
-                int sps, double *out);
+int pulse_shape(const real_t *syms, int nsyms, const real_t *h, int hlen,
+                int sps, real_t *out);
 
 /**
  * @brief NRZ line coding: bit 0 → -1.0, bit 1 → +1.0 */
-void nrz_encode(const uint8_t *bits, int n, double *out);
+void nrz_encode(const uint8_t *bits, int n, real_t *out);
 
 /**
  * @brief Manchester line coding: each bit → two half-symbol values */
-void manchester_encode(const uint8_t *bits, int n, double *out);
+void manchester_encode(const uint8_t *bits, int n, real_t *out);
 
 #endif /* MODULATION_H */
@@ -6,27 +6,30 @@
  *   TX: symbol mapping → subcarrier assignment → IFFT → CP insertion
  *   RX: CP removal → FFT → pilot-based equalisation → demapping
  *
- * Also provides a simple FFT/IFFT (radix-2 DIT) used internally.
+ * The FFT, fast convolution and channeliser engines live in dsp.h.
  */
 
 #ifndef OFDM_H
 #define OFDM_H
 
 #include "comms_utils.h"
+#include "dsp.h"
+#include "modulation.h"
 #include <stdint.h>
 
-/* ── FFT (radix-2, in-place) ─────────────────────────────────────── */
-
-void fft(Cplx *x, int n);     /* Forward FFT   */
-void ifft(Cplx *x, int n);    /* Inverse FFT   */
-
 /* ── OFDM parameters ────────────────────────────────────────────── */
 
-#define OFDM_MAX_CARRIERS 1024
+#define OFDM_MAX_CARRIERS 4096
 #define OFDM_MAX_PILOTS    64
 
+/** Linear pilot interpolation for one data carrier. */
 typedef struct {
-    int  n_fft;              /* FFT size (must be power of 2)        */
+    uint8_t lo, hi;          /* bracketing pilots (equal at band edges) */
+    real_t  w;               /* weight of pilot hi                      */
+} OfdmInterp;
+
+typedef struct {
+    int  n_fft;              /* FFT size (any; 2^k fastest)          */
     int  n_cp;               /* cyclic prefix length (samples)       */
     int  n_data;             /* number of data subcarriers           */
     int  n_pilot;            /* number of pilot subcarriers          */
@@ -35,6 +38,8 @@ typedef struct {
     Cplx pilot_val;          /* pilot symbol value (e.g. 1+0j)      */
     int  n_guard_lo;         /* lower guard subcarriers              */
     int  n_guard_hi;         /* upper guard subcarriers              */
+    const FftPlan *plan;     /* shared n_fft plan (from ofdm_init)   */
+    OfdmInterp interp[OFDM_MAX_CARRIERS]; /* per data carrier (init) */
 } OfdmParams;
 
 /**
@@ -46,6 +51,17 @@ typedef struct {
  */
 void ofdm_init(OfdmParams *p, int n_fft, int n_cp, int n_pilot);
 
+/**
+ * Pilot estimates smoothed across symbols: a running mean over the
+ * first 1/alpha symbols, then an exponential average with weight alpha
+ * on each new symbol.  alpha = 1 disables averaging.
+ */
+typedef struct {
+    Cplx   h_pilot[OFDM_MAX_PILOTS]; /* smoothed estimates at the pilots */
+    double alpha;
+    int    n_symbols;                /* symbols absorbed                 */
+} OfdmPilotAvg;
+
 /* ── OFDM TX ─────────────────────────────────────────────────────── */
 
 /**
@@ -67,6 +83,16 @@ int ofdm_modulate(const OfdmParams *p, const Cplx *data_syms, Cplx *out);
 int ofdm_modulate_block(const OfdmParams *p, int n_symbols,
                         const Cplx *data_syms, Cplx *out);
 
+/**
+ * ofdm_modulate_block() with its batch buffer taken from ws.
+ *
+ * Power-of-2 sizes up to 256 are transformed up to 16 symbols at a
+ * time, SIMD across symbols, and each symbol is written with its cyclic
+ * prefix directly into out.  Output is bit-identical to ofdm_modulate().
+ */
+int ofdm_modulate_block_ws(const OfdmParams *p, int n_symbols,
+                           const Cplx *data_syms, Cplx *out, CommsArena *ws);
+
 /* ── OFDM RX ─────────────────────────────────────────────────────── */
 
 /**
@@ -80,8 +106,107 @@ int ofdm_modulate_block(const OfdmParams *p, int n_symbols,
 int ofdm_demodulate(const OfdmParams *p, const Cplx *in,
                     Cplx *data_syms, Cplx *h_est);
 
+/** ofdm_demodulate() with its n_fft-sample work buffer taken from ws. */
+int ofdm_demodulate_ws(const OfdmParams *p, const Cplx *in,
+                       Cplx *data_syms, Cplx *h_est, CommsArena *ws);
+
+/**
+ * ofdm_demodulate_ws() equalising with pilot estimates averaged over
+ * the symbols seen so far (see ofdm_channel_estimate_avg()).  A NULL
+ * avg gives the per-symbol estimate.
+ */
+int ofdm_demodulate_avg(const OfdmParams *p, const Cplx *in,
+                        Cplx *data_syms, Cplx *h_est,
+                        OfdmPilotAvg *avg, CommsArena *ws);
+
+/**
+ * @brief Demodulate n_symbols consecutive OFDM symbols, batched.
+ *
+ * Same per-symbol pilot equalisation as ofdm_demodulate(); the symbols
+ * are transformed in groups.
+ * @return n_symbols * p->n_data
+ */
 int ofdm_demodulate_block(const OfdmParams *p, int n_symbols,
                           const Cplx *in, Cplx *data_syms);
+int ofdm_demodulate_block_ws(const OfdmParams *p, int n_symbols,
+                             const Cplx *in, Cplx *data_syms, CommsArena *ws);
+
+/* Leading symbols whose pilots form the frame channel estimate */
+#define OFDM_FRAME_EST_SYMS 4
+
+/**
+ * @brief Demodulate a frame under a static channel: one estimate, reused.
+ *
+ * The pilots of the first OFDM_FRAME_EST_SYMS symbols are averaged into
+ * a single channel estimate, whose one-tap equaliser is then applied to
+ * every symbol of the frame.
+ * @param h_est  Output frame estimate at data positions (or NULL)
+ * @return n_symbols * p->n_data
+ */
+int ofdm_demodulate_frame(const OfdmParams *p, int n_symbols,
+                          const Cplx *in, Cplx *data_syms, Cplx *h_est,
+                          CommsArena *ws);
+
+/* ── Threaded frame processing ──────────────────────────────────── */
+
+#define OFDM_POOL_MAX_THREADS 64
+#define OFDM_POOL_WS_BYTES    (1 << 20)  /* scratch arena per worker   */
+
+/**
+ * Persistent worker pool for long frames.  The symbols of a frame are
+ * split into n_threads contiguous ranges, one per worker (the calling
+ * thread is worker 0), and each worker runs FFT, equalisation and the
+ * optional demap on its range with its own scratch arena.  Every output
+ * element depends only on its own symbol (and the frame estimate, which
+ * is computed once up front), so results are bit-identical to the
+ * single-threaded calls for any thread count.
+ *
+ * One frame at a time per pool; PROF counters are not thread-safe, so
+ * profile with a 1-thread pool.
+ */
+struct OfdmPoolSync;
+
+typedef struct {
+    int         n_threads;           /* workers, including the caller   */
+    CommsArena *ws;                  /* per-worker scratch [n_threads]  */
+    struct OfdmPoolSync *sync;       /* threads and signalling (NULL
+                                        when n_threads == 1)            */
+} OfdmPool;
+
+/**
+ * @brief Start n_threads − 1 worker threads.
+ * @param n_threads  Total workers; ≤ 0 uses every online CPU.  Clamped
+ *                   to OFDM_POOL_MAX_THREADS.
+ * @return 0, or −1 if memory or threads could not be obtained
+ */
+int  ofdm_pool_init(OfdmPool *pool, int n_threads);
+void ofdm_pool_free(OfdmPool *pool);
+
+/** Optional demap stage run by each worker on its own symbols. */
+typedef struct {
+    ModScheme scheme;
+    double    sigma;                 /* noise std-dev for the LLRs      */
+    uint8_t  *bits;                  /* hard bits (or NULL)             */
+    real_t   *llr;                   /* max-log LLRs (or NULL)          */
+} OfdmDemap;
+
+/**
+ * @brief ofdm_demodulate_block() on a pool, optionally demapped.
+ *
+ * With demap, bits / llr receive n_symbols · n_data · bps values in
+ * symbol order, as mod_demodulate() / mod_demodulate_soft() would
+ * produce over data_syms.
+ * @return n_symbols * p->n_data
+ */
+int ofdm_demodulate_block_mt(OfdmPool *pool, const OfdmParams *p,
+                             int n_symbols, const Cplx *in,
+                             Cplx *data_syms, const OfdmDemap *demap);
+
+/** ofdm_demodulate_frame() on a pool, optionally demapped. */
+int ofdm_demodulate_frame_mt(OfdmPool *pool, const OfdmParams *p,
+                             int n_symbols, const Cplx *in,
+                             Cplx *data_syms, Cplx *h_est,
+                             const OfdmDemap *demap);
 
 /* ── Channel estimation (via pilots) ─────────────────────────────── */
 
@@ -94,9 +219,106 @@ int ofdm_demodulate_block(const OfdmParams *p, int n_symbols,
 void ofdm_channel_estimate(const OfdmParams *p, const Cplx *rx_freq,
                            Cplx *h_interp);
 
+/** Start (or restart) averaging; alpha outside (0, 1] is taken as 1. */
+void ofdm_pilot_avg_init(OfdmPilotAvg *avg, double alpha);
+
+/**
+ * @brief ofdm_channel_estimate() with time-domain pilot averaging.
+ *
+ * Folds this symbol's pilots into avg (when non-NULL) and interpolates
+ * the smoothed estimates to the data carriers.
+ */
+void ofdm_channel_estimate_avg(const OfdmParams *p, const Cplx *rx_freq,
+                               OfdmPilotAvg *avg, Cplx *h_interp);
+
 /**
  * @brief Zero-forcing single-tap equalisation.
  */
 void ofdm_equalise_zf(const Cplx *data, const Cplx *h, int n, Cplx *out);
 
+/* ── Frame synchronisation (Schmidl & Cox) ──────────────────────── */
+
+/**
+ * Streaming timing and carrier-offset acquisition.  A frame is the
+ * two-symbol training preamble from ofdm_sync_preamble() followed by
+ * frame_syms data symbols.  Training symbol 1 uses only even carriers,
+ * so its halves repeat; the half-symbol autocorrelation
+ *
+ *   P(d) = Σ r*(d+m) r(d+m+L),  R(d) = ½ Σ |r(d+m)|² + |r(d+m+L)|²
+ *
+ * (m < L = n_fft/2) is updated in O(1) per sample.  With R over both
+ * halves M(d) = |P|² / R² never exceeds 1, even on burst edges, and it
+ * plateaus near 1 across the cyclic prefix.  The plateau centre gives
+ * the timing, arg P the fractional offset and the PN-coded second
+ * training symbol the even integer part.  Data symbols are returned
+ * CP-aligned and frequency-corrected, ready for ofdm_demodulate_block().
+ */
+typedef enum {
+    OFDM_SYNC_SEARCH,        /* scanning for a training symbol      */
+    OFDM_SYNC_TRAINING,      /* plateau found, awaiting symbol 2    */
+    OFDM_SYNC_DATA           /* handing out data symbols            */
+} OfdmSyncState;
+
+typedef struct {
+    const OfdmParams *p;
+    double  threshold;       /* M(d) level that opens a plateau      */
+    int     frame_syms;      /* data symbols per frame               */
+
+    /* Sliding metric over the last n_fft samples */
+    Cplx   *ring;            /* sample history (power-of-2 length)   */
+    int     mask;
+    int64_t t;               /* samples consumed                     */
+    Cplx    P;
+    double  R;
+
+    /* Plateau under evaluation */
+    real_t *m_buf;           /* M(d) from d = m_d0 on                */
+    int     m_len;
+    int64_t m_d0;
+    double  m_max;
+    Cplx    p_max;           /* P at the peak of M                   */
+
+    /* Current frame */
+    OfdmSyncState state;
+    int64_t t1;              /* start of training symbol 1 (past CP) */
+    int64_t next;            /* start of the next data symbol (CP)   */
+    int     n_out;           /* data symbols handed out this frame   */
+    double  cfo;             /* offset in subcarrier spacings        */
+    Cplx    nco_step;        /* e^{-j2π·cfo/n_fft}                   */
+    int     n_frames;        /* frames acquired so far               */
+
+    /* Training reference */
+    Cplx   *x1, *x2;         /* n_fft work buffers                   */
+    int    *even_k;          /* even used carriers ...               */
+    Cplx   *v;               /* ... and conj(X2 / X1) on them        */
+    int     n_even;
+    Cplx   *ref;             /* conj(X1), for fine timing            */
+} OfdmSync;
+
+/**
+ * @brief Write the two training symbols (2·(n_fft + n_cp) samples).
+ * @return Samples written
+ */
+int ofdm_sync_preamble(const OfdmParams *p, Cplx *out);
+
+/**
+ * @brief Prepare a synchroniser for frames on p (even n_fft).
+ * @param threshold   Plateau level for M(d), 0.5 is a good start
+ * @param frame_syms  Data symbols following each preamble (≥ 1)
+ * @return 0 on success, -1 on bad arguments or allocation failure
+ */
+int  ofdm_sync_init(OfdmSync *s, const OfdmParams *p, double threshold,
+                    int frame_syms);
+void ofdm_sync_free(OfdmSync *s);
+
+/**
+ * @brief Consume n stream samples, emit any data symbols completed.
+ *
+ * Symbols are n_fft + n_cp samples each, CP first, with the carrier
+ * offset removed.  At most n / (n_fft + n_cp) + 1 symbols are produced
+ * per call; out must have room for that many.
+ * @return Number of symbols written to out
+ */
+int  ofdm_sync_process(OfdmSync *s, const Cplx *in, int n, Cplx *out);
+
 #endif /* OFDM_H */
@@ -33,12 +33,16 @@ typedef struct {
 } WifiSignalField;
 
 /**
- * @brief Build 802.11a PPDU: short preamble + long preamble + SIGNAL + DATA.
+ * @brief Build 802.11a PPDU: short preamble + long preamble + DATA.
  * @param payload   PSDU bytes
  * @param n_bytes   PSDU length
  * @param rate      Data rate enum
  * @param out       Output baseband I/Q (caller allocates)
- * @return Number of samples produced
+ * @return Number of samples produced, or -1 for an unknown rate
+ *
+ * DATA carries SERVICE + PSDU + tail, scrambled, convolutionally coded
+ * and punctured to the rate's 1/2, 2/3 or 3/4, and mapped with its
+ * BPSK/QPSK/16-QAM/64-QAM onto whole OFDM symbols.
  */
 int wifi_build_ppdu(const uint8_t *payload, int n_bytes, WifiRate rate,
                     Cplx *out);
@@ -119,6 +123,7 @@ typedef struct {
     int  cr;              /* Coding rate (1=4/5, 2=4/6, 3=4/7, 4=4/8) */
     int  n_fft;           /* 2^SF                                  */
     int  fs;              /* Sample rate (= BW for baseband)       */
+    const struct FftPlan *plan;   /* shared 2^SF FFT plan (ofdm.h) */
 } LoraParams;
 
 /**
@@ -148,6 +153,10 @@ int lora_preamble(const LoraParams *lp, int n_pre, Cplx *out);
  */
 int lora_demodulate_symbol(const LoraParams *lp, const Cplx *in);
 
+/** lora_demodulate_symbol() with its 2^SF-sample buffer taken from ws. */
+int lora_demodulate_symbol_ws(const LoraParams *lp, const Cplx *in,
+                              CommsArena *ws);
+
 /**
  * @brief Modulate payload → full LoRa frame (preamble + symbols).
  * @return Total samples produced
@@ -0,0 +1,72 @@
+/**
+ * @file profile.h
+ * @brief Optional hot-path instrumentation: call counts, cycles, throughput.
+ *
+ * Build the library with -DCOMMS_PROFILE (`make profile`) and the major
+ * entry points — fft/ifft, viterbi_decode*, mod_demodulate*,
+ * ofdm_demodulate, channel_awgn and the adaptive equalisers — record
+ * per-function call counts, tick totals and samples processed, plus one
+ * trace event per call.  prof_report() prints the table;
+ * prof_write_trace() writes Chrome trace-event JSON (chrome://tracing,
+ * Perfetto).
+ *
+ * Without COMMS_PROFILE the PROF_* macros expand to nothing, so the
+ * instrumented functions compile exactly as before; prof_report() and
+ * friends still link and just say profiling is off.
+ *
+ * Ticks are the TSC (rdtsc) on x86 with GCC/Clang, CLOCK_MONOTONIC
+ * nanoseconds elsewhere.  Instrumented calls may run on any number of
+ * threads (the OFDM worker pool included): sites register under a lock,
+ * counters are atomic and each trace event reserves its own slot.  Call
+ * prof_report(), prof_write_trace() and prof_reset() while no
+ * instrumented call is in flight.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* ── Per-site counters ───────────────────────────────────────────── */
+
+typedef struct ProfSite {
+    const char      *name;
+    uint64_t         calls;
+    uint64_t         ticks;          /* total ticks inside the function */
+    uint64_t         samples;        /* items processed (caller-defined) */
+    struct ProfSite *next;           /* registration list               */
+    int              registered;
+} ProfSite;
+
+#define PROF_TRACE_MAX 65536         /* trace events kept (first N calls) */
+
+uint64_t prof_ticks(void);
+uint64_t prof_begin(ProfSite *site);
+void     prof_end(ProfSite *site, uint64_t t0, long samples);
+
+/** Print name, calls, total ms, mean µs/call and Msamples/s per site. */
+void     prof_report(FILE *fp);
+
+/** Write recorded calls as Chrome trace-event JSON.  0 or -1. */
+int      prof_write_trace(const char *path);
+
+/** Zero all counters and drop recorded trace events. */
+void     prof_reset(void);
+
+/** Counters for a site by name (NULL if never called / disabled). */
+const ProfSite *prof_find(const char *name);
+
+/* ── Instrumentation macros ──────────────────────────────────────── */
+
+#ifdef COMMS_PROFILE
+#define PROF_BEGIN(tag)                                                  \
+    static ProfSite prof_site_##tag = { #tag, 0, 0, 0, NULL, 0 };        \
+    uint64_t prof_t0_##tag = prof_begin(&prof_site_##tag)
+#define PROF_END(tag, n) prof_end(&prof_site_##tag, prof_t0_##tag, (long)(n))
+#else
+#define PROF_BEGIN(tag)  ((void)0)
+#define PROF_END(tag, n) ((void)0)
+#endif
+
+#endif /* PROFILE_H */
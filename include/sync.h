@@ -104,16 +104,16 @@ extern const int BARKER_7[7];
  * @param corr      Output correlation values (sig_len - pre_len + 1)
  * @return Index of correlation peak (frame start)
  */
-int frame_sync_correlate(const double *signal, int sig_len,
+int frame_sync_correlate(const real_t *signal, int sig_len,
                          const int *preamble, int pre_len,
-                         double *corr);
+                         real_t *corr);
 
 /**
  * @brief Detect preamble with threshold.
  * @param threshold  Detection threshold (normalised, 0.0–1.0)
  * @return Index of first detection, or -1 if not found.
  */
-int frame_sync_detect(const double *signal, int sig_len,
+int frame_sync_detect(const real_t *signal, int sig_len,
                       const int *preamble, int pre_len,
                       double threshold);
 
@@ -128,4 +128,13 @@ int frame_sync_detect(const double *signal, int sig_len,
  */
 void scrambler(uint16_t poly, uint16_t init, uint8_t *bits, int n);
 
+/**
+ * @brief Packed-bit scrambler, identical output to scrambler().
+ *
+ * The LFSR keystream is linear in its state, so 8 keystream bits and
+ * the next state come from two 256-entry table lookups; the keystream
+ * is XORed into the data a 64-bit word at a time.
+ */
+void scrambler_packed(uint16_t poly, uint16_t init, BitVec *bits);
+
 #endif /* SYNC_H */
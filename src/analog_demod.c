@@ -4,6 +4,7 @@
  */
 
 #include "analog_demod.h"
+#include "dsp.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -243,15 +244,30 @@ void lowpass_fir(const double *in, int n, double fc, int taps, double *out)
     /* Normalise */
     for (int k = 0; k < taps; k++) h[k] /= sum;
 
-    /* Apply convolution, delay-compensated */
+    /* Apply convolution, delay-compensated: out[i] is the full
+     * convolution at i + half.  Long filters go through the FFT. */
+    if (fastconv_faster(taps, taps, 1)) {
+        int len = n + taps - 1;
+        real_t *buf = (real_t *)malloc((size_t)(n + taps + len) * sizeof(real_t));
+        if (buf) {
+            real_t *x = buf, *hr = buf + n, *y = hr + taps;
+            for (int i = 0; i < n; i++) x[i] = (real_t)in[i];
+            for (int k = 0; k < taps; k++) hr[k] = (real_t)h[k];
+            int ok = fast_convolve_real(x, n, hr, taps, y) == len;
+            for (int i = 0; ok && i < n; i++) out[i] = y[i + half];
+            free(buf);
+            if (ok) { free(h); return; }
+        }
+    }
+
     for (int i = 0; i < n; i++) {
+        /* Taps whose input index i − k + half lies inside the signal */
+        int k0 = i + half - n + 1, k1 = i + half;
+        if (k0 < 0) k0 = 0;
+        if (k1 > taps - 1) k1 = taps - 1;
         double acc = 0.0;
-        for (int k = 0; k < taps; k++) {
-            int idx = i - k + half;
-            if (idx >= 0 && idx < n) {
-                acc += in[idx] * h[k];
-            }
-        }
+        for (int k = k0; k <= k1; k++)
+            acc += in[i - k + half] * h[k];
         out[i] = acc;
     }
     free(h);
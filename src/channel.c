@@ -12,6 +12,8 @@
  */
 
 #include "../include/channel.h"
+#include "../include/dsp.h"
+#include "../include/profile.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,7 +30,7 @@ double signal_power(const Cplx *x, int n)
     return p / n;
 }
 
-double signal_power_real(const double *x, int n)
+double signal_power_real(const real_t *x, int n)
 {
     double p = 0;
     for (int i = 0; i < n; i++)
@@ -52,8 +54,14 @@ double compute_snr_db(const Cplx *signal, const Cplx *noisy, int n)
  *  AWGN channel
  * ════════════════════════════════════════════════════════════════════ */
 
-double channel_awgn(const Cplx *in, int n, double snr_db, Cplx *out)
+/* Noise is drawn in blocks through a stack buffer: one bulk Ziggurat call
+ * per block keeps the add loop branch-free and vectorisable. */
+#define AWGN_CHUNK 256
+
+double channel_awgn_r(RngState *rng, const Cplx *in, int n, double snr_db,
+                      Cplx *out)
 {
+    PROF_BEGIN(channel_awgn);
     /* Compute signal power */
     double sig_pow = signal_power(in, n);
     if (sig_pow < 1e-30) sig_pow = 1.0;
@@ -63,14 +71,21 @@ double channel_awgn(const Cplx *in, int n, double snr_db, Cplx *out)
     double noise_var = sig_pow / snr_lin;
     double sigma = sqrt(noise_var / 2.0); /* per dimension */
 
-    for (int i = 0; i < n; i++) {
-        out[i].re = in[i].re + sigma * rng_gaussian();
-        out[i].im = in[i].im + sigma * rng_gaussian();
+    double noise[2 * AWGN_CHUNK];
+    for (int base = 0; base < n; base += AWGN_CHUNK) {
+        int len = (n - base < AWGN_CHUNK) ? n - base : AWGN_CHUNK;
+        rng_gaussian_fill_r(rng, noise, 2 * len);
+        for (int i = 0; i < len; i++) {
+            out[base + i].re = in[base + i].re + sigma * noise[2 * i];
+            out[base + i].im = in[base + i].im + sigma * noise[2 * i + 1];
+        }
     }
+    PROF_END(channel_awgn, n);
     return noise_var;
 }
 
-double channel_awgn_real(const double *in, int n, double snr_db, double *out)
+double channel_awgn_real_r(RngState *rng, const real_t *in, int n,
+                           double snr_db, real_t *out)
 {
     double sig_pow = signal_power_real(in, n);
     if (sig_pow < 1e-30) sig_pow = 1.0;
@@ -79,12 +94,27 @@ double channel_awgn_real(const double *in, int n, double snr_db, double *out)
     double noise_var = sig_pow / snr_lin;
     double sigma = sqrt(noise_var);
 
-    for (int i = 0; i < n; i++)
-        out[i] = in[i] + sigma * rng_gaussian();
+    double noise[AWGN_CHUNK];
+    for (int base = 0; base < n; base += AWGN_CHUNK) {
+        int len = (n - base < AWGN_CHUNK) ? n - base : AWGN_CHUNK;
+        rng_gaussian_fill_r(rng, noise, len);
+        for (int i = 0; i < len; i++)
+            out[base + i] = in[base + i] + sigma * noise[i];
+    }
 
     return noise_var;
 }
 
+double channel_awgn(const Cplx *in, int n, double snr_db, Cplx *out)
+{
+    return channel_awgn_r(rng_global_state(), in, n, snr_db, out);
+}
+
+double channel_awgn_real(const real_t *in, int n, double snr_db, real_t *out)
+{
+    return channel_awgn_real_r(rng_global_state(), in, n, snr_db, out);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  *  Eb/N0 ↔ SNR conversion
  * ════════════════════════════════════════════════════════════════════ */
@@ -107,31 +137,43 @@ double snr_to_ebn0(double snr_db, int bits_per_sym, double code_rate,
  *  Rayleigh fading
  * ════════════════════════════════════════════════════════════════════ */
 
-void channel_rayleigh_gen(int n, Cplx *coeffs)
+void channel_rayleigh_gen_r(RngState *rng, int n, Cplx *coeffs)
 {
     double sigma = 1.0 / sqrt(2.0); /* unit average power */
     for (int i = 0; i < n; i++)
-        coeffs[i] = cplx(sigma * rng_gaussian(), sigma * rng_gaussian());
+        coeffs[i] = cplx(sigma * rng_gaussian_r(rng),
+                         sigma * rng_gaussian_r(rng));
 }
 
-void channel_rayleigh_flat(RayleighChannel *ch, const Cplx *in, int n,
-                           Cplx *out, Cplx *h_est)
+void channel_rayleigh_gen(int n, Cplx *coeffs)
+{
+    channel_rayleigh_gen_r(rng_global_state(), n, coeffs);
+}
+
+void channel_rayleigh_flat_r(RngState *rng, RayleighChannel *ch,
+                             const Cplx *in, int n, Cplx *out, Cplx *h_est)
 {
     /* Generate one fading coefficient per block */
-    ch->last_coeff = cplx(ch->sigma * rng_gaussian(),
-                          ch->sigma * rng_gaussian());
+    ch->last_coeff = cplx(ch->sigma * rng_gaussian_r(rng),
+                          ch->sigma * rng_gaussian_r(rng));
     if (h_est) *h_est = ch->last_coeff;
 
     for (int i = 0; i < n; i++)
         out[i] = cplx_mul(in[i], ch->last_coeff);
 }
 
+void channel_rayleigh_flat(RayleighChannel *ch, const Cplx *in, int n,
+                           Cplx *out, Cplx *h_est)
+{
+    channel_rayleigh_flat_r(rng_global_state(), ch, in, n, out, h_est);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  *  Rician fading
  * ════════════════════════════════════════════════════════════════════ */
 
-void channel_rician_flat(RicianChannel *ch, const Cplx *in, int n,
-                         Cplx *out, Cplx *h_est)
+void channel_rician_flat_r(RngState *rng, RicianChannel *ch,
+                           const Cplx *in, int n, Cplx *out, Cplx *h_est)
 {
     double K = ch->k_factor;
     double los_gain = sqrt(K / (K + 1.0));
@@ -141,8 +183,8 @@ void channel_rician_flat(RicianChannel *ch, const Cplx *in, int n,
     Cplx los = cplx_from_polar(los_gain, ch->los_phase);
 
     /* Scattered (NLOS) component */
-    Cplx nlos = cplx(nlos_sigma * rng_gaussian(),
-                     nlos_sigma * rng_gaussian());
+    Cplx nlos = cplx(nlos_sigma * rng_gaussian_r(rng),
+                     nlos_sigma * rng_gaussian_r(rng));
 
     Cplx h = cplx_add(los, nlos);
     if (h_est) *h_est = h;
@@ -151,12 +193,18 @@ void channel_rician_flat(RicianChannel *ch, const Cplx *in, int n,
         out[i] = cplx_mul(in[i], h);
 }
 
+void channel_rician_flat(RicianChannel *ch, const Cplx *in, int n,
+                         Cplx *out, Cplx *h_est)
+{
+    channel_rician_flat_r(rng_global_state(), ch, in, n, out, h_est);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  *  Multipath (tapped delay line)
  * ════════════════════════════════════════════════════════════════════ */
 
-void channel_multipath_init(MultipathChannel *ch, int n_taps,
-                            const int *delays, const double *gains_db)
+void channel_multipath_init_r(RngState *rng, MultipathChannel *ch, int n_taps,
+                              const int *delays, const double *gains_db)
 {
     ch->n_taps = (n_taps > MULTIPATH_MAX_TAPS) ? MULTIPATH_MAX_TAPS : n_taps;
     for (int i = 0; i < ch->n_taps; i++) {
@@ -166,10 +214,17 @@ void channel_multipath_init(MultipathChannel *ch, int n_taps,
         /* Random complex coefficient with given power */
         double gain_lin = pow(10.0, gains_db[i] / 20.0);
         double sigma = gain_lin / sqrt(2.0);
-        ch->coeffs[i] = cplx(sigma * rng_gaussian(), sigma * rng_gaussian());
+        ch->coeffs[i] = cplx(sigma * rng_gaussian_r(rng),
+                             sigma * rng_gaussian_r(rng));
     }
 }
 
+void channel_multipath_init(MultipathChannel *ch, int n_taps,
+                            const int *delays, const double *gains_db)
+{
+    channel_multipath_init_r(rng_global_state(), ch, n_taps, delays, gains_db);
+}
+
 void channel_multipath_apply(const MultipathChannel *ch,
                              const Cplx *in, int n,
                              Cplx *out, int *out_len)
@@ -179,6 +234,20 @@ void channel_multipath_apply(const MultipathChannel *ch,
         if (ch->delays[t] > max_delay) max_delay = ch->delays[t];
 
     *out_len = n + max_delay;
+
+    /* Dense, long channel models: one FFT convolution with the tap
+     * profile laid out on the delay grid */
+    if (fastconv_faster(max_delay + 1, 4 * ch->n_taps, 0)) {
+        Cplx *h = (Cplx *)calloc((size_t)max_delay + 1, sizeof(Cplx));
+        if (h) {
+            for (int t = 0; t < ch->n_taps; t++)
+                h[ch->delays[t]] = cplx_add(h[ch->delays[t]], ch->coeffs[t]);
+            int r = fast_convolve(in, n, h, max_delay + 1, out);
+            free(h);
+            if (r == *out_len) return;
+        }
+    }
+
     memset(out, 0, (*out_len) * sizeof(Cplx));
 
     for (int t = 0; t < ch->n_taps; t++) {
@@ -13,8 +13,13 @@
  *   Lin & Costello, Error Control Coding (2nd ed.).
  */
 
+#define _POSIX_C_SOURCE 200112L   /* pthread_once */
+
 #include "../include/coding.h"
+#include "../include/cpu_dispatch.h"
+#include "../include/profile.h"
 #include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -34,83 +39,140 @@ double entropy(const double *probs, int n_symbols)
 }
 
 /* ════════════════════════════════════════════════════════════════════
- *  Huffman coding (min-heap based)
+ *  Huffman coding (canonical, length-limited, table-decoded)
  * ════════════════════════════════════════════════════════════════════ */
 
-typedef struct HuffNode {
-    double prob;
-    int    symbol;       /* -1 for internal nodes */
-    struct HuffNode *left, *right;
-} HuffNode;
+/* Decode table entries: a leaf holds the symbol and its full code
+ * length (0 = no such code); a link holds the offset and index width of
+ * the subtable for codes longer than HUFFMAN_LOOKUP_BITS. */
+#define HUFF_LINK        0x80000000u
+#define HUFF_LEAF(s, l)  ((uint32_t)(s) | (uint32_t)(l) << 8)
 
-static HuffNode *huff_new_node(double prob, int sym)
-{
-    HuffNode *n = (HuffNode *)calloc(1, sizeof(HuffNode));
-    n->prob = prob;
-    n->symbol = sym;
-    return n;
-}
+/* Package-merge item: a leaf (sym ≥ 0) or a package of items a and b
+ * of the previous level's list */
+typedef struct {
+    double w;
+    int    sym, a, b;
+} PmItem;
 
-static void huff_free_tree(HuffNode *n)
+static void pm_count(PmItem *const *lv, int level, int i, int *lengths)
 {
-    if (!n) return;
-    huff_free_tree(n->left);
-    huff_free_tree(n->right);
-    free(n);
+    const PmItem *it = &lv[level][i];
+    if (it->sym >= 0) {
+        lengths[it->sym]++;
+        return;
+    }
+    pm_count(lv, level - 1, it->a, lengths);
+    pm_count(lv, level - 1, it->b, lengths);
 }
 
-/* Simple min-heap for Huffman tree construction */
-typedef struct {
-    HuffNode *nodes[HUFFMAN_MAX_SYMBOLS];
-    int size;
-} MinHeap;
-
-static void heap_push(MinHeap *h, HuffNode *n)
+/* Optimal code lengths of at most HUFFMAN_MAX_CODELEN bits (Larmore &
+ * Hirschberg): level l's list merges the leaves with pairs of level
+ * l − 1's list; a symbol's length is how often it appears among the
+ * 2m − 2 cheapest items of the last level. */
+static int huff_lengths(const double *probs, int n_symbols, int *lengths)
 {
-    int i = h->size++;
-    h->nodes[i] = n;
-    while (i > 0) {
-        int parent = (i - 1) / 2;
-        if (h->nodes[parent]->prob > h->nodes[i]->prob) {
-            HuffNode *tmp = h->nodes[parent];
-            h->nodes[parent] = h->nodes[i];
-            h->nodes[i] = tmp;
-            i = parent;
-        } else break;
+    enum { L = HUFFMAN_MAX_CODELEN };
+    int order[HUFFMAN_MAX_SYMBOLS], m = 0;
+    for (int i = 0; i < n_symbols; i++) {
+        if (probs[i] <= 0) continue;
+        int j = m++;
+        for (; j > 0 && probs[order[j - 1]] > probs[i]; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
     }
+    if (m < 2) return -1;
+
+    PmItem *pool = (PmItem *)malloc((size_t)L * 2 * m * sizeof(PmItem));
+    PmItem *lv[L];
+    int len[L];
+    if (!pool) return -1;
+    for (int l = 0; l < L; l++) lv[l] = pool + (size_t)l * 2 * m;
+
+    for (int i = 0; i < m; i++)
+        lv[0][i] = (PmItem){ probs[order[i]], order[i], -1, -1 };
+    len[0] = m;
+    for (int l = 1; l < L; l++) {
+        int np = len[l - 1] / 2, i = 0, j = 0, k = 0;
+        while (i < m || j < np) {
+            double wp = j < np ? lv[l - 1][2 * j].w + lv[l - 1][2 * j + 1].w
+                               : 0;
+            if (j >= np || (i < m && lv[0][i].w <= wp))
+                lv[l][k++] = lv[0][i++];
+            else {
+                lv[l][k++] = (PmItem){ wp, -1, 2 * j, 2 * j + 1 };
+                j++;
+            }
+        }
+        len[l] = k;
+    }
+
+    memset(lengths, 0, (size_t)n_symbols * sizeof(int));
+    for (int i = 0; i < 2 * m - 2; i++)
+        pm_count(lv, L - 1, i, lengths);
+    free(pool);
+    return 0;
 }
 
-static HuffNode *heap_pop(MinHeap *h)
+/* Canonical codes from the lengths, then the primary table and one
+ * subtable per primary slot whose codes run past it, sized by the
+ * longest of them */
+static int huff_canonical(HuffmanTable *ht)
 {
-    HuffNode *min = h->nodes[0];
-    h->nodes[0] = h->nodes[--h->size];
-    int i = 0;
-    while (1) {
-        int left = 2 * i + 1, right = 2 * i + 2, smallest = i;
-        if (left < h->size && h->nodes[left]->prob < h->nodes[smallest]->prob)
-            smallest = left;
-        if (right < h->size && h->nodes[right]->prob < h->nodes[smallest]->prob)
-            smallest = right;
-        if (smallest == i) break;
-        HuffNode *tmp = h->nodes[i];
-        h->nodes[i] = h->nodes[smallest];
-        h->nodes[smallest] = tmp;
-        i = smallest;
-    }
-    return min;
-}
-
-static void huff_build_codes(HuffNode *n, uint32_t code, int len,
-                             HuffmanTable *ht)
-{
-    if (!n) return;
-    if (n->symbol >= 0) {
-        ht->codes[n->symbol] = code;
-        ht->lengths[n->symbol] = len;
-        return;
+    enum { K = HUFFMAN_LOOKUP_BITS };
+    int count[HUFFMAN_MAX_CODELEN + 1] = { 0 };
+    uint32_t next[HUFFMAN_MAX_CODELEN + 2];
+    for (int s = 0; s < ht->n_symbols; s++) count[ht->lengths[s]]++;
+    count[0] = 0;
+    next[1] = 0;
+    for (int l = 1; l <= HUFFMAN_MAX_CODELEN; l++)
+        next[l + 1] = (next[l] + count[l]) << 1;
+
+    ht->max_len = 0;
+    for (int s = 0; s < ht->n_symbols; s++) {
+        int l = ht->lengths[s];
+        if (!l) continue;
+        ht->codes[s] = next[l]++;
+        if (l > ht->max_len) ht->max_len = l;
     }
-    huff_build_codes(n->left,  (code << 1) | 0, len + 1, ht);
-    huff_build_codes(n->right, (code << 1) | 1, len + 1, ht);
+
+    uint32_t *t = ht->lookup;
+    uint8_t sub[1 << K];
+    memset(t, 0, sizeof(ht->lookup));
+    memset(sub, 0, sizeof(sub));
+    for (int s = 0; s < ht->n_symbols; s++) {
+        int l = ht->lengths[s];
+        if (l > K) {
+            uint32_t p = ht->codes[s] >> (l - K);
+            if (l - K > sub[p]) sub[p] = (uint8_t)(l - K);
+        }
+    }
+    int off = 1 << K;
+    for (int p = 0; p < (1 << K); p++) {
+        if (!sub[p]) continue;
+        if (off + (1 << sub[p]) > HUFFMAN_TABLE_SIZE) return -1;
+        t[p] = HUFF_LINK | (uint32_t)off << 8 | sub[p];
+        off += 1 << sub[p];
+    }
+
+    for (int s = 0; s < ht->n_symbols; s++) {
+        int l = ht->lengths[s];
+        if (!l) continue;
+        uint32_t c = ht->codes[s], *dst;
+        int span;
+        if (l <= K) {
+            dst = t + (c << (K - l));
+            span = 1 << (K - l);
+        } else {
+            uint32_t e = t[c >> (l - K)];
+            int m = (int)(e & 0xFF);
+            uint32_t low = c & ((1u << (l - K)) - 1);
+            dst = t + (e >> 8 & 0xFFFF) + (low << (m - (l - K)));
+            span = 1 << (m - (l - K));
+        }
+        for (int i = 0; i < span; i++) dst[i] = HUFF_LEAF(s, l);
+    }
+    return 0;
 }
 
 int huffman_build(const double *probs, int n_symbols, HuffmanTable *ht)
@@ -119,26 +181,9 @@ int huffman_build(const double *probs, int n_symbols, HuffmanTable *ht)
 
     memset(ht, 0, sizeof(*ht));
     ht->n_symbols = n_symbols;
-
-    MinHeap heap = { .size = 0 };
-    for (int i = 0; i < n_symbols; i++) {
-        if (probs[i] > 0)
-            heap_push(&heap, huff_new_node(probs[i], i));
-    }
-    if (heap.size < 2) return -1;
-
-    while (heap.size > 1) {
-        HuffNode *a = heap_pop(&heap);
-        HuffNode *b = heap_pop(&heap);
-        HuffNode *parent = huff_new_node(a->prob + b->prob, -1);
-        parent->left = a;
-        parent->right = b;
-        heap_push(&heap, parent);
-    }
-
-    HuffNode *root = heap_pop(&heap);
-    huff_build_codes(root, 0, 0, ht);
-    huff_free_tree(root);
+    if (huff_lengths(probs, n_symbols, ht->lengths) < 0 ||
+        huff_canonical(ht) < 0)
+        return -1;
 
     /* Compute average code length */
     ht->avg_length = 0;
@@ -149,19 +194,31 @@ int huffman_build(const double *probs, int n_symbols, HuffmanTable *ht)
     return 0;
 }
 
+/* Decode-table entry for a HUFFMAN_MAX_CODELEN-bit window, MSB first */
+static inline uint32_t huff_lookup(const HuffmanTable *ht, uint32_t w)
+{
+    enum { K = HUFFMAN_LOOKUP_BITS, W = HUFFMAN_MAX_CODELEN };
+    uint32_t e = ht->lookup[w >> (W - K)];
+    if (e & HUFF_LINK) {
+        int m = (int)(e & 0xFF);
+        e = ht->lookup[(e >> 8 & 0xFFFF) +
+                       ((w >> (W - K - m)) & ((1u << m) - 1))];
+    }
+    return e;
+}
+
 int huffman_encode(const HuffmanTable *ht, const uint8_t *syms, int n,
                    uint8_t *bits, int max_bits)
 {
     int pos = 0;
     for (int i = 0; i < n; i++) {
         int sym = syms[i];
-        if (sym >= ht->n_symbols) return -1;
+        if (sym >= ht->n_symbols || ht->lengths[sym] == 0) return -1;
         int len = ht->lengths[sym];
         uint32_t code = ht->codes[sym];
-        for (int b = len - 1; b >= 0; b--) {
-            if (pos >= max_bits) return -1;
+        if (pos + len > max_bits) return -1;
+        for (int b = len - 1; b >= 0; b--)
             bits[pos++] = (code >> b) & 1;
-        }
     }
     return pos;
 }
@@ -169,26 +226,95 @@ int huffman_encode(const HuffmanTable *ht, const uint8_t *syms, int n,
 int huffman_decode(const HuffmanTable *ht, const uint8_t *bits, int nbits,
                    uint8_t *syms, int max_syms)
 {
-    /* Brute-force table lookup (simple, not performance-critical) */
     int pos = 0, nsyms = 0;
     while (pos < nbits && nsyms < max_syms) {
-        int found = 0;
-        for (int s = 0; s < ht->n_symbols && !found; s++) {
-            int len = ht->lengths[s];
-            if (len == 0 || pos + len > nbits) continue;
-            uint32_t code = ht->codes[s];
-            int match = 1;
-            for (int b = 0; b < len && match; b++) {
-                if (((code >> (len - 1 - b)) & 1) != (bits[pos + b] & 1))
-                    match = 0;
-            }
-            if (match) {
-                syms[nsyms++] = (uint8_t)s;
-                pos += len;
-                found = 1;
-            }
+        uint32_t w = 0;
+        for (int b = 0; b < HUFFMAN_MAX_CODELEN; b++)
+            w = (w << 1) | (pos + b < nbits ? bits[pos + b] & 1 : 0);
+        uint32_t e = huff_lookup(ht, w);
+        int len = (int)(e >> 8 & 0xFF);
+        if (len == 0 || pos + len > nbits) break; /* invalid bitstream */
+        syms[nsyms++] = (uint8_t)e;
+        pos += len;
+    }
+    return nsyms;
+}
+
+int huffman_encode_packed(const HuffmanTable *ht, const uint8_t *syms,
+                          int n, uint8_t *out, int max_bytes)
+{
+    /* Codes collect right-aligned in acc; whole 32-bit words flush */
+    uint64_t acc = 0;
+    int nacc = 0, pos = 0;
+    for (int i = 0; i < n; i++) {
+        int sym = syms[i];
+        if (sym >= ht->n_symbols || ht->lengths[sym] == 0) return -1;
+        acc = (acc << ht->lengths[sym]) | ht->codes[sym];
+        nacc += ht->lengths[sym];
+        if (nacc >= 32) {
+            if (pos + 4 > max_bytes) return -1;
+            uint32_t x = (uint32_t)(acc >> (nacc - 32));
+            out[pos]     = (uint8_t)(x >> 24);
+            out[pos + 1] = (uint8_t)(x >> 16);
+            out[pos + 2] = (uint8_t)(x >> 8);
+            out[pos + 3] = (uint8_t)x;
+            pos += 4;
+            nacc -= 32;
+        }
+    }
+    int nbits = 8 * pos + nacc;
+    for (; nacc > 0; nacc -= 8) {
+        if (pos >= max_bytes) return -1;
+        out[pos++] = (uint8_t)(nacc >= 8 ? acc >> (nacc - 8)
+                                         : acc << (8 - nacc));
+    }
+    return nbits;
+}
+
+/* Top HUFFMAN_MAX_CODELEN bits of the decode buffer */
+#define HUFF_PEEK(buf) ((uint32_t)((buf) >> (64 - HUFFMAN_MAX_CODELEN)))
+
+int huffman_decode_packed(const HuffmanTable *ht, const uint8_t *in,
+                          int nbits, uint8_t *syms, int max_syms)
+{
+    /* buf holds cnt unread bits MSB-aligned.  A refill loads 8 bytes
+     * and tops it up to 56–63 bits (bits past cnt are rewritten
+     * unchanged by the next one), enough for three codes.  The bulk
+     * loop stays clear of the last byte and its padding; the tail is
+     * fed a byte at a time with the length checked per code. */
+    const int nbytes = (nbits + 7) / 8;
+    uint64_t buf = 0;
+    int cnt = 0, pos = 0, used = 0, nsyms = 0;
+
+    while (pos + 9 <= nbytes && nsyms + 3 <= max_syms) {
+        uint64_t x = 0;
+        for (int j = 0; j < 8; j++) x = (x << 8) | in[pos + j];
+        buf |= x >> cnt;
+        pos += (63 - cnt) >> 3;
+        cnt |= 56;
+        for (int j = 0; j < 3; j++) {
+            uint32_t e = huff_lookup(ht, HUFF_PEEK(buf));
+            int len = (int)(e >> 8 & 0xFF);
+            if (len == 0) return nsyms;           /* invalid bitstream */
+            syms[nsyms++] = (uint8_t)e;
+            buf <<= len;
+            cnt -= len;
+            used += len;
+        }
+    }
+
+    while (used < nbits && nsyms < max_syms) {
+        while (cnt <= 56 && pos < nbytes) {
+            buf |= (uint64_t)in[pos++] << (56 - cnt);
+            cnt += 8;
         }
-        if (!found) break; /* invalid bitstream */
+        uint32_t e = huff_lookup(ht, HUFF_PEEK(buf));
+        int len = (int)(e >> 8 & 0xFF);
+        if (len == 0 || used + len > nbits) break; /* invalid bitstream */
+        syms[nsyms++] = (uint8_t)e;
+        buf <<= len;
+        cnt -= len;
+        used += len;
     }
     return nsyms;
 }
@@ -232,51 +358,149 @@ int rle_decode(const uint8_t *data, int n, uint8_t *out, int max_out)
  *  CRC — CRC-16-CCITT, CRC-32, CRC-24 (Mode-S)
  * ════════════════════════════════════════════════════════════════════ */
 
-uint16_t crc16_ccitt(const uint8_t *data, int n)
+/* Slice-by-8 tables, tab[k][b] = the CRC of byte b followed by k zero
+ * bytes.  CRC-32 is reflected (LSB first); the MSB-first CRC-16 and
+ * CRC-24 run left-aligned in a 32-bit register so they share one
+ * update loop.  Runs of 64+ bytes of CRC-32 go to the dispatched
+ * crc32_fold kernel first, which folds them with PCLMULQDQ on CPUs
+ * that have it. */
+#define CRC32_POLY_REFL 0xEDB88320u
+
+static const struct { int width; uint32_t poly, init, xorout; int refl; }
+crc_params[CRC_N_KINDS] = {
+    [CRC_16_CCITT] = { 16, 0x1021,     0xFFFF,     0,          0 },
+    [CRC_32]       = { 32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, 1 },
+    [CRC_24_ADSB]  = { 24, 0xFFF409,   0,          0,          0 },
+};
+
+static uint32_t       crc_tab[CRC_N_KINDS][8][256];
+static pthread_once_t crc_tables_once = PTHREAD_ONCE_INIT;
+
+static void crc_tables_build(void)
 {
-    uint16_t crc = 0xFFFF;
-    for (int i = 0; i < n; i++) {
-        crc ^= (uint16_t)data[i] << 8;
-        for (int b = 0; b < 8; b++) {
-            if (crc & 0x8000)
-                crc = (crc << 1) ^ 0x1021;
-            else
-                crc <<= 1;
+    for (int k = 0; k < CRC_N_KINDS; k++) {
+        uint32_t (*t)[256] = crc_tab[k];
+        int refl = crc_params[k].refl;
+        uint32_t poly = crc_params[k].poly << (32 - crc_params[k].width);
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t c = refl ? b : b << 24;
+            for (int i = 0; i < 8; i++) {
+                if (refl) c = (c >> 1) ^ ((c & 1) ? CRC32_POLY_REFL : 0);
+                else      c = (c << 1) ^ ((c >> 31) ? poly : 0);
+            }
+            t[0][b] = c;
+        }
+        for (int j = 1; j < 8; j++) {
+            for (int b = 0; b < 256; b++) {
+                uint32_t c = t[j - 1][b];
+                t[j][b] = refl ? (c >> 8) ^ t[0][c & 0xFF]
+                               : (c << 8) ^ t[0][c >> 24];
+            }
         }
     }
-    return crc;
 }
 
-uint32_t crc32(const uint8_t *data, int n)
+/* Chunks of one message may be checked on several threads at once */
+static void crc_tables_init(void)
 {
-    uint32_t crc = 0xFFFFFFFF;
-    for (int i = 0; i < n; i++) {
-        crc ^= data[i];
-        for (int b = 0; b < 8; b++) {
-            if (crc & 1)
-                crc = (crc >> 1) ^ 0xEDB88320;
-            else
-                crc >>= 1;
+    pthread_once(&crc_tables_once, crc_tables_build);
+}
+
+void crc_init(CrcCtx *c, CrcKind kind)
+{
+    crc_tables_init();
+    c->kind = kind;
+    c->reg = crc_params[kind].refl
+                 ? crc_params[kind].init
+                 : crc_params[kind].init << (32 - crc_params[kind].width);
+}
+
+void crc_update(CrcCtx *c, const uint8_t *data, int n)
+{
+    const uint32_t (*t)[256] = (const uint32_t (*)[256])crc_tab[c->kind];
+    uint32_t r = c->reg;
+    int i = 0;
+
+    if (crc_params[c->kind].refl) {
+        /* Bulk by carry-less multiply where the CPU has it */
+        i = comms_kernels()->crc32_fold(&r, data, n);
+        for (; i + 8 <= n; i += 8) {
+            const uint8_t *d = data + i;
+            r ^= (uint32_t)d[0] | (uint32_t)d[1] << 8 |
+                 (uint32_t)d[2] << 16 | (uint32_t)d[3] << 24;
+            r = t[7][r & 0xFF] ^ t[6][(r >> 8) & 0xFF] ^
+                t[5][(r >> 16) & 0xFF] ^ t[4][r >> 24] ^
+                t[3][d[4]] ^ t[2][d[5]] ^ t[1][d[6]] ^ t[0][d[7]];
         }
+        for (; i < n; i++)
+            r = (r >> 8) ^ t[0][(r ^ data[i]) & 0xFF];
+    } else {
+        for (; i + 8 <= n; i += 8) {
+            const uint8_t *d = data + i;
+            r ^= (uint32_t)d[0] << 24 | (uint32_t)d[1] << 16 |
+                 (uint32_t)d[2] << 8 | (uint32_t)d[3];
+            r = t[7][r >> 24] ^ t[6][(r >> 16) & 0xFF] ^
+                t[5][(r >> 8) & 0xFF] ^ t[4][r & 0xFF] ^
+                t[3][d[4]] ^ t[2][d[5]] ^ t[1][d[6]] ^ t[0][d[7]];
+        }
+        for (; i < n; i++)
+            r = (r << 8) ^ t[0][(r >> 24) ^ data[i]];
     }
-    return crc ^ 0xFFFFFFFF;
+    c->reg = r;
+}
+
+uint32_t crc_finalize(const CrcCtx *c)
+{
+    uint32_t r = crc_params[c->kind].refl
+                     ? c->reg
+                     : c->reg >> (32 - crc_params[c->kind].width);
+    return r ^ crc_params[c->kind].xorout;
+}
+
+/* a·b mod P over GF(2), reflected: bit 31 is x^0 */
+static uint32_t crc32_multmodp(uint32_t a, uint32_t b)
+{
+    uint32_t p = 0;
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) p ^= b;
+        b = (b >> 1) ^ ((b & 1) ? CRC32_POLY_REFL : 0);
+    }
+    return p;
+}
+
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, long len_b)
+{
+    /* crc(A‖B) = crc(A)·x^(8·len_b) ⊕ crc(B); x^(2^k) by squaring */
+    uint32_t xp = 1u << 31, sq = 1u << 30;           /* x^0, x^1 */
+    for (unsigned long n = (unsigned long)len_b * 8; n; n >>= 1) {
+        if (n & 1) xp = crc32_multmodp(sq, xp);
+        sq = crc32_multmodp(sq, sq);
+    }
+    return crc32_multmodp(xp, crc_a) ^ crc_b;
+}
+
+static uint32_t crc_oneshot(CrcKind kind, const uint8_t *data, int n)
+{
+    CrcCtx c;
+    crc_init(&c, kind);
+    crc_update(&c, data, n);
+    return crc_finalize(&c);
+}
+
+uint16_t crc16_ccitt(const uint8_t *data, int n)
+{
+    return (uint16_t)crc_oneshot(CRC_16_CCITT, data, n);
+}
+
+uint32_t crc32(const uint8_t *data, int n)
+{
+    return crc_oneshot(CRC_32, data, n);
 }
 
 uint32_t crc24_adsb(const uint8_t *data, int n)
 {
     /* CRC-24 for Mode-S / ADS-B: polynomial 0xFFF409 */
-    uint32_t crc = 0;
-    for (int i = 0; i < n; i++) {
-        crc ^= (uint32_t)data[i] << 16;
-        for (int b = 0; b < 8; b++) {
-            if (crc & 0x800000)
-                crc = (crc << 1) ^ 0xFFF409;
-            else
-                crc <<= 1;
-            crc &= 0xFFFFFF;
-        }
-    }
-    return crc;
+    return crc_oneshot(CRC_24_ADSB, data, n);
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -370,138 +594,406 @@ int hamming74_decode(const uint8_t *code7, uint8_t *data4)
  *  Convolutional encoder (rate 1/2, K=7)
  * ════════════════════════════════════════════════════════════════════ */
 
-static int popcount(unsigned int x)
+/* Branch outputs per 7-bit register, and for each 6-bit history the 16
+ * coded bits a whole input byte produces (MSB first, G0 then G1 per
+ * input bit).  The history after a byte is simply its low 6 bits. */
+static uint8_t  conv_branch[2 * CONV_STATES];
+static uint16_t conv_byte[CONV_STATES][256];
+static pthread_once_t conv_tables_once = PTHREAD_ONCE_INIT;
+
+static int parity(unsigned int x)
 {
-    int c = 0;
-    while (x) { c += x & 1; x >>= 1; }
-    return c;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return (int)(x & 1);
 }
 
-void conv_encode(const uint8_t *in, int n, uint8_t *out)
+static void conv_tables_build(void)
 {
-    unsigned int state = 0;
+    for (unsigned int r = 0; r < 2 * CONV_STATES; r++)
+        conv_branch[r] = (uint8_t)(parity(r & CONV_G0) << 1 |
+                                   parity(r & CONV_G1));
+    for (unsigned int s = 0; s < CONV_STATES; s++) {
+        for (unsigned int x = 0; x < 256; x++) {
+            unsigned int r = s, c = 0;
+            for (int j = 7; j >= 0; j--) {
+                r = ((r << 1) | ((x >> j) & 1)) & (2 * CONV_STATES - 1);
+                c = (c << 2) | conv_branch[r];
+            }
+            conv_byte[s][x] = (uint16_t)c;
+        }
+    }
+}
+
+/* Built once, on first use from whichever thread gets there first */
+static void conv_tables_init(void)
+{
+    pthread_once(&conv_tables_once, conv_tables_build);
+}
+
+const uint8_t *conv_branch_table(void)
+{
+    conv_tables_init();
+    return conv_branch;
+}
+
+/* n bits from register *reg (newest input in bit 0) → 2n coded bits */
+static void conv_encode_run(unsigned int *reg, const uint8_t *in, int n,
+                            uint8_t *out)
+{
+    unsigned int state = *reg;
     for (int i = 0; i < n; i++) {
         state = ((state << 1) | (in[i] & 1)) & (CONV_STATES * 2 - 1);
-        out[2 * i]     = popcount(state & CONV_G0) & 1;
-        out[2 * i + 1] = popcount(state & CONV_G1) & 1;
+        out[2 * i]     = conv_branch[state] >> 1;
+        out[2 * i + 1] = conv_branch[state] & 1;
     }
+    *reg = state;
+}
+
+void conv_encode(const uint8_t *in, int n, uint8_t *out)
+{
+    conv_tables_init();
+    unsigned int state = 0;
+    conv_encode_run(&state, in, n, out);
+}
+
+unsigned int conv_encode_bytes(unsigned int state, const uint8_t *in,
+                               int n_bytes, uint8_t *out)
+{
+    conv_tables_init();
+    state &= CONV_STATES - 1;
+    for (int i = 0; i < n_bytes; i++) {
+        uint16_t c = conv_byte[state][in[i]];
+        out[2 * i]     = (uint8_t)(c >> 8);
+        out[2 * i + 1] = (uint8_t)c;
+        state = ((state << 8) | in[i]) & (CONV_STATES - 1);
+    }
+    return state;
+}
+
+void conv_encode_packed(const BitVec *in, BitVec *out)
+{
+    conv_tables_init();
+    unsigned int state = 0;
+    int n = in->n;
+
+    /* 32 inputs → one 64-bit output word.  Bits past n are zero, so
+     * the tail is encoded as zeros and masked off. */
+    out->n = 2 * n;
+    for (int k = 0; k < BITVEC_WORDS(2 * n); k++) {
+        uint32_t x = (uint32_t)(in->w[k >> 1] >> (k & 1 ? 0 : 32));
+        uint64_t acc = 0;
+        for (int b = 3; b >= 0; b--) {
+            unsigned int byte = (x >> (8 * b)) & 0xFF;
+            acc = (acc << 16) | conv_byte[state][byte];
+            state = ((state << 8) | byte) & (CONV_STATES - 1);
+        }
+        out->w[k] = acc;
+    }
+    if ((2 * n) & 63)
+        out->w[(2 * n) >> 6] &= ~0ULL << (64 - ((2 * n) & 63));
 }
 
 /* ════════════════════════════════════════════════════════════════════
- *  Viterbi decoder (hard decision)
+ *  Puncturing (IEEE 802.11-2020 §17.3.5.6, §19.3.11.6.2)
  * ════════════════════════════════════════════════════════════════════ */
 
-#define VITERBI_INF 1e30
+/* Per rate: the mother-code positions kept from each period of A0 B0
+ * A1 B1 ... pairs, and for each prefix of a period how many are kept. */
+typedef struct {
+    int     period;
+    int     n_keep;
+    uint8_t keep[6];
+    uint8_t prefix[11];
+} PunctPattern;
+
+static const PunctPattern punct_patterns[CONV_N_RATES] = {
+    [CONV_RATE_1_2] = { 2, 2, { 0, 1 },             { 0, 1, 2 } },
+    [CONV_RATE_2_3] = { 4, 3, { 0, 1, 2 },          { 0, 1, 2, 3, 3 } },
+    [CONV_RATE_3_4] = { 6, 4, { 0, 1, 2, 5 },       { 0, 1, 2, 3, 3, 3, 4 } },
+    [CONV_RATE_5_6] = { 10, 6, { 0, 1, 2, 5, 6, 9 },
+                        { 0, 1, 2, 3, 3, 3, 4, 5, 5, 5, 6 } },
+};
+
+/* Mother-code bits per encode/decode run: a whole number of periods at
+ * every rate (lcm 60) */
+#define PUNCT_CHUNK 600
 
-int viterbi_decode(const uint8_t *coded, int n_coded, uint8_t *decoded)
+int conv_punctured_len(ConvRate rate, int n)
 {
-    int n_data = n_coded / 2;
-    if (n_data < 1) return 0;
+    const PunctPattern *pp = &punct_patterns[rate];
+    return n / pp->period * pp->n_keep + pp->prefix[n % pp->period];
+}
 
-    /* Path metrics */
-    double pm_old[CONV_STATES], pm_new[CONV_STATES];
-    int path[256][CONV_STATES]; /* limit to 256 bits max for stack alloc */
+int conv_depunctured_len(ConvRate rate, int n)
+{
+    const PunctPattern *pp = &punct_patterns[rate];
+    int r = n % pp->n_keep;
+    int m = n / pp->n_keep * pp->period + (r ? pp->keep[r - 1] + 1 : 0);
+    return (m + 1) & ~1;
+}
 
-    int max_len = n_data < 256 ? n_data : 256;
+int conv_puncture(ConvRate rate, const uint8_t *in, int n, uint8_t *out)
+{
+    const PunctPattern *pp = &punct_patterns[rate];
+    int full = n / pp->period, o = 0;
+    for (int b = 0; b < full; b++, in += pp->period)
+        for (int j = 0; j < pp->n_keep; j++)
+            out[o++] = in[pp->keep[j]];
+    for (int j = 0; j < pp->prefix[n % pp->period]; j++)
+        out[o++] = in[pp->keep[j]];
+    return o;
+}
 
-    for (int s = 0; s < CONV_STATES; s++) pm_old[s] = VITERBI_INF;
-    pm_old[0] = 0;
+int conv_depuncture(ConvRate rate, const real_t *in, int n, real_t *out)
+{
+    const PunctPattern *pp = &punct_patterns[rate];
+    int m = conv_depunctured_len(rate, n);
+    memset(out, 0, (size_t)m * sizeof(real_t));
+    int full = n / pp->n_keep;
+    for (int b = 0; b < full; b++, out += pp->period)
+        for (int j = 0; j < pp->n_keep; j++)
+            out[pp->keep[j]] = *in++;
+    for (int j = 0; j < n % pp->n_keep; j++)
+        out[pp->keep[j]] = *in++;
+    return m;
+}
 
-    for (int t = 0; t < max_len; t++) {
-        for (int s = 0; s < CONV_STATES; s++) pm_new[s] = VITERBI_INF;
+int conv_encode_punctured(ConvRate rate, const uint8_t *in, int n,
+                          uint8_t *out)
+{
+    conv_tables_init();
+    uint8_t mother[PUNCT_CHUNK];
+    unsigned int state = 0;
+    int o = 0;
+    for (int i = 0; i < n; i += PUNCT_CHUNK / 2) {
+        int c = n - i < PUNCT_CHUNK / 2 ? n - i : PUNCT_CHUNK / 2;
+        conv_encode_run(&state, in + i, c, mother);
+        o += conv_puncture(rate, mother, 2 * c, out + o);
+    }
+    return o;
+}
 
-        uint8_t r0 = coded[2 * t] & 1;
-        uint8_t r1 = coded[2 * t + 1] & 1;
+/* ════════════════════════════════════════════════════════════════════
+ *  Viterbi decoder: sliding-window traceback over packed survivors
+ * ════════════════════════════════════════════════════════════════════ */
 
-        for (int s = 0; s < CONV_STATES; s++) {
-            if (pm_old[s] >= VITERBI_INF) continue;
+#define VITERBI_INF    UINT8_MAX     /* unreachable start states: the
+                                        saturating rail                  */
+#define VITERBI_CHUNK  256           /* steps per ACS kernel call        */
+#define VITERBI_FRAME  1024          /* stack ring of the frame decoders */
 
-            for (int bit = 0; bit <= 1; bit++) {
-                int ns = ((s << 1) | bit) & (CONV_STATES - 1);
-                unsigned int full_state = (s << 1) | bit;
-                uint8_t e0 = popcount(full_state & CONV_G0) & 1;
-                uint8_t e1 = popcount(full_state & CONV_G1) & 1;
+static void viterbi_setup(ViterbiDecoder *v, int depth, int len,
+                          uint64_t *surv)
+{
+    memset(v, 0, sizeof(*v));
+    v->depth = depth;
+    v->len = len;
+    v->surv = surv;
+    /* Butterfly j's upper branch into state 2j has encoder register 2j */
+    const uint8_t *br = conv_branch_table();
+    for (int j = 0; j < CONV_STATES / 2; j++) v->br[j] = br[2 * j];
+    viterbi_reset(v);
+}
 
-                double bm = (e0 != r0) + (e1 != r1); /* Hamming distance */
-                double metric = pm_old[s] + bm;
+int viterbi_init(ViterbiDecoder *v, int depth)
+{
+    if (depth <= 0) depth = VITERBI_DEPTH;
+    uint64_t *surv = (uint64_t *)malloc((size_t)2 * depth * sizeof(uint64_t));
+    if (!surv) {
+        memset(v, 0, sizeof(*v));
+        return -1;
+    }
+    viterbi_setup(v, depth, 2 * depth, surv);
+    v->owned = 1;
+    return 0;
+}
 
-                if (metric < pm_new[ns]) {
-                    pm_new[ns] = metric;
-                    path[t][ns] = s;
-                }
-            }
-        }
+void viterbi_free(ViterbiDecoder *v)
+{
+    if (v->owned) free(v->surv);
+    memset(v, 0, sizeof(*v));
+}
 
-        memcpy(pm_old, pm_new, sizeof(pm_old));
-    }
+void viterbi_reset(ViterbiDecoder *v)
+{
+    for (int s = 0; s < CONV_STATES; s++) v->pm[s] = VITERBI_INF;
+    v->pm[0] = 0;
+    v->t = v->n_out = 0;
+    v->have_half = 0;
+}
 
-    /* Traceback from best final state */
-    int best_state = 0;
-    for (int s = 1; s < CONV_STATES; s++)
-        if (pm_old[s] < pm_old[best_state]) best_state = s;
+/* One traceback step: the predecessor of state s given that step's
+ * decision word w (bit s). */
+static inline int viterbi_back(uint64_t w, int s)
+{
+    return (s >> 1) | (int)((w >> s) & 1) << (CONV_K - 2);
+}
 
-    int state = best_state;
-    for (int t = max_len - 1; t >= 0; t--) {
-        int prev = path[t][state];
-        decoded[t] = (state >> (CONV_K - 2)) & 1;
-        state = prev;
+/* Trace back from the best state at t over every undecided step and
+ * release the oldest cnt of them; a survivor bit picks the upper (0) or
+ * lower (1) predecessor.  Bit 0 of the state after step t is input t. */
+static int viterbi_release(ViterbiDecoder *v, int cnt, uint8_t *out)
+{
+    int state = 0;
+    for (int s = 1; s < CONV_STATES; s++)
+        if (v->pm[s] < v->pm[state]) state = s;
+
+    /* Walk the ring backwards from the newest step */
+    long t = v->t - 1, stop = v->n_out + cnt;
+    int pos = (int)(t % v->len);
+    for (; t >= stop; t--) {
+        state = viterbi_back(v->surv[pos], state);
+        pos = pos ? pos - 1 : v->len - 1;
+    }
+    for (; t >= v->n_out; t--) {
+        out[t - v->n_out] = state & 1;
+        state = viterbi_back(v->surv[pos], state);
+        pos = pos ? pos - 1 : v->len - 1;
     }
+    v->n_out = stop;
+    return cnt;
+}
 
-    return max_len;
+/* 5-bit branch input: hard bits as ±1, LLRs through the dispatched
+ * quantiser. */
+static void viterbi_quantise(const CommsKernels *kern, const uint8_t *coded,
+                             const real_t *llr, int n, int8_t *q)
+{
+    if (coded) {
+        for (int i = 0; i < n; i++)
+            q[i] = (int8_t)(1 - 2 * (coded[i] & 1));
+        return;
+    }
+    kern->llr_quant8(llr, n, VITERBI_LLR_SCALE, VITERBI_LLR_MAX, q);
 }
 
-int viterbi_decode_soft(const double *llr, int n_coded, uint8_t *decoded)
+/* Hard bits (coded) or LLRs (llr) through the trellis in kernel-sized
+ * runs, pairing values across calls; each time the ring fills, releases
+ * all but the newest depth steps. */
+static int viterbi_feed(ViterbiDecoder *v, const uint8_t *coded,
+                        const real_t *llr, int n, uint8_t *out)
 {
-    int n_data = n_coded / 2;
-    if (n_data < 1) return 0;
+    const CommsKernels *kern = comms_kernels();
+    int8_t q[2 * VITERBI_CHUNK];
+    int n_out = 0, i = 0;
 
-    double pm_old[CONV_STATES], pm_new[CONV_STATES];
-    int path[256][CONV_STATES];
-    int max_len = n_data < 256 ? n_data : 256;
+    while (i < n) {
+        /* A run stops at the ring end and where the ring fills */
+        int pos = (int)(v->t % v->len);
+        int steps = v->len - (int)(v->t - v->n_out);
+        if (steps > v->len - pos) steps = v->len - pos;
+        if (steps > VITERBI_CHUNK) steps = VITERBI_CHUNK;
+
+        int k = 0;
+        if (v->have_half) {
+            q[k++] = v->half;
+            v->have_half = 0;
+        }
+        int c = n - i < 2 * steps - k ? n - i : 2 * steps - k;
+        viterbi_quantise(kern, coded ? coded + i : NULL,
+                         llr ? llr + i : NULL, c, q + k);
+        i += c;
+        k += c;
+        if (k & 1) {
+            v->half = q[--k];
+            v->have_half = 1;
+        }
 
-    for (int s = 0; s < CONV_STATES; s++) pm_old[s] = VITERBI_INF;
-    pm_old[0] = 0;
+        if (k > 0) {
+            kern->viterbi_acs8(v->pm, q, k / 2, v->br, v->surv + pos);
+            v->t += k / 2;
+        }
+        if (v->t - v->n_out == v->len)
+            n_out += viterbi_release(v, v->len - v->depth, out + n_out);
+    }
+    return n_out;
+}
 
-    for (int t = 0; t < max_len; t++) {
-        for (int s = 0; s < CONV_STATES; s++) pm_new[s] = VITERBI_INF;
+int viterbi_process(ViterbiDecoder *v, const uint8_t *coded, int n,
+                    uint8_t *out)
+{
+    PROF_BEGIN(viterbi_process);
+    int m = viterbi_feed(v, coded, NULL, n, out);
+    PROF_END(viterbi_process, n);
+    return m;
+}
 
-        double l0 = llr[2 * t];
-        double l1 = llr[2 * t + 1];
+int viterbi_process_soft(ViterbiDecoder *v, const real_t *llr, int n,
+                         uint8_t *out)
+{
+    PROF_BEGIN(viterbi_process_soft);
+    int m = viterbi_feed(v, NULL, llr, n, out);
+    PROF_END(viterbi_process_soft, n);
+    return m;
+}
 
-        for (int s = 0; s < CONV_STATES; s++) {
-            if (pm_old[s] >= VITERBI_INF) continue;
+int viterbi_flush(ViterbiDecoder *v, uint8_t *out)
+{
+    int m = viterbi_release(v, (int)(v->t - v->n_out), out);
+    viterbi_reset(v);
+    return m;
+}
 
-            for (int bit = 0; bit <= 1; bit++) {
-                int ns = ((s << 1) | bit) & (CONV_STATES - 1);
-                unsigned int full_state = (s << 1) | bit;
-                uint8_t e0 = popcount(full_state & CONV_G0) & 1;
-                uint8_t e1 = popcount(full_state & CONV_G1) & 1;
+/* Whole frames through a decoder whose ring lives on the stack: a
+ * full-frame traceback up to VITERBI_FRAME bits, and beyond that one
+ * traceback per VITERBI_FRAME − VITERBI_DEPTH released bits, so the
+ * walk costs little more than a step per bit. */
+int viterbi_decode(const uint8_t *coded, int n_coded, uint8_t *decoded)
+{
+    int n_data = n_coded / 2;
+    if (n_data < 1) return 0;
+    PROF_BEGIN(viterbi_decode);
 
-                /* Soft metric: LLR * encoded bit (positive = agrees with 0) */
-                double bm = (e0 ? -l0 : l0) + (e1 ? -l1 : l1);
-                double metric = pm_old[s] - bm;
+    ViterbiDecoder v;
+    uint64_t surv[VITERBI_FRAME];
+    viterbi_setup(&v, VITERBI_DEPTH, VITERBI_FRAME, surv);
+    int m = viterbi_feed(&v, coded, NULL, 2 * n_data, decoded);
+    m += viterbi_flush(&v, decoded + m);
 
-                if (metric < pm_new[ns]) {
-                    pm_new[ns] = metric;
-                    path[t][ns] = s;
-                }
-            }
-        }
-        memcpy(pm_old, pm_new, sizeof(pm_old));
-    }
+    PROF_END(viterbi_decode, n_coded);
+    return m;
+}
 
-    int best_state = 0;
-    for (int s = 1; s < CONV_STATES; s++)
-        if (pm_old[s] < pm_old[best_state]) best_state = s;
+int viterbi_decode_soft(const real_t *llr, int n_coded, uint8_t *decoded)
+{
+    int n_data = n_coded / 2;
+    if (n_data < 1) return 0;
+    PROF_BEGIN(viterbi_decode_soft);
+
+    ViterbiDecoder v;
+    uint64_t surv[VITERBI_FRAME];
+    viterbi_setup(&v, VITERBI_DEPTH, VITERBI_FRAME, surv);
+    int m = viterbi_feed(&v, NULL, llr, 2 * n_data, decoded);
+    m += viterbi_flush(&v, decoded + m);
+
+    PROF_END(viterbi_decode_soft, n_coded);
+    return m;
+}
 
-    int state = best_state;
-    for (int t = max_len - 1; t >= 0; t--) {
-        int prev = path[t][state];
-        decoded[t] = (state >> (CONV_K - 2)) & 1;
-        state = prev;
+int viterbi_decode_punctured(ConvRate rate, const real_t *llr, int n,
+                             uint8_t *decoded)
+{
+    const PunctPattern *pp = &punct_patterns[rate];
+    int per_chunk = PUNCT_CHUNK / pp->period * pp->n_keep;
+    if (conv_depunctured_len(rate, n) < 2) return 0;
+    PROF_BEGIN(viterbi_decode_punctured);
+
+    ViterbiDecoder v;
+    uint64_t surv[VITERBI_FRAME];
+    real_t mother[PUNCT_CHUNK];
+    viterbi_setup(&v, VITERBI_DEPTH, VITERBI_FRAME, surv);
+    int m = 0;
+    for (int i = 0; i < n; i += per_chunk) {
+        int c = n - i < per_chunk ? n - i : per_chunk;
+        int k = conv_depuncture(rate, llr + i, c, mother);
+        m += viterbi_feed(&v, NULL, mother, k, decoded + m);
     }
+    m += viterbi_flush(&v, decoded + m);
 
-    return max_len;
+    PROF_END(viterbi_decode_punctured, n);
+    return m;
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -550,3 +1042,32 @@ void interleaver_deapply(const Interleaver *itl,
     for (int i = 0; i < n && i < size; i++)
         out[itl->inv[i]] = in[i];
 }
+
+/* A partial block still scatters over the whole rows·cols span, so
+ * out always gets the full block with the unfilled positions zero. */
+static int permute_packed(const int *perm, int size,
+                          const BitVec *in, BitVec *out)
+{
+    if (out->cap < size) return -1;
+    int n = in->n < size ? in->n : size;
+    out->n = size;
+    memset(out->w, 0, BITVEC_WORDS(size) * sizeof(uint64_t));
+    for (int i = 0; i < n; i++) {
+        uint64_t bit = (in->w[i >> 6] >> (63 - (i & 63))) & 1;
+        int j = perm[i];
+        out->w[j >> 6] |= bit << (63 - (j & 63));
+    }
+    return 0;
+}
+
+int interleaver_apply_packed(const Interleaver *itl,
+                             const BitVec *in, BitVec *out)
+{
+    return permute_packed(itl->perm, itl->rows * itl->cols, in, out);
+}
+
+int interleaver_deapply_packed(const Interleaver *itl,
+                               const BitVec *in, BitVec *out)
+{
+    return permute_packed(itl->inv, itl->rows * itl->cols, in, out);
+}
@@ -9,15 +9,20 @@
  *
  * References:
  *   Box-Muller transform for Gaussian noise generation.
+ *   Ziggurat method (Marsaglia & Tsang, 2000; ZIGNOR variant,
+ *   Doornik, 2005) for bulk Gaussian noise.
  *   Xoshiro256** PRNG (Blackman & Vigna, 2018).
  */
-#define _POSIX_C_SOURCE 199309L   /* clock_gettime */
+#define _POSIX_C_SOURCE 200112L   /* clock_gettime, posix_memalign, pthreads */
 
 #include "../include/comms_utils.h"
+#include "../include/cpu_dispatch.h"
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 /* ════════════════════════════════════════════════════════════════════
  *  Complex arithmetic
@@ -80,18 +85,171 @@ Cplx cplx_exp_j(double theta)
     return cplx(cos(theta), sin(theta));
 }
 
+/* ════════════════════════════════════════════════════════════════════
+ *  Split-complex (SoA) buffers
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define CPLXBUF_ALIGN 64
+
+int cplxbuf_alloc(CplxBuf *b, int n)
+{
+    /* One block: re[] then im[], each padded to a cache line */
+    size_t stride = ((size_t)n * sizeof(real_t) + CPLXBUF_ALIGN - 1)
+                    & ~(size_t)(CPLXBUF_ALIGN - 1);
+    void *mem = NULL;
+    b->re = b->im = NULL;
+    b->n = 0;
+    if (n <= 0 || posix_memalign(&mem, CPLXBUF_ALIGN, 2 * stride) != 0)
+        return -1;
+    b->re = (real_t *)mem;
+    b->im = (real_t *)((char *)mem + stride);
+    b->n = n;
+    memset(mem, 0, 2 * stride);
+    return 0;
+}
+
+void cplxbuf_free(CplxBuf *b)
+{
+    free(b->re);
+    b->re = b->im = NULL;
+    b->n = 0;
+}
+
+void cplxbuf_from_cplx(CplxBuf *dst, const Cplx *src, int n)
+{
+    real_t *restrict re = dst->re;
+    real_t *restrict im = dst->im;
+    for (int i = 0; i < n; i++) {
+        re[i] = src[i].re;
+        im[i] = src[i].im;
+    }
+}
+
+void cplxbuf_to_cplx(const CplxBuf *src, Cplx *dst, int n)
+{
+    const real_t *restrict re = src->re;
+    const real_t *restrict im = src->im;
+    for (int i = 0; i < n; i++) {
+        dst[i].re = re[i];
+        dst[i].im = im[i];
+    }
+}
+
+void cplxbuf_mac(CplxBuf *acc, const CplxBuf *a, const CplxBuf *b, int n)
+{
+    comms_kernels()->cplx_mac(acc->re, acc->im, a->re, a->im, b->re, b->im,
+                              n);
+}
+
+Cplx cplxbuf_dot(const CplxBuf *a, const CplxBuf *b, int n)
+{
+    return comms_kernels()->cplx_dot(a->re, a->im, b->re, b->im, n);
+}
+
+void cplxbuf_mag2(const CplxBuf *x, real_t *out, int n)
+{
+    const real_t *restrict re = x->re, *restrict im = x->im;
+    real_t *restrict o = out;
+    for (int i = 0; i < n; i++)
+        o[i] = re[i] * re[i] + im[i] * im[i];
+}
+
+Cplx cplxbuf_rotate(CplxBuf *x, int n, Cplx phasor, Cplx step)
+{
+    /* Phasors for a block of ROT_BLOCK samples are built by recurrence,
+     * then applied in a vectorisable loop.  The running phasor is
+     * renormalised once per block so |phasor| cannot drift;
+     * step is assumed to have unit magnitude. */
+    enum { ROT_BLOCK = 64 };
+    real_t pr[ROT_BLOCK], pi[ROT_BLOCK];
+    real_t *restrict re = x->re, *restrict im = x->im;
+    double mag0 = cplx_mag(phasor);
+
+    for (int base = 0; base < n; base += ROT_BLOCK) {
+        int len = (n - base < ROT_BLOCK) ? n - base : ROT_BLOCK;
+        for (int i = 0; i < len; i++) {
+            pr[i] = phasor.re;
+            pi[i] = phasor.im;
+            phasor = cplx_mul(phasor, step);
+        }
+        for (int i = 0; i < len; i++) {
+            real_t r = re[base + i], m = im[base + i];
+            re[base + i] = r * pr[i] - m * pi[i];
+            im[base + i] = r * pi[i] + m * pr[i];
+        }
+        double mag = cplx_mag(phasor);
+        if (mag > 0.0) phasor = cplx_scale(phasor, mag0 / mag);
+    }
+    return phasor;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Scratch arena
+ * ════════════════════════════════════════════════════════════════════ */
+
+int arena_init(CommsArena *a, size_t bytes)
+{
+    void *mem = NULL;
+    a->base = NULL;
+    a->size = a->used = 0;
+    bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (bytes == 0 || posix_memalign(&mem, ARENA_ALIGN, bytes) != 0)
+        return -1;
+    a->base = (uint8_t *)mem;
+    a->size = bytes;
+    return 0;
+}
+
+void arena_free(CommsArena *a)
+{
+    free(a->base);
+    a->base = NULL;
+    a->size = a->used = 0;
+}
+
+void *arena_alloc(CommsArena *a, size_t bytes)
+{
+    size_t need = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (need > a->size - a->used) return NULL;
+    void *p = a->base + a->used;
+    a->used += need;
+    return p;
+}
+
+void arena_reset(CommsArena *a)
+{
+    a->used = 0;
+}
+
+void *arena_scratch(CommsArena *ws, size_t bytes)
+{
+    void *p = ws ? arena_alloc(ws, bytes) : NULL;
+    return p ? p : malloc(bytes);
+}
+
+void arena_scratch_free(CommsArena *ws, void *p)
+{
+    uint8_t *b = (uint8_t *)p;
+    if (ws && b >= ws->base && b < ws->base + ws->size)
+        ws->used = (size_t)(b - ws->base);
+    else
+        free(p);
+}
+
 /* ════════════════════════════════════════════════════════════════════
  *  PRNG — Xoshiro256** (fast, high quality)
  * ════════════════════════════════════════════════════════════════════ */
 
-static uint64_t rng_state[4] = { 1, 2, 3, 4 };
+static RngState rng_global = { { 1, 2, 3, 4 } };
 
 static uint64_t rotl(uint64_t x, int k)
 {
     return (x << k) | (x >> (64 - k));
 }
 
-void rng_seed(uint64_t seed)
+static void zig_init(void);
+
+void rng_state_seed(RngState *rng, uint64_t seed)
 {
     /* SplitMix64 to initialise state from a single seed */
     for (int i = 0; i < 4; i++) {
@@ -99,42 +257,192 @@ void rng_seed(uint64_t seed)
         uint64_t z = seed;
         z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
         z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
-        rng_state[i] = z ^ (z >> 31);
+        rng->s[i] = z ^ (z >> 31);
     }
+    zig_init();   /* build Ziggurat tables before any worker reads them */
 }
 
-static uint64_t rng_next(void)
+uint64_t rng_next_r(RngState *rng)
 {
-    uint64_t result = rotl(rng_state[1] * 5, 7) * 9;
-    uint64_t t = rng_state[1] << 17;
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
 
-    rng_state[2] ^= rng_state[0];
-    rng_state[3] ^= rng_state[1];
-    rng_state[1] ^= rng_state[2];
-    rng_state[0] ^= rng_state[3];
-    rng_state[2] ^= t;
-    rng_state[3] = rotl(rng_state[3], 45);
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
 
     return result;
 }
 
-double rng_uniform(void)
+double rng_uniform_r(RngState *rng)
 {
-    return (rng_next() >> 11) * (1.0 / (1ULL << 53));
+    return (rng_next_r(rng) >> 11) * (1.0 / (1ULL << 53));
 }
 
-double rng_gaussian(void)
+double rng_gaussian_r(RngState *rng)
 {
     /* Box-Muller transform */
-    double u1 = rng_uniform();
-    double u2 = rng_uniform();
-    while (u1 < 1e-15) u1 = rng_uniform(); /* avoid log(0) */
+    double u1 = rng_uniform_r(rng);
+    double u2 = rng_uniform_r(rng);
+    while (u1 < 1e-15) u1 = rng_uniform_r(rng); /* avoid log(0) */
     return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
 }
 
+int rng_bernoulli_r(RngState *rng, double p)
+{
+    return rng_uniform_r(rng) < p ? 1 : 0;
+}
+
+/* Jump polynomials from the reference implementation (Blackman & Vigna) */
+static void rng_jump_poly(RngState *rng, const uint64_t poly[4])
+{
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (poly[i] & (1ULL << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            rng_next_r(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+void rng_jump(RngState *rng)
+{
+    static const uint64_t JUMP[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    rng_jump_poly(rng, JUMP);
+}
+
+void rng_long_jump(RngState *rng)
+{
+    static const uint64_t LONG_JUMP[4] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+        0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+    };
+    rng_jump_poly(rng, LONG_JUMP);
+}
+
+/* ── Ziggurat (ZIGNOR, 128 layers) ──────────────────────────────────
+ * Layer i covers |x| < zig_x[i]; zig_r[i] = zig_x[i+1] / zig_x[i] is the
+ * fraction of the layer lying fully under the density, where a sample
+ * is accepted with a single compare.  Layer 0 is the base strip plus
+ * the tail beyond ZIG_R.
+ */
+#define ZIG_LAYERS 128
+#define ZIG_R      3.442619855899
+#define ZIG_V      9.91256303526217e-3
+
+static double zig_x[ZIG_LAYERS + 1];
+static double zig_r[ZIG_LAYERS];
+static pthread_once_t zig_once = PTHREAD_ONCE_INIT;
+
+static void zig_build(void)
+{
+    double f = exp(-0.5 * ZIG_R * ZIG_R);
+    zig_x[0] = ZIG_V / f;
+    zig_x[1] = ZIG_R;
+    zig_x[ZIG_LAYERS] = 0.0;
+    for (int i = 2; i < ZIG_LAYERS; i++) {
+        zig_x[i] = sqrt(-2.0 * log(ZIG_V / zig_x[i - 1] + f));
+        f = exp(-0.5 * zig_x[i] * zig_x[i]);
+    }
+    for (int i = 0; i < ZIG_LAYERS; i++)
+        zig_r[i] = zig_x[i + 1] / zig_x[i];
+}
+
+/* Built once, even when several workers seed their streams at once */
+static void zig_init(void)
+{
+    pthread_once(&zig_once, zig_build);
+}
+
+/* Uniform on (0, 1) — never 0, safe for log() */
+static double rng_uniform_open_r(RngState *rng)
+{
+    return ((rng_next_r(rng) >> 11) + 0.5) * (1.0 / (1ULL << 53));
+}
+
+static double zig_sample(RngState *rng)
+{
+    for (;;) {
+        /* Top 53 bits → u in [-1, 1), low 7 bits → layer */
+        uint64_t r = rng_next_r(rng);
+        double u = 2.0 * ((r >> 11) * (1.0 / (1ULL << 53))) - 1.0;
+        int i = (int)(r & (ZIG_LAYERS - 1));
+
+        if (fabs(u) < zig_r[i])
+            return u * zig_x[i];
+
+        if (i == 0) {
+            /* Tail beyond ZIG_R (Marsaglia's exponential method) */
+            double x, y;
+            do {
+                x = log(rng_uniform_open_r(rng)) / ZIG_R;
+                y = log(rng_uniform_open_r(rng));
+            } while (-2.0 * y < x * x);
+            return u < 0 ? x - ZIG_R : ZIG_R - x;
+        }
+
+        /* Wedge: accept against the true density */
+        double x  = u * zig_x[i];
+        double f0 = exp(-0.5 * (zig_x[i] * zig_x[i] - x * x));
+        double f1 = exp(-0.5 * (zig_x[i + 1] * zig_x[i + 1] - x * x));
+        if (f1 + rng_uniform_r(rng) * (f0 - f1) < 1.0)
+            return x;
+    }
+}
+
+void rng_gaussian_fill_r(RngState *rng, double *buf, int n)
+{
+    zig_init();
+    for (int i = 0; i < n; i++)
+        buf[i] = zig_sample(rng);
+}
+
+/* Global-state wrappers */
+
+RngState *rng_global_state(void)
+{
+    return &rng_global;
+}
+
+void rng_seed(uint64_t seed)
+{
+    rng_state_seed(&rng_global, seed);
+}
+
+double rng_uniform(void)
+{
+    return rng_uniform_r(&rng_global);
+}
+
+double rng_gaussian(void)
+{
+    return rng_gaussian_r(&rng_global);
+}
+
 int rng_bernoulli(double p)
 {
-    return rng_uniform() < p ? 1 : 0;
+    return rng_bernoulli_r(&rng_global, p);
+}
+
+void rng_gaussian_fill(double *buf, int n)
+{
+    rng_gaussian_fill_r(&rng_global, buf, n);
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -159,13 +467,18 @@ void bytes_from_bits(const uint8_t *bits, int nbits, uint8_t *bytes)
     }
 }
 
-void random_bits(uint8_t *bits, int n)
+void random_bits_r(RngState *rng, uint8_t *bits, int n)
 {
     for (int i = 0; i < n; i++) {
-        bits[i] = rng_bernoulli(0.5);
+        bits[i] = rng_bernoulli_r(rng, 0.5);
     }
 }
 
+void random_bits(uint8_t *bits, int n)
+{
+    random_bits_r(&rng_global, bits, n);
+}
+
 int bit_errors(const uint8_t *a, const uint8_t *b, int n)
 {
     int count = 0;
@@ -175,6 +488,109 @@ int bit_errors(const uint8_t *a, const uint8_t *b, int n)
     return count;
 }
 
+/* ── Packed bitstreams ──────────────────────────────────────────── */
+
+static int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* Clear bits past bv->n in the last word */
+static void bitvec_mask_tail(BitVec *bv)
+{
+    int rem = bv->n & 63;
+    if (rem) bv->w[bv->n / 64] &= ~0ULL << (64 - rem);
+}
+
+int bitvec_init(BitVec *bv, int cap_bits)
+{
+    bv->n = 0;
+    bv->cap = 0;
+    bv->w = (uint64_t *)calloc(BITVEC_WORDS(cap_bits) ? BITVEC_WORDS(cap_bits) : 1,
+                               sizeof(uint64_t));
+    if (!bv->w) return -1;
+    bv->cap = cap_bits;
+    return 0;
+}
+
+void bitvec_free(BitVec *bv)
+{
+    free(bv->w);
+    bv->w = NULL;
+    bv->n = bv->cap = 0;
+}
+
+int bitvec_get(const BitVec *bv, int i)
+{
+    return (int)((bv->w[i >> 6] >> (63 - (i & 63))) & 1);
+}
+
+void bitvec_set(BitVec *bv, int i, int v)
+{
+    uint64_t m = 1ULL << (63 - (i & 63));
+    if (v & 1) bv->w[i >> 6] |= m;
+    else       bv->w[i >> 6] &= ~m;
+}
+
+void bitvec_from_bits(BitVec *bv, const uint8_t *bits, int n)
+{
+    if (n > bv->cap) n = bv->cap;
+    bv->n = n;
+    for (int k = 0; k < BITVEC_WORDS(n); k++) {
+        uint64_t word = 0;
+        int len = (n - 64 * k < 64) ? n - 64 * k : 64;
+        for (int b = 0; b < len; b++)
+            word |= (uint64_t)(bits[64 * k + b] & 1) << (63 - b);
+        bv->w[k] = word;
+    }
+}
+
+void bitvec_to_bits(const BitVec *bv, uint8_t *bits)
+{
+    for (int i = 0; i < bv->n; i++)
+        bits[i] = (uint8_t)((bv->w[i >> 6] >> (63 - (i & 63))) & 1);
+}
+
+void bitvec_from_bytes(BitVec *bv, const uint8_t *bytes, int nbytes)
+{
+    if (nbytes * 8 > bv->cap) nbytes = bv->cap / 8;
+    bv->n = nbytes * 8;
+    memset(bv->w, 0, BITVEC_WORDS(bv->n) * sizeof(uint64_t));
+    for (int i = 0; i < nbytes; i++)
+        bv->w[i >> 3] |= (uint64_t)bytes[i] << (56 - 8 * (i & 7));
+}
+
+void random_bits_packed_r(RngState *rng, BitVec *bv)
+{
+    for (int k = 0; k < BITVEC_WORDS(bv->n); k++)
+        bv->w[k] = rng_next_r(rng);
+    bitvec_mask_tail(bv);
+}
+
+void random_bits_packed(BitVec *bv)
+{
+    random_bits_packed_r(&rng_global, bv);
+}
+
+int bit_errors_packed(const BitVec *a, const BitVec *b)
+{
+    int n = a->n < b->n ? a->n : b->n;
+    int full = n / 64, rem = n & 63;
+    int count = 0;
+    for (int k = 0; k < full; k++)
+        count += popcount64(a->w[k] ^ b->w[k]);
+    if (rem)
+        count += popcount64((a->w[full] ^ b->w[full]) & (~0ULL << (64 - rem)));
+    return count;
+}
+
 void print_bits(const uint8_t *bits, int n, const char *label)
 {
     printf("%s: ", label);
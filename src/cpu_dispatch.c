@@ -0,0 +1,763 @@
+/**
+ * @file cpu_dispatch.c
+ * @brief CPU feature detection and per-ISA kernel tables.
+ *
+ * Each kernel body is written once as an always-inline generic function
+ * and instantiated per level inside a wrapper carrying
+ * __attribute__((target(...))); the compiler autovectorises each copy for
+ * its ISA.  With FP contraction off the copies are bit-identical.
+ *
+ * TUTORIAL CROSS-REFERENCES:
+ *   FFT butterflies       → chapters/14-ofdm/README.md
+ *   Viterbi ACS           → chapters/11-convolutional-viterbi/README.md
+ *   Soft demapping        → chapters/05-modulation/README.md
+ *
+ * References:
+ *   Intel SDM Vol. 2A, CPUID; Vol. 1 §13.3, XCR0 / XGETBV.
+ *   Gopal et al., "Fast CRC Computation for Generic Polynomials Using
+ *   PCLMULQDQ Instruction", Intel white paper 323102 (2009).
+ *   GCC manual, "x86 Function Attributes" (target).
+ */
+#define _POSIX_C_SOURCE 200112L   /* getenv, pthread_once */
+
+#include "../include/cpu_dispatch.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+#define KERNEL static inline __attribute__((always_inline))
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Kernel bodies
+ * ════════════════════════════════════════════════════════════════════ */
+
+KERNEL void k_fft_bfly(real_t *restrict er, real_t *restrict ei,
+                       real_t *restrict or_, real_t *restrict oi,
+                       const real_t *restrict wr, const real_t *restrict wi,
+                       int half)
+{
+    for (int k = 0; k < half; k++) {
+        real_t tr = wr[k] * or_[k] - wi[k] * oi[k];
+        real_t ti = wr[k] * oi[k] + wi[k] * or_[k];
+        or_[k] = er[k] - tr;
+        oi[k]  = ei[k] - ti;
+        er[k] += tr;
+        ei[k] += ti;
+    }
+}
+
+/* Radix-4 DIT butterfly on B independent lanes (one twiddle set for
+ * all of them), operation for operation the per-symbol pow2 pass. */
+KERNEL void k_r4_lanes(real_t *restrict f0r, real_t *restrict f0i,
+                       real_t *restrict f1r, real_t *restrict f1i,
+                       real_t *restrict f2r, real_t *restrict f2i,
+                       real_t *restrict f3r, real_t *restrict f3i,
+                       real_t c1, real_t s1, real_t c2, real_t s2,
+                       real_t c3, real_t s3, real_t sg, int B)
+{
+    for (int b = 0; b < B; b++) {
+        real_t ar = f0r[b], ai = f0i[b];
+        real_t br = c2 * f2r[b] - s2 * f2i[b];
+        real_t bi = c2 * f2i[b] + s2 * f2r[b];
+        real_t cr = c1 * f1r[b] - s1 * f1i[b];
+        real_t ci = c1 * f1i[b] + s1 * f1r[b];
+        real_t dr = c3 * f3r[b] - s3 * f3i[b];
+        real_t di = c3 * f3i[b] + s3 * f3r[b];
+
+        real_t t0r = ar + br, t0i = ai + bi;
+        real_t t1r = ar - br, t1i = ai - bi;
+        real_t t2r = cr + dr, t2i = ci + di;
+        real_t t3r = sg * (ci - di), t3i = -sg * (cr - dr);
+
+        f0r[b] = t0r + t2r;  f0i[b] = t0i + t2i;
+        f1r[b] = t0r - t2r;  f1i[b] = t0i - t2i;
+        f2r[b] = t1r + t3r;  f2i[b] = t1i + t3i;
+        f3r[b] = t1r - t3r;  f3i[b] = t1i - t3i;
+    }
+}
+
+KERNEL void k_fft_r4_pass(real_t *re, real_t *im, int n, int h,
+                          const real_t *const w[6], real_t sg, int B)
+{
+    size_t hb = (size_t)h * B;
+    for (int s = 0; s < n; s += 4 * h) {
+        for (int k = 0; k < h; k++) {
+            size_t o = (size_t)(s + k) * B;
+            k_r4_lanes(re + o, im + o, re + o + 2 * hb, im + o + 2 * hb,
+                       re + o + hb, im + o + hb,
+                       re + o + 3 * hb, im + o + 3 * hb,
+                       w[0][k], sg * w[1][k], w[2][k], sg * w[3][k],
+                       w[4][k], sg * w[5][k], sg, B);
+        }
+    }
+}
+
+/* Short lane counts are the common case; a literal B lets the lane loop
+ * become straight-line vector code with no remainder handling. */
+KERNEL void k_fft_r4_lanes(real_t *re, real_t *im, int n, int h,
+                           const real_t *const w[6], real_t sg, int B)
+{
+    switch (B) {
+        case 16: k_fft_r4_pass(re, im, n, h, w, sg, 16); break;
+        case 8:  k_fft_r4_pass(re, im, n, h, w, sg, 8);  break;
+        case 4:  k_fft_r4_pass(re, im, n, h, w, sg, 4);  break;
+        default: k_fft_r4_pass(re, im, n, h, w, sg, B);  break;
+    }
+}
+
+/* Butterfly i: predecessors i and i + 32 feed states 2i (even) and
+ * 2i + 1 (odd).  The branches i → 2i and i + 32 → 2i + 1 cost α, the
+ * crossing ones β, from the step's four costs by coded pair.  Every add
+ * saturates at 255, as PADDUSB does.  Metrics never fall, so the
+ * minimum ACS_RENORM_STEPS steps back is a floor to subtract without
+ * clipping; with |llr| ≤ 15 the best metric then stays below 2 ·
+ * ACS_RENORM_STEPS · 15 = 120, and only paths worse by more than 135
+ * reach the rail.  This portable body is the generic level; the others
+ * are written with intrinsics below. */
+#define ACS_RENORM_STEPS 4
+#define ACS_RENORM(t) \
+    (((t) & (ACS_RENORM_STEPS - 1)) == ACS_RENORM_STEPS - 1)
+
+/* The four branch costs of one step packed as bytes, coded pair c
+ * (first bit in bit 1) in byte c: a coded 0 is charged max(−llr, 0)
+ * and a coded 1 max(llr, 0). */
+static inline uint32_t acs_costs(int l0, int l1)
+{
+    uint32_t p0 = l0 > 0 ? (uint32_t)l0 : 0, n0 = l0 < 0 ? (uint32_t)-l0 : 0;
+    uint32_t p1 = l1 > 0 ? (uint32_t)l1 : 0, n1 = l1 < 0 ? (uint32_t)-l1 : 0;
+    return (n0 + n1) | (n0 + p1) << 8 | (p0 + n1) << 16 | (p0 + p1) << 24;
+}
+
+/* Saturating add in the form that vectorises as PADDUSB */
+static inline uint8_t addsu8(uint8_t a, uint8_t b)
+{
+    uint8_t s = (uint8_t)(a + b);
+    return (uint8_t)(s | -(s < a));
+}
+
+static inline uint8_t min64_u8(const uint8_t *pm)
+{
+    uint8_t m = pm[0];
+    for (int s = 1; s < 64; s++) m = pm[s] < m ? pm[s] : m;
+    return m;
+}
+
+KERNEL void k_viterbi_acs8(uint8_t *restrict pm,
+                           const int8_t *restrict llr, int n_steps,
+                           const uint8_t *restrict br,
+                           uint64_t *restrict dec)
+{
+    /* Each cost picks N or P per coded bit by mask, so the butterfly
+     * loop vectorises without a per-lane table lookup */
+    uint8_t ev[32], od[32], ce[32], co[32], m0[32], m1[32];
+    for (int i = 0; i < 32; i++) {
+        m0[i] = (uint8_t)(0u - (br[i] >> 1));
+        m1[i] = (uint8_t)(0u - (br[i] & 1));
+    }
+    uint8_t floor_pm = min64_u8(pm);
+    for (int t = 0; t < n_steps; t++) {
+        int l0 = llr[2 * t], l1 = llr[2 * t + 1];
+        uint8_t p0 = (uint8_t)(l0 > 0 ? l0 : 0);
+        uint8_t n0 = (uint8_t)(l0 < 0 ? -l0 : 0);
+        uint8_t p1 = (uint8_t)(l1 > 0 ? l1 : 0);
+        uint8_t n1 = (uint8_t)(l1 < 0 ? -l1 : 0);
+        uint8_t x0 = p0 ^ n0, x1 = p1 ^ n1;
+        for (int i = 0; i < 32; i++) {
+            uint8_t a = pm[i], b = pm[i + 32];
+            uint8_t s0 = m0[i] & x0, s1 = m1[i] & x1;
+            uint8_t al = (uint8_t)((n0 ^ s0) + (n1 ^ s1));
+            uint8_t be = (uint8_t)((p0 ^ s0) + (p1 ^ s1));
+            uint8_t e0 = addsu8(a, al), e1 = addsu8(b, be);
+            uint8_t o0 = addsu8(a, be), o1 = addsu8(b, al);
+            ce[i] = e1 < e0;
+            co[i] = o1 < o0;
+            ev[i] = e1 < e0 ? e1 : e0;
+            od[i] = o1 < o0 ? o1 : o0;
+        }
+        for (int i = 0; i < 32; i++) {
+            pm[2 * i] = ev[i];
+            pm[2 * i + 1] = od[i];
+        }
+        /* Decisions in state order, packed eight at a time: the
+         * multiply moves the low bit of byte j to bit 56 + j */
+        uint8_t cd[64];
+        for (int i = 0; i < 32; i++) {
+            cd[2 * i] = ce[i];
+            cd[2 * i + 1] = co[i];
+        }
+        uint64_t d = 0;
+        for (int k = 0; k < 8; k++) {
+            uint64_t x = 0;
+            for (int j = 0; j < 8; j++)
+                x |= (uint64_t)cd[8 * k + j] << (8 * j);
+            d |= (x * 0x0102040810204080ull >> 56) << (8 * k);
+        }
+        dec[t] = d;
+
+        if (ACS_RENORM(t)) {
+            for (int s = 0; s < 64; s++) pm[s] = (uint8_t)(pm[s] - floor_pm);
+            floor_pm = min64_u8(pm);
+        }
+    }
+}
+
+/* Clamped with the offset already added so the conversion truncates
+ * toward −∞; clamping and converting in separate passes lets each copy
+ * vectorise (as one loop, the compare blends spill). */
+#define QUANT_BLOCK 64
+
+KERNEL void k_llr_quant8(const real_t *restrict x, int n, real_t scale,
+                         int lim, int8_t *restrict q)
+{
+    const real_t off = (real_t)lim + (real_t)1.5;
+    const real_t hi = off + (real_t)lim, lo = off - (real_t)lim;
+    real_t t[QUANT_BLOCK];
+    for (int i0 = 0; i0 < n; i0 += QUANT_BLOCK) {
+        int m = n - i0 < QUANT_BLOCK ? n - i0 : QUANT_BLOCK;
+        for (int i = 0; i < m; i++) {
+            real_t v = x[i0 + i] * scale + off;
+            v = v < hi ? v : hi;
+            t[i] = v > lo ? v : lo;
+        }
+        for (int i = 0; i < m; i++)
+            q[i0 + i] = (int8_t)((int)t[i] - (lim + 1));
+    }
+}
+
+KERNEL void k_fir_axpy(real_t *restrict y, const real_t *restrict h,
+                       real_t a, int n)
+{
+    for (int i = 0; i < n; i++)
+        y[i] += a * h[i];
+}
+
+KERNEL void k_cplx_mac(real_t *restrict yr, real_t *restrict yi,
+                       const real_t *restrict ar, const real_t *restrict ai,
+                       const real_t *restrict br, const real_t *restrict bi,
+                       int n)
+{
+    for (int i = 0; i < n; i++) {
+        yr[i] += ar[i] * br[i] - ai[i] * bi[i];
+        yi[i] += ar[i] * bi[i] + ai[i] * br[i];
+    }
+}
+
+/* Sequential double accumulation keeps the result order-exact; only
+ * the products vectorise. */
+KERNEL Cplx k_cplx_dot(const real_t *restrict ar, const real_t *restrict ai,
+                       const real_t *restrict br, const real_t *restrict bi,
+                       int n)
+{
+    double sr = 0.0, si = 0.0;
+    for (int i = 0; i < n; i++) {
+        sr += ar[i] * br[i] - ai[i] * bi[i];
+        si += ar[i] * bi[i] + ai[i] * br[i];
+    }
+    return cplx(sr, si);
+}
+
+/* All M metrics first (vectorises across the constellation), then a
+ * masked max per bit.  Max is exact, so the LLRs match the scalar
+ * per-bit scan bit for bit. */
+KERNEL void k_llr_maxlog(const Cplx *restrict syms, int nsyms,
+                         const Cplx *restrict pts, int bps,
+                         double two_sigma2, real_t *restrict llr)
+{
+    int M = 1 << bps;
+    real_t pr[64], pi[64];
+    double metric[64];
+    for (int j = 0; j < M; j++) { pr[j] = pts[j].re; pi[j] = pts[j].im; }
+
+    for (int i = 0; i < nsyms; i++) {
+        real_t yr = syms[i].re, yi = syms[i].im;
+        for (int j = 0; j < M; j++) {
+            real_t dr = yr - pr[j], di = yi - pi[j];
+            double d2 = dr * dr + di * di;
+            metric[j] = -d2 / two_sigma2;
+        }
+        for (int b = 0; b < bps; b++) {
+            int sh = bps - 1 - b;
+            double max0 = -1e30, max1 = -1e30;
+            for (int j = 0; j < M; j++) {
+                double m = metric[j];
+                if ((j >> sh) & 1)
+                    max1 = (m > max1) ? m : max1;
+                else
+                    max0 = (m > max0) ? m : max0;
+            }
+            *llr++ = max0 - max1;
+        }
+    }
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Per-level instantiation
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define DEFINE_LEVEL(sfx, attr)                                              \
+attr static void fft_bfly_##sfx(real_t *er, real_t *ei, real_t *or_,         \
+                                real_t *oi, const real_t *wr,                \
+                                const real_t *wi, int half)                  \
+{ k_fft_bfly(er, ei, or_, oi, wr, wi, half); }                               \
+attr static void fft_r4_lanes_##sfx(real_t *re, real_t *im, int n, int h,    \
+                                    const real_t *const w[6], real_t sg,     \
+                                    int B)                                   \
+{ k_fft_r4_lanes(re, im, n, h, w, sg, B); }                                  \
+attr static void llr_quant8_##sfx(const real_t *x, int n, real_t scale,      \
+                                  int lim, int8_t *q)                        \
+{ k_llr_quant8(x, n, scale, lim, q); }                                       \
+attr static void fir_axpy_##sfx(real_t *y, const real_t *h, real_t a, int n) \
+{ k_fir_axpy(y, h, a, n); }                                                  \
+attr static void cplx_mac_##sfx(real_t *yr, real_t *yi, const real_t *ar,    \
+                                const real_t *ai, const real_t *br,          \
+                                const real_t *bi, int n)                     \
+{ k_cplx_mac(yr, yi, ar, ai, br, bi, n); }                                   \
+attr static Cplx cplx_dot_##sfx(const real_t *ar, const real_t *ai,          \
+                                const real_t *br, const real_t *bi, int n)   \
+{ return k_cplx_dot(ar, ai, br, bi, n); }                                    \
+attr static void llr_maxlog_##sfx(const Cplx *syms, int nsyms,               \
+                                  const Cplx *pts, int bps,                  \
+                                  double two_sigma2, real_t *llr)            \
+{ k_llr_maxlog(syms, nsyms, pts, bps, two_sigma2, llr); }
+
+#define LEVEL_TABLE(lvl, sfx, crc)                                           \
+    { lvl, fft_bfly_##sfx, fft_r4_lanes_##sfx, viterbi_acs8_##sfx,          \
+      llr_quant8_##sfx, fir_axpy_##sfx, cplx_mac_##sfx, cplx_dot_##sfx,     \
+      llr_maxlog_##sfx, crc }
+
+DEFINE_LEVEL(generic, )
+#ifdef SIMD_X86
+DEFINE_LEVEL(sse42,  __attribute__((target("sse4.2"))))
+DEFINE_LEVEL(avx2,   __attribute__((target("avx2"))))
+DEFINE_LEVEL(avx512, __attribute__((target("avx512f"))))
+#endif
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Viterbi add-compare-select (intrinsics)
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* The vector levels keep the 64 metrics in registers across steps and
+ * do exactly what k_viterbi_acs8() does.  Each block of up to ACS_BLOCK
+ * steps first packs its branch costs, one word per step; a step then
+ * broadcasts its word and a byte shuffle by coded pair hands every
+ * state its cost.  SSE4.2 and AVX2 work on butterflies (unsigned min,
+ * and an equality compare with the upper sum for the decision), then
+ * unpack even and odd states back into state order, which at AVX2 also
+ * takes a cross-lane permute.  AVX-512 permutes the predecessors into
+ * state order first, so its compare mask is the decision word.  The
+ * renormalising floor is a min tree finished by PHMINPOSUW. */
+#define ACS_BLOCK 64
+
+static void viterbi_acs8_generic(uint8_t *pm, const int8_t *llr,
+                                 int n_steps, const uint8_t *br,
+                                 uint64_t *dec)
+{
+    k_viterbi_acs8(pm, llr, n_steps, br, dec);
+}
+
+#ifdef SIMD_X86
+/* acs_costs() for n steps, eight per vector: with N = max(−llr, 0) and
+ * P = max(llr, 0), a word unpack lays out (n0, n1, p0, p1) per step and
+ * two byte shuffles pair them up in coded-pair order. */
+__attribute__((target("sse4.2")))
+static inline void acs_tables(const int8_t *llr, int n, uint32_t *tab)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i first = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6,
+                                        8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i second = _mm_setr_epi8(1, 3, 1, 3, 5, 7, 5, 7,
+                                         9, 11, 9, 11, 13, 15, 13, 15);
+    int t = 0;
+    for (; t + 8 <= n; t += 8) {
+        __m128i l = _mm_loadu_si128((const __m128i *)(llr + 2 * t));
+        __m128i p = _mm_max_epi8(l, zero);
+        __m128i q = _mm_max_epi8(_mm_sub_epi8(zero, l), zero);
+        __m128i lo = _mm_unpacklo_epi16(q, p), hi = _mm_unpackhi_epi16(q, p);
+        _mm_storeu_si128((__m128i *)(tab + t),
+                         _mm_add_epi8(_mm_shuffle_epi8(lo, first),
+                                      _mm_shuffle_epi8(lo, second)));
+        _mm_storeu_si128((__m128i *)(tab + t + 4),
+                         _mm_add_epi8(_mm_shuffle_epi8(hi, first),
+                                      _mm_shuffle_epi8(hi, second)));
+    }
+    for (; t < n; t++) tab[t] = acs_costs(llr[2 * t], llr[2 * t + 1]);
+}
+
+/* Smallest byte of v, in every byte */
+__attribute__((target("sse4.2")))
+static inline __m128i hmin_epu8(__m128i v)
+{
+    v = _mm_min_epu8(v, _mm_srli_epi16(v, 8));
+    v = _mm_minpos_epu16(_mm_and_si128(v, _mm_set1_epi16(0xFF)));
+    return _mm_shuffle_epi8(v, _mm_setzero_si128());
+}
+
+__attribute__((target("sse4.2")))
+static void viterbi_acs8_sse42(uint8_t *pm, const int8_t *llr,
+                               int n_steps, const uint8_t *br,
+                               uint64_t *dec)
+{
+    const __m128i three = _mm_set1_epi8(3);
+    __m128i m[4], ca[2], cb[2];
+    for (int k = 0; k < 4; k++)
+        m[k] = _mm_loadu_si128((const __m128i *)(pm + 16 * k));
+    for (int k = 0; k < 2; k++) {
+        ca[k] = _mm_loadu_si128((const __m128i *)(br + 16 * k));
+        cb[k] = _mm_sub_epi8(three, ca[k]);
+    }
+    __m128i fl = hmin_epu8(_mm_min_epu8(_mm_min_epu8(m[0], m[1]),
+                                        _mm_min_epu8(m[2], m[3])));
+    uint32_t tab[ACS_BLOCK];
+
+    for (int t0 = 0; t0 < n_steps; t0 += ACS_BLOCK) {
+        int nb = n_steps - t0 < ACS_BLOCK ? n_steps - t0 : ACS_BLOCK;
+        acs_tables(llr + 2 * t0, nb, tab);
+        for (int j = 0; j < nb; j++) {
+            int t = t0 + j;
+            __m128i T = _mm_set1_epi32((int)tab[j]);
+            __m128i nm[4];
+            uint64_t keep = 0;
+            for (int k = 0; k < 2; k++) {        /* butterflies 16k.. */
+                __m128i a = m[k], b = m[k + 2];
+                __m128i al = _mm_shuffle_epi8(T, ca[k]);
+                __m128i be = _mm_shuffle_epi8(T, cb[k]);
+                __m128i e0 = _mm_adds_epu8(a, al), e1 = _mm_adds_epu8(b, be);
+                __m128i o0 = _mm_adds_epu8(a, be), o1 = _mm_adds_epu8(b, al);
+                __m128i ev = _mm_min_epu8(e0, e1), od = _mm_min_epu8(o0, o1);
+                __m128i ue = _mm_cmpeq_epi8(ev, e0);
+                __m128i uo = _mm_cmpeq_epi8(od, o0);
+                nm[2 * k]     = _mm_unpacklo_epi8(ev, od);
+                nm[2 * k + 1] = _mm_unpackhi_epi8(ev, od);
+                keep |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                            _mm_unpacklo_epi8(ue, uo)) << (32 * k);
+                keep |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                            _mm_unpackhi_epi8(ue, uo)) << (32 * k + 16);
+            }
+            dec[t] = ~keep;
+
+            if (ACS_RENORM(t)) {
+                for (int k = 0; k < 4; k++) nm[k] = _mm_sub_epi8(nm[k], fl);
+                fl = hmin_epu8(_mm_min_epu8(_mm_min_epu8(nm[0], nm[1]),
+                                            _mm_min_epu8(nm[2], nm[3])));
+            }
+            for (int k = 0; k < 4; k++) m[k] = nm[k];
+        }
+    }
+    for (int k = 0; k < 4; k++)
+        _mm_storeu_si128((__m128i *)(pm + 16 * k), m[k]);
+}
+
+/* All 32 butterflies in one vector.  Unpack works within 128-bit
+ * halves, so the low halves hold states 0–15 and 32–47 and the high
+ * halves 16–31 and 48–63: a cross-lane permute restores state order in
+ * the metrics, and 16-bit pieces of the compare masks are moved to
+ * match. */
+__attribute__((target("avx2")))
+static inline __m256i hmin256_epu8(__m256i a, __m256i b)
+{
+    __m256i v = _mm256_min_epu8(a, b);
+    return _mm256_broadcastb_epi8(hmin_epu8(_mm_min_epu8(
+        _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1))));
+}
+
+__attribute__((target("avx2")))
+static void viterbi_acs8_avx2(uint8_t *pm, const int8_t *llr,
+                              int n_steps, const uint8_t *br,
+                              uint64_t *dec)
+{
+    const __m256i ca = _mm256_loadu_si256((const __m256i *)br);
+    const __m256i cb = _mm256_sub_epi8(_mm256_set1_epi8(3), ca);
+    __m256i a = _mm256_loadu_si256((const __m256i *)pm);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(pm + 32));
+    __m256i fl = hmin256_epu8(a, b);
+    uint32_t tab[ACS_BLOCK];
+
+    for (int t0 = 0; t0 < n_steps; t0 += ACS_BLOCK) {
+        int nb = n_steps - t0 < ACS_BLOCK ? n_steps - t0 : ACS_BLOCK;
+        acs_tables(llr + 2 * t0, nb, tab);
+        for (int j = 0; j < nb; j++) {
+            int t = t0 + j;
+            __m256i T = _mm256_set1_epi32((int)tab[j]);
+            __m256i al = _mm256_shuffle_epi8(T, ca);
+            __m256i be = _mm256_shuffle_epi8(T, cb);
+            __m256i e0 = _mm256_adds_epu8(a, al), e1 = _mm256_adds_epu8(b, be);
+            __m256i o0 = _mm256_adds_epu8(a, be), o1 = _mm256_adds_epu8(b, al);
+            __m256i ev = _mm256_min_epu8(e0, e1), od = _mm256_min_epu8(o0, o1);
+            __m256i ue = _mm256_cmpeq_epi8(ev, e0);
+            __m256i uo = _mm256_cmpeq_epi8(od, o0);
+            uint64_t kl = (uint32_t)_mm256_movemask_epi8(
+                              _mm256_unpacklo_epi8(ue, uo));
+            uint64_t kh = (uint32_t)_mm256_movemask_epi8(
+                              _mm256_unpackhi_epi8(ue, uo));
+            dec[t] = ~((kl & 0xFFFF) | (kh & 0xFFFF) << 16 |
+                       (kl >> 16) << 32 | (kh >> 16) << 48);
+
+            __m256i lo = _mm256_unpacklo_epi8(ev, od);
+            __m256i hi = _mm256_unpackhi_epi8(ev, od);
+            a = _mm256_permute2x128_si256(lo, hi, 0x20);
+            b = _mm256_permute2x128_si256(lo, hi, 0x31);
+            if (ACS_RENORM(t)) {
+                a = _mm256_sub_epi8(a, fl);
+                b = _mm256_sub_epi8(b, fl);
+                fl = hmin256_epu8(a, b);
+            }
+        }
+    }
+    _mm256_storeu_si256((__m256i *)pm, a);
+    _mm256_storeu_si256((__m256i *)(pm + 32), b);
+}
+
+/* State order throughout: one byte permute per predecessor set (VBMI)
+ * lines pm[s/2] and pm[s/2 + 32] up with state s, the shuffles hand
+ * each state its upper and lower branch cost, and the unsigned compare
+ * mask is dec[t] as it stands.  The shuffle indices come from br by
+ * the same permute, so a call sets up in a handful of instructions. */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void viterbi_acs8_avx512(uint8_t *pm, const int8_t *llr,
+                                int n_steps, const uint8_t *br,
+                                uint64_t *dec)
+{
+    const __m512i pu = _mm512_set_epi8(
+        31, 31, 30, 30, 29, 29, 28, 28, 27, 27, 26, 26, 25, 25, 24, 24, 23,
+        23, 22, 22, 21, 21, 20, 20, 19, 19, 18, 18, 17, 17, 16, 16, 15, 15,
+        14, 14, 13, 13, 12, 12, 11, 11, 10, 10, 9, 9, 8, 8, 7, 7, 6, 6, 5, 5,
+        4, 4, 3, 3, 2, 2, 1, 1, 0, 0);
+    const __m512i pl = _mm512_add_epi8(pu, _mm512_set1_epi8(32));
+    const __m512i c = _mm512_permutexvar_epi8(pu, _mm512_castsi256_si512(
+                          _mm256_loadu_si256((const __m256i *)br)));
+    const __m512i nc = _mm512_sub_epi8(_mm512_set1_epi8(3), c);
+    const __mmask64 odd = 0xAAAAAAAAAAAAAAAAull;
+    const __m512i su = _mm512_mask_blend_epi8(odd, c, nc);
+    const __m512i sl = _mm512_mask_blend_epi8(odd, nc, c);
+    __m512i m = _mm512_loadu_si512(pm);
+    __m512i fl = _mm512_broadcastb_epi8(_mm256_castsi256_si128(
+                     hmin256_epu8(_mm512_castsi512_si256(m),
+                                  _mm512_extracti64x4_epi64(m, 1))));
+    uint32_t tab[ACS_BLOCK];
+
+    for (int t0 = 0; t0 < n_steps; t0 += ACS_BLOCK) {
+        int nb = n_steps - t0 < ACS_BLOCK ? n_steps - t0 : ACS_BLOCK;
+        acs_tables(llr + 2 * t0, nb, tab);
+        for (int j = 0; j < nb; j++) {
+            int t = t0 + j;
+            __m512i T = _mm512_set1_epi32((int)tab[j]);
+            __m512i x = _mm512_adds_epu8(_mm512_permutexvar_epi8(pu, m),
+                                         _mm512_shuffle_epi8(T, su));
+            __m512i y = _mm512_adds_epu8(_mm512_permutexvar_epi8(pl, m),
+                                         _mm512_shuffle_epi8(T, sl));
+            dec[t] = _mm512_cmplt_epu8_mask(y, x);
+            m = _mm512_min_epu8(x, y);
+            if (ACS_RENORM(t)) {
+                m = _mm512_sub_epi8(m, fl);
+                fl = _mm512_broadcastb_epi8(_mm256_castsi256_si128(
+                         hmin256_epu8(_mm512_castsi512_si256(m),
+                                      _mm512_extracti64x4_epi64(m, 1))));
+            }
+        }
+    }
+    _mm512_storeu_si512(pm, m);
+}
+#endif
+
+/* ════════════════════════════════════════════════════════════════════
+ *  CRC-32 folding (PCLMULQDQ)
+ * ════════════════════════════════════════════════════════════════════ */
+
+static int crc32_fold_none(uint32_t *reg, const uint8_t *data, int n)
+{
+    (void)reg; (void)data; (void)n;
+    return 0;
+}
+
+#ifdef SIMD_X86
+/* Four 128-bit lanes fold 64 bytes per step by x^512 and x^576 mod P,
+ * then collapse to one lane (x^128, x^192), fold the remaining 16-byte
+ * blocks, reduce 128 → 64 bits and Barrett-reduce to 32.  Constants are
+ * the bit-reflected ones from the Intel paper for P = 0x04C11DB7. */
+__attribute__((target("pclmul,sse4.1")))
+static int crc32_fold_clmul(uint32_t *reg, const uint8_t *data, int n)
+{
+    if (n < 64) return 0;
+    int len = n & ~15;
+    const uint8_t *p = data;
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128((const __m128i *)(p + 0x00));
+    __m128i x2 = _mm_loadu_si128((const __m128i *)(p + 0x10));
+    __m128i x3 = _mm_loadu_si128((const __m128i *)(p + 0x20));
+    __m128i x4 = _mm_loadu_si128((const __m128i *)(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)*reg));
+    p += 64;
+    len -= 64;
+
+    for (; len >= 64; p += 64, len -= 64) {
+        __m128i l1 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        __m128i l2 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        __m128i l3 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        __m128i l4 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, l1),
+                           _mm_loadu_si128((const __m128i *)(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, l2),
+                           _mm_loadu_si128((const __m128i *)(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, l3),
+                           _mm_loadu_si128((const __m128i *)(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, l4),
+                           _mm_loadu_si128((const __m128i *)(p + 0x30)));
+    }
+
+    /* Four lanes → one, then any remaining 16-byte blocks */
+    __m128i next[3] = { x2, x3, x4 };
+    for (int j = 0; j < 3 + len / 16; j++) {
+        __m128i y = j < 3 ? next[j]
+                          : _mm_loadu_si128((const __m128i *)
+                                            (p + 16 * (j - 3)));
+        __m128i lo = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, lo), y);
+    }
+
+    /* 128 → 64 bits */
+    __m128i t = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+    t = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+
+    /* Barrett reduction to 32 bits */
+    t = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+    t = _mm_clmulepi64_si128(_mm_and_si128(t, mask), poly, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+
+    *reg = (uint32_t)_mm_extract_epi32(x1, 1);
+    return n & ~15;
+}
+#endif
+
+static const CommsKernels kernel_tables[SIMD_N_LEVELS] = {
+    LEVEL_TABLE(SIMD_GENERIC, generic, crc32_fold_none),
+#ifdef SIMD_X86
+    LEVEL_TABLE(SIMD_SSE42,   sse42,   crc32_fold_none),
+    LEVEL_TABLE(SIMD_AVX2,    avx2,    crc32_fold_clmul),
+    LEVEL_TABLE(SIMD_AVX512,  avx512,  crc32_fold_clmul),
+#endif
+};
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Detection
+ * ════════════════════════════════════════════════════════════════════ */
+
+#ifdef SIMD_X86
+static uint64_t read_xcr0(void)
+{
+    uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+}
+#endif
+
+SimdLevel cpu_detect_simd(void)
+{
+#ifdef SIMD_X86
+    unsigned int a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return SIMD_GENERIC;
+    if (!(c & (1u << 20))) return SIMD_GENERIC;             /* SSE4.2 */
+
+    /* AVX state must be enabled by the OS (OSXSAVE + XCR0 YMM bits) */
+    if (!(c & (1u << 27)) || !(c & (1u << 28))) return SIMD_SSE42;
+    uint64_t xcr0 = read_xcr0();
+    if ((xcr0 & 0x6) != 0x6) return SIMD_SSE42;
+
+    if (!(c & (1u << 1))) return SIMD_SSE42;                /* PCLMULQDQ */
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return SIMD_SSE42;
+    if (!(b & (1u << 5))) return SIMD_SSE42;                /* AVX2 */
+    if (!(b & (1u << 16)) || !(b & (1u << 30)) ||          /* AVX-512F/BW */
+        !(c & (1u << 1)) || (xcr0 & 0xE0) != 0xE0)          /* VBMI */
+        return SIMD_AVX2;
+    return SIMD_AVX512;
+#else
+    return SIMD_GENERIC;
+#endif
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Selection
+ * ════════════════════════════════════════════════════════════════════ */
+
+static const char *const level_names[SIMD_N_LEVELS] = {
+    "generic", "sse4.2", "avx2", "avx512"
+};
+
+/* Published with release/acquire so readers on other threads see a
+ * complete table pointer; the default is chosen once, on first use from
+ * whichever thread gets there first, and explicit selections always
+ * run after it so it can never overwrite them. */
+static const CommsKernels *active;
+static pthread_once_t active_once = PTHREAD_ONCE_INIT;
+
+static SimdLevel select_level(SimdLevel level)
+{
+    SimdLevel max = cpu_detect_simd();
+    if ((unsigned)level > (unsigned)max) level = max;
+    __atomic_store_n(&active, &kernel_tables[level], __ATOMIC_RELEASE);
+    return level;
+}
+
+static SimdLevel env_level(void)
+{
+    SimdLevel level = SIMD_N_LEVELS - 1;
+    const char *env = getenv("COMMS_SIMD");
+    if (env) {
+        for (int l = 0; l < SIMD_N_LEVELS; l++)
+            if (strcmp(env, level_names[l]) == 0) level = (SimdLevel)l;
+    }
+    return level;
+}
+
+static void active_build(void)
+{
+    select_level(env_level());
+}
+
+SimdLevel simd_set_level(SimdLevel level)
+{
+    pthread_once(&active_once, active_build);
+    return select_level(level);
+}
+
+SimdLevel simd_init(void)
+{
+    return simd_set_level(env_level());
+}
+
+SimdLevel simd_level(void)
+{
+    return comms_kernels()->level;
+}
+
+const char *simd_level_name(SimdLevel level)
+{
+    if ((unsigned)level >= SIMD_N_LEVELS) return "unknown";
+    return level_names[level];
+}
+
+const CommsKernels *comms_kernels(void)
+{
+    const CommsKernels *k = __atomic_load_n(&active, __ATOMIC_ACQUIRE);
+    if (k) return k;
+    pthread_once(&active_once, active_build);
+    return __atomic_load_n(&active, __ATOMIC_ACQUIRE);
+}
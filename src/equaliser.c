@@ -11,6 +11,7 @@
  */
 
 #include "../include/equaliser.h"
+#include "../include/profile.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,11 +22,13 @@
 
 void eq_zf_freq(const Cplx *rx, const Cplx *h, int n, Cplx *out)
 {
+    PROF_BEGIN(eq_zf_freq);
     for (int i = 0; i < n; i++) {
         double hmag2 = cplx_mag2(h[i]);
         if (hmag2 < 1e-12) hmag2 = 1e-12;
         out[i] = cplx_scale(cplx_mul(rx[i], cplx_conj(h[i])), 1.0 / hmag2);
     }
+    PROF_END(eq_zf_freq, n);
 }
 
 void eq_zf_flat(const Cplx *rx, Cplx h, int n, Cplx *out)
@@ -44,12 +47,14 @@ void eq_zf_flat(const Cplx *rx, Cplx h, int n, Cplx *out)
 void eq_mmse_freq(const Cplx *rx, const Cplx *h, int n,
                   double snr_linear, Cplx *out)
 {
+    PROF_BEGIN(eq_mmse_freq);
     for (int i = 0; i < n; i++) {
         double hmag2 = cplx_mag2(h[i]);
         double denom = hmag2 + 1.0 / snr_linear;
         if (denom < 1e-12) denom = 1e-12;
         out[i] = cplx_scale(cplx_mul(rx[i], cplx_conj(h[i])), 1.0 / denom);
     }
+    PROF_END(eq_mmse_freq, n);
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -89,6 +94,7 @@ static Cplx lms_filter_output(const LmsEqualiser *eq)
 
 Cplx eq_lms_step(LmsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
 {
+    PROF_BEGIN(eq_lms_step);
     /* Insert new sample */
     eq->buf[eq->idx] = input;
 
@@ -99,19 +105,21 @@ Cplx eq_lms_step(LmsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
     Cplx e = cplx_sub(desired, y);
     if (error) *error = e;
 
-    /* Update weights: w = w + mu * e * conj(x) */
+    /* Update weights: w = w + mu * conj(e) * x  (matches y = w^H · x) */
     for (int k = 0; k < eq->n_taps; k++) {
         int idx = (eq->idx - k + eq->n_taps) % eq->n_taps;
-        Cplx update = cplx_scale(cplx_mul(e, cplx_conj(eq->buf[idx])), eq->mu);
+        Cplx update = cplx_scale(cplx_mul(cplx_conj(e), eq->buf[idx]), eq->mu);
         eq->w[k] = cplx_add(eq->w[k], update);
     }
 
     eq->idx = (eq->idx + 1) % eq->n_taps;
+    PROF_END(eq_lms_step, 1);
     return y;
 }
 
 Cplx eq_lms_dd_step(LmsEqualiser *eq, Cplx input, Cplx *error)
 {
+    PROF_BEGIN(eq_lms_dd_step);
     eq->buf[eq->idx] = input;
     Cplx y = lms_filter_output(eq);
 
@@ -122,11 +130,12 @@ Cplx eq_lms_dd_step(LmsEqualiser *eq, Cplx input, Cplx *error)
 
     for (int k = 0; k < eq->n_taps; k++) {
         int idx = (eq->idx - k + eq->n_taps) % eq->n_taps;
-        Cplx update = cplx_scale(cplx_mul(e, cplx_conj(eq->buf[idx])), eq->mu);
+        Cplx update = cplx_scale(cplx_mul(cplx_conj(e), eq->buf[idx]), eq->mu);
         eq->w[k] = cplx_add(eq->w[k], update);
     }
 
     eq->idx = (eq->idx + 1) % eq->n_taps;
+    PROF_END(eq_lms_dd_step, 1);
     return y;
 }
 
@@ -143,7 +152,8 @@ int eq_rls_init(RlsEqualiser *eq, int n_taps, double lambda, double delta)
     eq->w   = (Cplx *)calloc(n_taps, sizeof(Cplx));
     eq->buf = (Cplx *)calloc(n_taps, sizeof(Cplx));
     eq->P   = (double *)calloc(n_taps * n_taps, sizeof(double));
-    if (!eq->w || !eq->buf || !eq->P) return -1;
+    eq->Px  = (double *)calloc(n_taps, sizeof(double));
+    if (!eq->w || !eq->buf || !eq->P || !eq->Px) return -1;
 
     /* Initialise P = delta * I */
     for (int i = 0; i < n_taps; i++)
@@ -158,11 +168,13 @@ void eq_rls_free(RlsEqualiser *eq)
     free(eq->w);   eq->w = NULL;
     free(eq->buf); eq->buf = NULL;
     free(eq->P);   eq->P = NULL;
+    free(eq->Px);  eq->Px = NULL;
 }
 
 Cplx eq_rls_step(RlsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
 {
     int N = eq->n_taps; if (N <= 0) { if (error) *error = cplx(0,0); eq->idx = (eq->idx + 1) % 1; return cplx(0,0); }
+    PROF_BEGIN(eq_rls_step);
     eq->buf[eq->idx] = input;
 
     /* Output: y = w^H · x */
@@ -177,7 +189,7 @@ Cplx eq_rls_step(RlsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
 
     /* Simplified RLS update using scalar gain (for real-valued P) */
     /* k = P·x / (lambda + x^H·P·x) */
-    double *Px = (double *)calloc((size_t)N, sizeof(double));
+    double *Px = eq->Px;
     double xPx = 0;
     for (int i = 0; i < N; i++) {
         Px[i] = 0;
@@ -195,7 +207,7 @@ Cplx eq_rls_step(RlsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
     /* Update weights */
     for (int i = 0; i < N; i++) {
         double gain = Px[i] / denom;
-        eq->w[i] = cplx_add(eq->w[i], cplx_scale(e, gain));
+        eq->w[i] = cplx_add(eq->w[i], cplx_scale(cplx_conj(e), gain));
     }
 
     /* Update P = (1/lambda) * (P - k·x^H·P) — simplified */
@@ -207,8 +219,8 @@ Cplx eq_rls_step(RlsEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
         }
     }
 
-    free(Px);
     eq->idx = (eq->idx + 1) % N;
+    PROF_END(eq_rls_step, 1);
     return y;
 }
 
@@ -231,6 +243,7 @@ void eq_dfe_free(DfeEqualiser *eq)
 
 Cplx eq_dfe_step(DfeEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
 {
+    PROF_BEGIN(eq_dfe_step);
     /* Feedforward output */
     eq->ff.buf[eq->ff.idx] = input;
     Cplx y_ff = cplx(0, 0);
@@ -255,7 +268,7 @@ Cplx eq_dfe_step(DfeEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
     /* Update feedforward weights */
     for (int k = 0; k < eq->ff.n_taps; k++) {
         int idx = (eq->ff.idx - k + eq->ff.n_taps) % eq->ff.n_taps;
-        Cplx upd = cplx_scale(cplx_mul(e, cplx_conj(eq->ff.buf[idx])),
+        Cplx upd = cplx_scale(cplx_mul(cplx_conj(e), eq->ff.buf[idx]),
                                eq->ff.mu);
         eq->ff.w[k] = cplx_add(eq->ff.w[k], upd);
     }
@@ -267,12 +280,13 @@ Cplx eq_dfe_step(DfeEqualiser *eq, Cplx input, Cplx desired, Cplx *error)
     /* Update feedback weights */
     for (int k = 0; k < eq->fb.n_taps; k++) {
         int idx = (eq->fb.idx - k + eq->fb.n_taps) % eq->fb.n_taps;
-        Cplx upd = cplx_scale(cplx_mul(e, cplx_conj(eq->fb.buf[idx])),
+        Cplx upd = cplx_scale(cplx_mul(cplx_conj(e), eq->fb.buf[idx]),
                                eq->fb.mu);
         eq->fb.w[k] = cplx_add(eq->fb.w[k], upd);
     }
 
     eq->ff.idx = (eq->ff.idx + 1) % eq->ff.n_taps;
     eq->fb.idx = (eq->fb.idx + 1) % eq->fb.n_taps;
+    PROF_END(eq_dfe_step, 1);
     return y;
 }
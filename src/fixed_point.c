@@ -0,0 +1,387 @@
+/**
+ * @file fixed_point.c
+ * @brief Q15/Q31 fixed-point datapath — mapping, pulse shaping, BFP FFT,
+ *        NCO-based Costas loop and soft Viterbi on int16 data.
+ *
+ * TUTORIAL CROSS-REFERENCES:
+ *   Pulse shaping      → chapters/04-pulse-shaping/tutorial.md
+ *   Carrier sync       → chapters/09-carrier-sync/tutorial.md
+ *   Viterbi decoding   → chapters/11-convolutional-viterbi/tutorial.md
+ *   OFDM / FFT         → chapters/14-ofdm/tutorial.md
+ *
+ * References:
+ *   Oppenheim & Schafer, Discrete-Time Signal Processing (3rd ed.),
+ *     §9.5 — block floating point in FFTs.
+ *   Lyons, Understanding Digital Signal Processing (3rd ed.), Ch. 12–13.
+ */
+
+#define _POSIX_C_SOURCE 200112L   /* pthread_once */
+
+#include "../include/fixed_point.h"
+#include "../include/profile.h"
+#include "../include/coding.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Shared tables (FFT twiddles, NCO sin/cos)
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define NCO_LUT_BITS 10
+#define NCO_LUT_SIZE (1 << NCO_LUT_BITS)
+
+static CplxQ15 fxp_twiddle[FXP_FFT_MAX_N / 2];   /* e^{-j2πk/N_MAX} */
+static q15_t   fxp_cos_lut[NCO_LUT_SIZE];
+static pthread_once_t fxp_tables_once = PTHREAD_ONCE_INIT;
+
+static q15_t q15_from_double(double x)
+{
+    double r = floor(x * 32768.0 + 0.5);
+    if (r > Q15_MAX) r = Q15_MAX;
+    if (r < Q15_MIN) r = Q15_MIN;
+    return (q15_t)r;
+}
+
+static void fxp_tables_build(void)
+{
+    for (int k = 0; k < FXP_FFT_MAX_N / 2; k++) {
+        double a = -2.0 * M_PI * k / FXP_FFT_MAX_N;
+        fxp_twiddle[k].re = q15_from_double(cos(a));
+        fxp_twiddle[k].im = q15_from_double(sin(a));
+    }
+    for (int k = 0; k < NCO_LUT_SIZE; k++)
+        fxp_cos_lut[k] = q15_from_double(cos(2.0 * M_PI * k / NCO_LUT_SIZE));
+}
+
+/* Built once, on first use from whichever thread gets there first */
+static void fxp_tables_init(void)
+{
+    pthread_once(&fxp_tables_once, fxp_tables_build);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Complex arithmetic and conversion
+ * ════════════════════════════════════════════════════════════════════ */
+
+CplxQ15 cplxq15_mul(CplxQ15 a, CplxQ15 b)
+{
+    int32_t re = (int32_t)a.re * b.re - (int32_t)a.im * b.im;
+    int32_t im = (int32_t)a.re * b.im + (int32_t)a.im * b.re;
+    CplxQ15 z;
+    /* Sum of two Q30 products can reach 2^31: round in 64 bits */
+    z.re = q15_sat((int32_t)(((int64_t)re + (1 << 14)) >> 15));
+    z.im = q15_sat((int32_t)(((int64_t)im + (1 << 14)) >> 15));
+    return z;
+}
+
+static q15_t quantise_one(double x, double scale, int *n_sat)
+{
+    double r = floor(x * scale + 0.5);
+    if (r > Q15_MAX) { (*n_sat)++; return Q15_MAX; }
+    if (r < Q15_MIN) { (*n_sat)++; return Q15_MIN; }
+    return (q15_t)r;
+}
+
+int fxp_quantise(const real_t *in, int n, double scale, q15_t *out)
+{
+    int n_sat = 0;
+    for (int i = 0; i < n; i++)
+        out[i] = quantise_one(in[i], scale, &n_sat);
+    return n_sat;
+}
+
+int cplxq15_from_cplx(const Cplx *in, int n, double scale, CplxQ15 *out)
+{
+    int n_sat = 0;
+    for (int i = 0; i < n; i++) {
+        out[i].re = quantise_one(in[i].re, scale, &n_sat);
+        out[i].im = quantise_one(in[i].im, scale, &n_sat);
+    }
+    return n_sat;
+}
+
+void cplxq15_to_cplx(const CplxQ15 *in, int n, double scale, Cplx *out)
+{
+    double inv = 1.0 / scale;
+    for (int i = 0; i < n; i++)
+        out[i] = cplx(in[i].re * inv, in[i].im * inv);
+}
+
+double fxp_sqnr_db(const Cplx *ref, const CplxQ15 *q, int n, double scale)
+{
+    double sig = 0, err = 0, inv = 1.0 / scale;
+    for (int i = 0; i < n; i++) {
+        double dr = ref[i].re - q[i].re * inv;
+        double di = ref[i].im - q[i].im * inv;
+        sig += cplx_mag2(ref[i]);
+        err += dr * dr + di * di;
+    }
+    if (err < 1e-300) return 100.0;
+    return 10.0 * log10(sig / err);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  TX: symbol mapping and pulse shaping
+ * ════════════════════════════════════════════════════════════════════ */
+
+int mod_modulate_q15(ModScheme scheme, const uint8_t *bits, int nbits,
+                     CplxQ15 *syms)
+{
+    int bps = mod_bits_per_symbol(scheme);
+    Cplx pts[64];
+    CplxQ15 qpts[64];
+    int M = mod_constellation(scheme, pts);
+    if (bps <= 0 || M <= 0) return 0;
+    cplxq15_from_cplx(pts, M, FXP_SYM_ONE, qpts);
+
+    int nsyms = nbits / bps;
+    for (int i = 0; i < nsyms; i++) {
+        int idx = 0;
+        for (int b = 0; b < bps; b++)
+            idx = (idx << 1) | (bits[i * bps + b] & 1);
+        if (idx >= M) idx = M - 1;
+        syms[i] = qpts[idx];
+    }
+    return nsyms;
+}
+
+int pulse_shape_q15(const q15_t *syms, int nsyms, const q15_t *h, int hlen,
+                    int sps, q15_t *out)
+{
+    int out_len = nsyms * sps + hlen - 1;
+
+    for (int k = 0; k < out_len; k++) {
+        /* Symbols j with 0 ≤ k - j·sps < hlen */
+        int j_lo = (k - hlen + 1 + sps - 1) / sps;
+        if (k - hlen + 1 <= 0) j_lo = 0;
+        int j_hi = k / sps;
+        if (j_hi > nsyms - 1) j_hi = nsyms - 1;
+
+        int64_t acc = 0;
+        for (int j = j_lo; j <= j_hi; j++)
+            acc += (int32_t)syms[j] * h[k - j * sps];
+        out[k] = q15_sat((int32_t)q31_sat((acc + (1 << 14)) >> 15));
+    }
+    return out_len;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  FFT — radix-2 DIT with block floating point
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* A butterfly output component is at most (1 + √2)·max|input|; keep it
+ * below 2^15. */
+#define FFT_BFP_LIMIT 13573
+
+static int fft_q15_core(CplxQ15 *x, int n)
+{
+    fxp_tables_init();
+
+    int exponent = 0;
+    for (int i = 0, j = 0; i < n; i++) {
+        if (j > i) {
+            CplxQ15 t = x[i]; x[i] = x[j]; x[j] = t;
+        }
+        int bit = n >> 1;
+        while (bit && (j & bit)) { j ^= bit; bit >>= 1; }
+        j |= bit;
+    }
+
+    for (int size = 2; size <= n; size *= 2) {
+        /* Block scaling decision for this stage */
+        int peak = 0;
+        for (int i = 0; i < n; i++) {
+            int a = abs(x[i].re), b = abs(x[i].im);
+            if (a > peak) peak = a;
+            if (b > peak) peak = b;
+        }
+        if (peak > FFT_BFP_LIMIT) {
+            for (int i = 0; i < n; i++) {
+                x[i].re = (q15_t)((x[i].re + 1) >> 1);
+                x[i].im = (q15_t)((x[i].im + 1) >> 1);
+            }
+            exponent++;
+        }
+
+        int half = size / 2;
+        int tw_stride = FXP_FFT_MAX_N / size;
+        for (int start = 0; start < n; start += size) {
+            for (int k = 0; k < half; k++) {
+                CplxQ15 a = x[start + k];
+                CplxQ15 t = cplxq15_mul(fxp_twiddle[k * tw_stride],
+                                        x[start + k + half]);
+                x[start + k].re        = q15_add(a.re, t.re);
+                x[start + k].im        = q15_add(a.im, t.im);
+                x[start + k + half].re = q15_sub(a.re, t.re);
+                x[start + k + half].im = q15_sub(a.im, t.im);
+            }
+        }
+    }
+    return exponent;
+}
+
+int fft_q15(CplxQ15 *x, int n)
+{
+    if (n < 2 || n > FXP_FFT_MAX_N || (n & (n - 1))) return 0;
+    return fft_q15_core(x, n);
+}
+
+int ifft_q15(CplxQ15 *x, int n)
+{
+    if (n < 2 || n > FXP_FFT_MAX_N || (n & (n - 1))) return 0;
+
+    /* Conjugate, forward FFT, conjugate; 1/N folds into the exponent */
+    for (int i = 0; i < n; i++) x[i].im = q15_sat(-(int32_t)x[i].im);
+    int exponent = fft_q15_core(x, n);
+    for (int i = 0; i < n; i++) x[i].im = q15_sat(-(int32_t)x[i].im);
+
+    int log2n = 0;
+    while ((1 << log2n) < n) log2n++;
+    return exponent - log2n;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Carrier recovery — QPSK Costas loop with NCO
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* Phase units per radian, divided by Q15 full scale, in Q16:
+ * 2^32/(2π) / 2^15 · 2^16 = 2^33/(2π). */
+#define COSTAS_GAIN_SCALE (8589934592.0 / (2.0 * M_PI))
+#define COSTAS_FREQ_MAX   (INT64_C(1) << 30)       /* π/2 rad/sample */
+
+static int32_t costas_gain_q(double g)
+{
+    double q = floor(g * COSTAS_GAIN_SCALE + 0.5);
+    if (q > Q31_MAX) q = Q31_MAX;
+    if (q < Q31_MIN) q = Q31_MIN;
+    return (int32_t)q;
+}
+
+void carrier_init_q15(CarrierSyncQ15 *cs, double loop_bw, double damping)
+{
+    CarrierSync ref;
+    carrier_init(&ref, loop_bw, damping);
+    cs->phase = 0;
+    cs->freq = 0;
+    cs->alpha_q = costas_gain_q(ref.alpha);
+    cs->beta_q  = costas_gain_q(ref.beta);
+}
+
+double carrier_costas_qpsk_q15(CarrierSyncQ15 *cs, const CplxQ15 *in, int n,
+                               CplxQ15 *out)
+{
+    fxp_tables_init();
+
+    for (int i = 0; i < n; i++) {
+        /* NCO lookup: cos(φ), sin(φ) = cos(φ - π/2) */
+        int idx = (int)(cs->phase >> (32 - NCO_LUT_BITS));
+        int32_t c = fxp_cos_lut[idx];
+        int32_t s = fxp_cos_lut[(idx - NCO_LUT_SIZE / 4) & (NCO_LUT_SIZE - 1)];
+
+        /* derot = in · e^{-jφ} */
+        int64_t re = (int64_t)in[i].re * c + (int64_t)in[i].im * s;
+        int64_t im = (int64_t)in[i].im * c - (int64_t)in[i].re * s;
+        CplxQ15 d;
+        d.re = q15_sat(q31_sat((re + (1 << 14)) >> 15));
+        d.im = q15_sat(q31_sat((im + (1 << 14)) >> 15));
+        out[i] = d;
+
+        /* Same detector as carrier_costas_qpsk() */
+        int32_t error = (d.im > 0 ? d.re : -d.re) - (d.re > 0 ? d.im : -d.im);
+
+        /* Integrator held to ±π/2 rad/sample so a noisy or unlocked
+         * loop cannot overflow it; the phase step wraps modulo 2π */
+        int64_t f = cs->freq + (((int64_t)cs->beta_q * error) >> 16);
+        if (f >  COSTAS_FREQ_MAX) f =  COSTAS_FREQ_MAX;
+        if (f < -COSTAS_FREQ_MAX) f = -COSTAS_FREQ_MAX;
+        cs->freq = (int32_t)f;
+        int64_t step = f + (((int64_t)cs->alpha_q * error) >> 16);
+        cs->phase += (uint32_t)step;
+    }
+    return cs->freq * (2.0 * M_PI / 4294967296.0);
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Soft-decision Viterbi (int32 path metrics)
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define VITERBI_Q15_INF  (INT32_MAX / 2)
+#define VITERBI_Q15_RING (2 * VITERBI_DEPTH)
+
+/* Trace back from the best state over the steps [done, t) held in the
+ * survivor ring and release the oldest cnt of them, as the int16
+ * streaming decoder does: bit ns of a step's word is set when state ns
+ * took its lower predecessor, and bit 0 of a state is its newest input. */
+static int viterbi_q15_release(const int32_t *pm, const uint64_t *surv,
+                               long t, long done, int cnt, uint8_t *out)
+{
+    int state = 0;
+    for (int s = 1; s < CONV_STATES; s++)
+        if (pm[s] < pm[state]) state = s;
+
+    for (t--; t >= done; t--) {
+        if (t < done + cnt) out[t - done] = state & 1;
+        uint64_t w = surv[t % VITERBI_Q15_RING];
+        state = (state >> 1) | (int)((w >> state) & 1) << (CONV_K - 2);
+    }
+    return cnt;
+}
+
+int viterbi_decode_soft_q15(const q15_t *llr, int n_coded, uint8_t *decoded)
+{
+    int n_data = n_coded / 2;
+    if (n_data < 1) return 0;
+    PROF_BEGIN(viterbi_decode_soft_q15);
+
+    const uint8_t *br = conv_branch_table();
+    int32_t pm[CONV_STATES], pm_new[CONV_STATES];
+    uint64_t surv[VITERBI_Q15_RING];
+    long done = 0;
+    int m = 0;
+
+    for (int s = 0; s < CONV_STATES; s++) pm[s] = VITERBI_Q15_INF;
+    pm[0] = 0;
+
+    for (long t = 0; t < n_data; t++) {
+        int32_t l0 = llr[2 * t];
+        int32_t l1 = llr[2 * t + 1];
+
+        /* State ns is entered from (ns >> 1) with encoder register ns,
+         * or from (ns >> 1) | 32 with register ns | 64 */
+        uint64_t w = 0;
+        int32_t min = VITERBI_Q15_INF;
+        for (int ns = 0; ns < CONV_STATES; ns++) {
+            int p0 = ns >> 1, p1 = p0 | (CONV_STATES / 2);
+            int r0 = br[ns], r1 = br[ns | CONV_STATES];
+            int32_t m0 = pm[p0] - (((r0 & 2) ? -l0 : l0) +
+                                   ((r0 & 1) ? -l1 : l1));
+            int32_t m1 = pm[p1] - (((r1 & 2) ? -l0 : l0) +
+                                   ((r1 & 1) ? -l1 : l1));
+            if (m1 < m0) {
+                m0 = m1;
+                w |= UINT64_C(1) << ns;
+            }
+            pm_new[ns] = m0;
+            if (m0 < min) min = m0;
+        }
+        surv[t % VITERBI_Q15_RING] = w;
+
+        /* Renormalise so metrics stay bounded for any frame length */
+        for (int s = 0; s < CONV_STATES; s++)
+            pm[s] = (pm_new[s] >= VITERBI_Q15_INF) ? VITERBI_Q15_INF
+                                                   : pm_new[s] - min;
+
+        /* Ring full: release the oldest VITERBI_DEPTH decisions */
+        if (t + 1 - done == VITERBI_Q15_RING) {
+            m += viterbi_q15_release(pm, surv, t + 1, done, VITERBI_DEPTH,
+                                     decoded + m);
+            done += VITERBI_DEPTH;
+        }
+    }
+    m += viterbi_q15_release(pm, surv, n_data, done, (int)(n_data - done),
+                             decoded + m);
+    PROF_END(viterbi_decode_soft_q15, n_coded);
+    return m;
+}
@@ -14,6 +14,9 @@
  */
 
 #include "../include/modulation.h"
+#include "../include/dsp.h"
+#include "../include/cpu_dispatch.h"
+#include "../include/profile.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -133,12 +136,33 @@ int mod_modulate(ModScheme scheme, const uint8_t *bits, int nbits, Cplx *syms)
     return nsyms;
 }
 
+int mod_modulate_packed(ModScheme scheme, const BitVec *bits, Cplx *syms)
+{
+    int bps = mod_bits_per_symbol(scheme);
+    int M = 1 << bps;
+    Cplx constellation[64];
+    mod_constellation(scheme, constellation);
+
+    /* Extract bps-bit fields directly; a field may straddle two words */
+    int nsyms = bits->n / bps;
+    for (int i = 0; i < nsyms; i++) {
+        int pos = i * bps, k = pos >> 6, off = pos & 63;
+        uint64_t w = bits->w[k] << off;
+        if (off + bps > 64) w |= bits->w[k + 1] >> (64 - off);
+        int idx = (int)(w >> (64 - bps));
+        if (idx >= M) idx = M - 1;
+        syms[i] = constellation[idx];
+    }
+    return nsyms;
+}
+
 /* ════════════════════════════════════════════════════════════════════
  *  Demodulate: complex symbols → bits (hard decision)
  * ════════════════════════════════════════════════════════════════════ */
 
 int mod_demodulate(ModScheme scheme, const Cplx *syms, int nsyms, uint8_t *bits)
 {
+    PROF_BEGIN(mod_demodulate);
     int bps = mod_bits_per_symbol(scheme);
     int M = 1 << bps;
     Cplx constellation[64];
@@ -161,6 +185,7 @@ int mod_demodulate(ModScheme scheme, const Cplx *syms, int nsyms, uint8_t *bits)
             bits[nbits++] = (min_idx >> b) & 1;
         }
     }
+    PROF_END(mod_demodulate, nsyms);
     return nbits;
 }
 
@@ -169,32 +194,22 @@ int mod_demodulate(ModScheme scheme, const Cplx *syms, int nsyms, uint8_t *bits)
  * ════════════════════════════════════════════════════════════════════ */
 
 int mod_demodulate_soft(ModScheme scheme, const Cplx *syms, int nsyms,
-                        double sigma, double *llr)
+                        double sigma, real_t *llr)
 {
+    PROF_BEGIN(mod_demodulate_soft);
     int bps = mod_bits_per_symbol(scheme);
-    int M = 1 << bps;
     Cplx constellation[64];
     mod_constellation(scheme, constellation);
 
     double sigma2 = sigma * sigma;
     if (sigma2 < 1e-30) sigma2 = 1e-30;
 
-    int nllr = 0;
-    for (int i = 0; i < nsyms; i++) {
-        for (int b = 0; b < bps; b++) {
-            double max0 = -1e30, max1 = -1e30;
-            for (int j = 0; j < M; j++) {
-                double d2 = cplx_mag2(cplx_sub(syms[i], constellation[j]));
-                double metric = -d2 / (2.0 * sigma2);
-                if ((j >> (bps - 1 - b)) & 1)
-                    max1 = (metric > max1) ? metric : max1;
-                else
-                    max0 = (metric > max0) ? metric : max0;
-            }
-            llr[nllr++] = max0 - max1; /* positive → bit 0 more likely */
-        }
-    }
-    return nllr;
+    /* Max-log: llr = max_{bit=0} −d²/2σ² − max_{bit=1} −d²/2σ²
+     * (positive → bit 0 more likely) */
+    comms_kernels()->llr_maxlog(syms, nsyms, constellation, bps,
+                                2.0 * sigma2, llr);
+    PROF_END(mod_demodulate_soft, nsyms);
+    return nsyms * bps;
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -243,40 +258,61 @@ int gfsk_modulate(const uint8_t *bits, int nbits, int sps,
 {
     int nsamples = nbits * sps;
 
-    /* Generate NRZ impulses */
-    double *nrz = (double *)calloc(nsamples, sizeof(double));
-    for (int i = 0; i < nbits; i++) {
-        double val = bits[i] ? 1.0 : -1.0;
-        for (int j = 0; j < sps; j++)
-            nrz[i * sps + j] = val;
-    }
-
-    /* Gaussian filter */
-    double gf[128];
+    /* Gaussian filter (3-symbol span; heap only for very high sps) */
+    double gf_buf[128], *gf = gf_buf;
+    if (3 * sps + 1 > 128 &&
+        !(gf = (double *)malloc((size_t)(3 * sps + 1) * sizeof(double))))
+        return 0;
     int gf_len;
     gaussian_filter(bt, sps, 3, gf, &gf_len);
-
-    /* Filter to get frequency deviation */
-    double *freq = (double *)calloc(nsamples, sizeof(double));
-    for (int i = 0; i < nsamples; i++) {
-        freq[i] = 0;
-        for (int k = 0; k < gf_len; k++) {
-            int idx = i - k + gf_len / 2;
-            if (idx >= 0 && idx < nsamples)
-                freq[i] += nrz[idx] * gf[k];
+    int half = gf_len / 2;
+
+    /* Filter the NRZ impulse train (sample idx = ±1 from bit idx / sps)
+     * to get the frequency deviation, then integrate phase → I/Q.
+     * Long filters go through the FFT; the frequency track is the full
+     * convolution advanced by half the filter. */
+    real_t *y = NULL;
+    if (fastconv_faster(gf_len, gf_len, 1)) {
+        int len = nsamples + gf_len - 1;
+        real_t *x = (real_t *)malloc((size_t)(nsamples + gf_len) * sizeof(real_t));
+        y = (real_t *)malloc((size_t)len * sizeof(real_t));
+        if (x && y) {
+            real_t *h = x + nsamples;
+            for (int i = 0; i < nsamples; i++)
+                x[i] = bits[i / sps] ? 1.0 : -1.0;
+            for (int k = 0; k < gf_len; k++) h[k] = (real_t)gf[k];
+            if (fast_convolve_real(x, nsamples, h, gf_len, y) < 0) {
+                free(y);
+                y = NULL;
+            }
+        } else {
+            free(y);
+            y = NULL;
         }
+        free(x);
     }
 
-    /* Integrate phase and generate I/Q */
     double phase = 0;
     double dev = h_mod * M_PI / sps;
     for (int i = 0; i < nsamples; i++) {
-        phase += dev * freq[i];
+        double freq = 0;
+        if (y) {
+            freq = y[i + half];
+        } else {
+            /* Taps whose input index i − k + half lies in the frame */
+            int k0 = i + half - nsamples + 1, k1 = i + half;
+            if (k0 < 0) k0 = 0;
+            if (k1 > gf_len - 1) k1 = gf_len - 1;
+            for (int k = k0; k <= k1; k++) {
+                int idx = i - k + half;
+                freq += (bits[idx / sps] ? 1.0 : -1.0) * gf[k];
+            }
+        }
+        phase += dev * freq;
         out[i] = cplx_exp_j(phase);
     }
-
-    free(nrz);
-    free(freq);
+    free(y);
+    if (gf != gf_buf) free(gf);
     return nsamples;
 }
 
@@ -303,12 +339,18 @@ int gfsk_demodulate(const Cplx *in, int nsamples, int sps, uint8_t *bits)
  * ════════════════════════════════════════════════════════════════════ */
 
 int oqpsk_modulate(const uint8_t *bits, int nbits, int sps, Cplx *out)
+{
+    return oqpsk_modulate_ws(bits, nbits, sps, out, NULL);
+}
+
+int oqpsk_modulate_ws(const uint8_t *bits, int nbits, int sps, Cplx *out,
+                      CommsArena *ws)
 {
     int nsyms = nbits / 2;
     int nsamples = (nsyms + 1) * sps; /* +1 for Q offset */
 
     /* Generate half-sine pulse */
-    double *pulse = (double *)calloc(2 * sps, sizeof(double));
+    double *pulse = (double *)arena_scratch(ws, 2 * sps * sizeof(double));
     for (int i = 0; i < 2 * sps; i++)
         pulse[i] = sin(M_PI * i / (2.0 * sps));
 
@@ -328,7 +370,7 @@ int oqpsk_modulate(const uint8_t *bits, int nbits, int sps, Cplx *out)
             out[q_off + j].im += bq * pulse[j];
     }
 
-    free(pulse);
+    arena_scratch_free(ws, pulse);
     return nsamples;
 }
 
@@ -355,7 +397,7 @@ int oqpsk_demodulate(const Cplx *in, int nsamples, int sps, uint8_t *bits)
  *  Pulse shaping
  * ════════════════════════════════════════════════════════════════════ */
 
-int raised_cosine(double alpha, int sps, int span, double *h)
+int raised_cosine(double alpha, int sps, int span, real_t *h)
 {
     int len = span * sps + 1;
     int half = len / 2;
@@ -375,7 +417,7 @@ int raised_cosine(double alpha, int sps, int span, double *h)
     return len;
 }
 
-int root_raised_cosine(double alpha, int sps, int span, double *h)
+int root_raised_cosine(double alpha, int sps, int span, real_t *h)
 {
     int len = span * sps + 1;
     int half = len / 2;
@@ -406,36 +448,43 @@ int root_raised_cosine(double alpha, int sps, int span, double *h)
     return len;
 }
 
-int pulse_shape(const double *syms, int nsyms, const double *h, int hlen,
-                int sps, double *out)
+int pulse_shape(const real_t *syms, int nsyms, const real_t *h, int hlen,
+                int sps, real_t *out)
 {
     int up_len = nsyms * sps;
     int out_len = up_len + hlen - 1;
 
-    /* Upsample */
-    double *upsampled = (double *)calloc(up_len, sizeof(double));
-    for (int i = 0; i < nsyms; i++)
-        upsampled[i * sps] = syms[i];
-
-    /* Convolve */
-    memset(out, 0, out_len * sizeof(double));
-    for (int i = 0; i < up_len; i++) {
-        if (fabs(upsampled[i]) < 1e-15) continue;
-        for (int j = 0; j < hlen; j++)
-            out[i + j] += upsampled[i] * h[j];
+    /* Filters spanning many symbols are cheaper through the FFT, even
+     * though only every sps-th input sample is non-zero. */
+    if (fastconv_faster(hlen, (hlen + sps - 1) / sps, 1)) {
+        real_t *up = (real_t *)calloc((size_t)up_len, sizeof(real_t));
+        if (up) {
+            for (int i = 0; i < nsyms; i++) up[i * sps] = syms[i];
+            int r = fast_convolve_real(up, up_len, h, hlen, out);
+            free(up);
+            if (r == out_len) return out_len;
+        }
     }
 
-    free(upsampled);
+    /* Convolve the implicit upsampled train: only every sps-th input
+     * sample is non-zero, so scatter each symbol straight into out. */
+    const CommsKernels *kern = comms_kernels();
+    memset(out, 0, out_len * sizeof(real_t));
+    for (int i = 0; i < nsyms; i++) {
+        real_t s = syms[i];
+        if (fabs(s) < 1e-15) continue;
+        kern->fir_axpy(out + i * sps, h, s, hlen);
+    }
     return out_len;
 }
 
-void nrz_encode(const uint8_t *bits, int n, double *out)
+void nrz_encode(const uint8_t *bits, int n, real_t *out)
 {
     for (int i = 0; i < n; i++)
         out[i] = bits[i] ? 1.0 : -1.0;
 }
 
-void manchester_encode(const uint8_t *bits, int n, double *out)
+void manchester_encode(const uint8_t *bits, int n, real_t *out)
 {
     for (int i = 0; i < n; i++) {
         if (bits[i]) {
@@ -11,61 +11,26 @@
  *   IEEE 802.11-2020.
  */
 
+#define _POSIX_C_SOURCE 200112L   /* pthreads, sysconf */
+
 #include "../include/ofdm.h"
+#include "../include/cpu_dispatch.h"
+#include "../include/profile.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
 
-/* ════════════════════════════════════════════════════════════════════
- *  FFT (radix-2 DIT, in-place)
- * ════════════════════════════════════════════════════════════════════ */
-
-static void bit_reverse(Cplx *x, int n)
-{
-    int bits = 0;
-    for (int tmp = n; tmp > 1; tmp >>= 1) bits++;
-
-    for (int i = 0; i < n; i++) {
-        int j = 0;
-        for (int b = 0; b < bits; b++)
-            if (i & (1 << b)) j |= 1 << (bits - 1 - b);
-        if (j > i) {
-            Cplx tmp = x[i];
-            x[i] = x[j];
-            x[j] = tmp;
-        }
-    }
-}
-
-void fft(Cplx *x, int n)
-{
-    bit_reverse(x, n);
-    for (int size = 2; size <= n; size *= 2) {
-        int half = size / 2;
-        double angle = -2.0 * M_PI / size;
-        Cplx w_step = cplx_exp_j(angle);
-        for (int start = 0; start < n; start += size) {
-            Cplx w = cplx(1.0, 0.0);
-            for (int k = 0; k < half; k++) {
-                Cplx even = x[start + k];
-                Cplx odd  = cplx_mul(w, x[start + k + half]);
-                x[start + k]        = cplx_add(even, odd);
-                x[start + k + half] = cplx_sub(even, odd);
-                w = cplx_mul(w, w_step);
-            }
-        }
-    }
-}
-
-void ifft(Cplx *x, int n)
+/* Inline complex helpers: the comms_utils versions are out-of-line
+ * calls, which dominate the per-carrier loops. */
+static inline Cplx cmk(real_t re, real_t im) { Cplx z = { re, im }; return z; }
+static inline Cplx cadd(Cplx a, Cplx b) { return cmk(a.re + b.re, a.im + b.im); }
+static inline Cplx csub(Cplx a, Cplx b) { return cmk(a.re - b.re, a.im - b.im); }
+static inline Cplx cconj(Cplx a) { return cmk(a.re, -a.im); }
+static inline Cplx cmul(Cplx a, Cplx b)
 {
-    /* Conjugate, FFT, conjugate, scale by 1/N */
-    for (int i = 0; i < n; i++) x[i] = cplx_conj(x[i]);
-    fft(x, n);
-    for (int i = 0; i < n; i++) {
-        x[i] = cplx_conj(x[i]);
-        x[i] = cplx_scale(x[i], 1.0 / n);
-    }
+    return cmk(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -79,6 +44,7 @@ void ofdm_init(OfdmParams *p, int n_fft, int n_cp, int n_pilot)
     p->n_cp = n_cp;
     p->n_pilot = n_pilot;
     p->pilot_val = cplx(1.0, 0.0);
+    p->plan = fft_plan_get(n_fft);
 
     /* Guard bands: DC null + edge guards */
     p->n_guard_lo = n_fft / 8;
@@ -107,6 +73,25 @@ void ofdm_init(OfdmParams *p, int n_fft, int n_cp, int n_pilot)
             p->data_idx[d++] = k;
     }
     p->n_data = d;
+
+    /* Interpolation taps per data carrier.  Both index lists ascend, so
+     * one sweep finds the bracketing pilots; band edges take the nearest
+     * pilot with weight 0. */
+    int lo = -1;
+    for (int i = 0; i < d && n_pilot > 0; i++) {
+        int k = p->data_idx[i];
+        while (lo + 1 < n_pilot && p->pilot_idx[lo + 1] <= k) lo++;
+        OfdmInterp *t = &p->interp[i];
+        if (lo < 0 || lo == n_pilot - 1) {
+            t->lo = t->hi = (uint8_t)(lo < 0 ? 0 : lo);
+            t->w = 0;
+        } else {
+            t->lo = (uint8_t)lo;
+            t->hi = (uint8_t)(lo + 1);
+            t->w = (real_t)((double)(k - p->pilot_idx[lo]) /
+                            (double)(p->pilot_idx[lo + 1] - p->pilot_idx[lo]));
+        }
+    }
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -116,7 +101,8 @@ void ofdm_init(OfdmParams *p, int n_fft, int n_cp, int n_pilot)
 int ofdm_modulate(const OfdmParams *p, const Cplx *data_syms, Cplx *out)
 {
     int n = p->n_fft;
-    Cplx *freq = (Cplx *)calloc(n, sizeof(Cplx));
+    Cplx *freq = out + p->n_cp;    /* IFFT in place after the CP slot */
+    memset(freq, 0, n * sizeof(Cplx));
 
     /* Map data to subcarriers */
     for (int i = 0; i < p->n_data; i++)
@@ -127,26 +113,18 @@ int ofdm_modulate(const OfdmParams *p, const Cplx *data_syms, Cplx *out)
         freq[p->pilot_idx[i]] = p->pilot_val;
 
     /* IFFT → time domain */
-    ifft(freq, n);
+    if (p->plan) ifft_execute(p->plan, freq, freq);
+    else         ifft(freq, n);
 
-    /* Copy with cyclic prefix */
+    /* Cyclic prefix: copy of the symbol tail */
     memcpy(out, freq + n - p->n_cp, p->n_cp * sizeof(Cplx));
-    memcpy(out + p->n_cp, freq, n * sizeof(Cplx));
-
-    free(freq);
     return n + p->n_cp;
 }
 
 int ofdm_modulate_block(const OfdmParams *p, int n_symbols,
                         const Cplx *data_syms, Cplx *out)
 {
-    int total = 0;
-    int sym_size = p->n_fft + p->n_cp;
-    for (int s = 0; s < n_symbols; s++) {
-        ofdm_modulate(p, data_syms + s * p->n_data, out + s * sym_size);
-        total += sym_size;
-    }
-    return total;
+    return ofdm_modulate_block_ws(p, n_symbols, data_syms, out, NULL);
 }
 
 /* ════════════════════════════════════════════════════════════════════
@@ -156,23 +134,34 @@ int ofdm_modulate_block(const OfdmParams *p, int n_symbols,
 int ofdm_demodulate(const OfdmParams *p, const Cplx *in,
                     Cplx *data_syms, Cplx *h_est)
 {
-    int n = p->n_fft;
+    return ofdm_demodulate_ws(p, in, data_syms, h_est, NULL);
+}
+
+int ofdm_demodulate_ws(const OfdmParams *p, const Cplx *in,
+                       Cplx *data_syms, Cplx *h_est, CommsArena *ws)
+{
+    return ofdm_demodulate_avg(p, in, data_syms, h_est, NULL, ws);
+}
 
-    /* Remove CP, copy to work buffer */
-    Cplx *freq = (Cplx *)calloc(n, sizeof(Cplx));
-    memcpy(freq, in + p->n_cp, n * sizeof(Cplx));
+int ofdm_demodulate_avg(const OfdmParams *p, const Cplx *in,
+                        Cplx *data_syms, Cplx *h_est, OfdmPilotAvg *avg,
+                        CommsArena *ws)
+{
+    PROF_BEGIN(ofdm_demodulate);
+    int n = p->n_fft;
 
-    /* FFT → frequency domain */
-    fft(freq, n);
+    /* Remove CP: FFT straight out of the input into the work buffer */
+    Cplx *freq = (Cplx *)arena_scratch(ws, n * sizeof(Cplx));
+    if (p->plan) {
+        fft_execute_ws(p->plan, in + p->n_cp, freq, ws);
+    } else {
+        memcpy(freq, in + p->n_cp, n * sizeof(Cplx));
+        fft(freq, n);
+    }
 
     /* Channel estimation via pilots */
     Cplx h_interp[OFDM_MAX_CARRIERS];
-    if (p->n_pilot > 0) {
-        ofdm_channel_estimate(p, freq, h_interp);
-    } else {
-        for (int i = 0; i < p->n_data; i++)
-            h_interp[i] = cplx(1.0, 0.0);
-    }
+    ofdm_channel_estimate_avg(p, freq, avg, h_interp);
 
     /* Extract and equalise data */
     for (int i = 0; i < p->n_data; i++) {
@@ -184,65 +173,80 @@ int ofdm_demodulate(const OfdmParams *p, const Cplx *in,
         if (h_est) h_est[i] = h;
     }
 
-    free(freq);
+    arena_scratch_free(ws, freq);
+    PROF_END(ofdm_demodulate, n + p->n_cp);
     return p->n_data;
 }
 
 int ofdm_demodulate_block(const OfdmParams *p, int n_symbols,
                           const Cplx *in, Cplx *data_syms)
 {
-    int sym_size = p->n_fft + p->n_cp;
-    int total = 0;
-    for (int s = 0; s < n_symbols; s++) {
-        ofdm_demodulate(p, in + s * sym_size,
-                        data_syms + s * p->n_data, NULL);
-        total += p->n_data;
-    }
-    return total;
+    return ofdm_demodulate_block_ws(p, n_symbols, in, data_syms, NULL);
 }
 
 /* ════════════════════════════════════════════════════════════════════
  *  Channel estimation (linear interpolation between pilots)
  * ════════════════════════════════════════════════════════════════════ */
 
+static inline Cplx pilot_interp(const Cplx *h_pilot, OfdmInterp t)
+{
+    Cplx a = h_pilot[t.lo], b = h_pilot[t.hi];
+    return cmk(a.re * (1 - t.w) + b.re * t.w, a.im * (1 - t.w) + b.im * t.w);
+}
+
+/* H[k] = Rx[k] / Tx_pilot */
+static inline Cplx pilot_divide(const OfdmParams *p, Cplx rx_pilot)
+{
+    double p_mag2 = cplx_mag2(p->pilot_val);
+    if (p_mag2 < 1e-12) p_mag2 = 1e-12;
+    Cplx h = cmul(rx_pilot, cconj(p->pilot_val));
+    double inv = 1.0 / p_mag2;
+    return cmk(h.re * inv, h.im * inv);
+}
+
 void ofdm_channel_estimate(const OfdmParams *p, const Cplx *rx_freq,
                            Cplx *h_interp)
 {
-    /* Estimate H at pilot positions: H[k] = Rx[k] / Tx_pilot */
-    Cplx h_pilot[OFDM_MAX_PILOTS];
-    for (int i = 0; i < p->n_pilot; i++) {
-        Cplx rx_pilot = rx_freq[p->pilot_idx[i]];
-        double p_mag2 = cplx_mag2(p->pilot_val);
-        if (p_mag2 < 1e-12) p_mag2 = 1e-12;
-        h_pilot[i] = cplx_scale(cplx_mul(rx_pilot, cplx_conj(p->pilot_val)),
-                                1.0 / p_mag2);
+    ofdm_channel_estimate_avg(p, rx_freq, NULL, h_interp);
+}
+
+void ofdm_pilot_avg_init(OfdmPilotAvg *avg, double alpha)
+{
+    memset(avg, 0, sizeof(*avg));
+    avg->alpha = (alpha > 0.0 && alpha <= 1.0) ? alpha : 1.0;
+}
+
+void ofdm_channel_estimate_avg(const OfdmParams *p, const Cplx *rx_freq,
+                               OfdmPilotAvg *avg, Cplx *h_interp)
+{
+    if (p->n_pilot <= 0) {
+        for (int d = 0; d < p->n_data; d++) h_interp[d] = cmk(1.0, 0.0);
+        return;
     }
 
-    /* Linear interpolation to data positions */
-    for (int d = 0; d < p->n_data; d++) {
-        int dk = p->data_idx[d];
-
-        /* Find surrounding pilots */
-        int lo = -1, hi = -1;
-        for (int pi = 0; pi < p->n_pilot; pi++) {
-            if (p->pilot_idx[pi] <= dk) lo = pi;
-            if (p->pilot_idx[pi] >= dk && hi < 0) hi = pi;
-        }
-
-        if (lo < 0 && hi >= 0) {
-            h_interp[d] = h_pilot[hi];
-        } else if (hi < 0 && lo >= 0) {
-            h_interp[d] = h_pilot[lo];
-        } else if (lo >= 0 && hi >= 0 && lo != hi) {
-            double alpha = (double)(dk - p->pilot_idx[lo]) /
-                           (double)(p->pilot_idx[hi] - p->pilot_idx[lo]);
-            h_interp[d] = cplx_add(
-                cplx_scale(h_pilot[lo], 1.0 - alpha),
-                cplx_scale(h_pilot[hi], alpha));
-        } else {
-            h_interp[d] = (lo >= 0) ? h_pilot[lo] : cplx(1.0, 0.0);
+    /* Estimate H at pilot positions */
+    Cplx h_buf[OFDM_MAX_PILOTS];
+    Cplx *h_pilot = avg ? avg->h_pilot : h_buf;
+    if (!avg) {
+        for (int i = 0; i < p->n_pilot; i++)
+            h_pilot[i] = pilot_divide(p, rx_freq[p->pilot_idx[i]]);
+    } else {
+        /* Running mean until 1/alpha symbols, then exponential */
+        double w = 1.0 / (avg->n_symbols + 1);
+        if (w < avg->alpha) w = avg->alpha;
+        for (int i = 0; i < p->n_pilot; i++) {
+            Cplx e = csub(pilot_divide(p, rx_freq[p->pilot_idx[i]]),
+                          h_pilot[i]);
+            h_pilot[i] = cmk(h_pilot[i].re + w * e.re,
+                             h_pilot[i].im + w * e.im);
         }
+        avg->n_symbols++;
     }
+
+    /* Linear interpolation to data positions: one pass over the taps
+     * ofdm_init() precomputed */
+    for (int d = 0; d < p->n_data; d++)
+        h_interp[d] = pilot_interp(h_pilot, p->interp[d]);
 }
 
 void ofdm_equalise_zf(const Cplx *data, const Cplx *h, int n, Cplx *out)
@@ -253,3 +257,800 @@ void ofdm_equalise_zf(const Cplx *data, const Cplx *h, int n, Cplx *out)
         out[i] = cplx_scale(cplx_mul(data[i], cplx_conj(h[i])), 1.0 / h_mag2);
     }
 }
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Batched OFDM: a group of symbols per transform pass
+ *
+ *  A group of B symbols is held sample-major in split arrays — sample k
+ *  of symbol b at re[k·B + b] — so each radix-2 butterfly is a single
+ *  dispatched call over B contiguous lanes and SIMD runs across symbols
+ *  instead of within one short FFT.  Sizes that are not 2^k, or too
+ *  large for a group to stay cache resident, are transformed one symbol
+ *  at a time into the same layout.
+ * ════════════════════════════════════════════════════════════════════ */
+
+#define BATCH_MAX_SYMS  16
+#define BATCH_BYTES     (16 * 1024)      /* re + im working set (L1)     */
+#define BATCH_MAX_FFT   (BATCH_BYTES / (2 * OFDM_FRAME_EST_SYMS * \
+                                        (int)sizeof(real_t)))
+
+static int batch_size(const OfdmParams *p, int n_symbols)
+{
+    int b = BATCH_BYTES / (2 * p->n_fft * (int)sizeof(real_t));
+    if (b > BATCH_MAX_SYMS) b = BATCH_MAX_SYMS;
+    if (b < OFDM_FRAME_EST_SYMS) b = OFDM_FRAME_EST_SYMS;
+    return b < n_symbols ? b : n_symbols;
+}
+
+static int batch_fft_ok(const OfdmParams *p)
+{
+    return p->plan && p->plan->kind == FFT_RADIX2 &&
+           p->n_fft <= BATCH_MAX_FFT;
+}
+
+/* Radix-4 passes of pow2_run() from block size h on, B lanes */
+static void batch_passes(const FftPlan *plan, real_t *re, real_t *im,
+                         int B, int h, real_t sg)
+{
+    const CommsKernels *kern = comms_kernels();
+    for (; h < plan->n; h *= 4) {
+        const real_t *const w[6] = {
+            plan->twr + 2 * h - 1, plan->twi + 2 * h - 1,
+            plan->twr + h - 1,     plan->twi + h - 1,
+            plan->tw3r + h - 1,    plan->tw3i + h - 1
+        };
+        kern->fft_r4_lanes(re, im, plan->n, h, w, sg, B);
+    }
+}
+
+/* pow2_run() on B lanes whose input is already bit-reversed: the
+ * same passes and arithmetic, so each lane is bit-identical to a
+ * per-symbol transform. */
+static void batch_fft(const FftPlan *plan, real_t *re, real_t *im, int B,
+                      int inverse)
+{
+    int n = plan->n, h = 1;
+    if (plan->log2n & 1) {
+        for (int i = 0; i < n; i += 2) {
+            real_t *ar = re + (size_t)i * B, *ai = im + (size_t)i * B;
+            real_t *br = ar + B, *bi = ai + B;
+            for (int b = 0; b < B; b++) {
+                real_t tr = ar[b], ti = ai[b];
+                ar[b] = tr + br[b];  ai[b] = ti + bi[b];
+                br[b] = tr - br[b];  bi[b] = ti - bi[b];
+            }
+        }
+        h = 2;
+    }
+    batch_passes(plan, re, im, B, h, inverse ? -1 : 1);
+}
+
+/* batch_fft() reading its input straight from the caller's buffers:
+ * element k of lane b is src[k][b · stride[k]].  The bit-reversed
+ * gather is fused into the first pass, so the group is written once
+ * before the remaining passes. */
+static void batch_fft_from(const FftPlan *plan, const Cplx *const *src,
+                           const size_t *stride, real_t *re, real_t *im,
+                           int B, int inverse)
+{
+    const int *rev = plan->rev;
+    int n = plan->n;
+    real_t sg = inverse ? -1 : 1;
+    if (n < 4) {
+        for (int i = 0; i < n; i++) {
+            const Cplx *x = src[rev[i]];
+            for (int b = 0; b < B; b++) {
+                re[(size_t)i * B + b] = x[b * stride[rev[i]]].re;
+                im[(size_t)i * B + b] = x[b * stride[rev[i]]].im;
+            }
+        }
+        batch_fft(plan, re, im, B, inverse);
+        return;
+    }
+
+    if (plan->log2n & 1) {
+        for (int i = 0; i < n; i += 2) {
+            const Cplx *xa = src[rev[i]], *xb = src[rev[i + 1]];
+            size_t sa = stride[rev[i]], sb = stride[rev[i + 1]];
+            real_t *ar = re + (size_t)i * B, *ai = im + (size_t)i * B;
+            for (int b = 0; b < B; b++) {
+                Cplx u = xa[b * sa], v = xb[b * sb];
+                ar[b] = u.re + v.re;      ai[b] = u.im + v.im;
+                ar[B + b] = u.re - v.re;  ai[B + b] = u.im - v.im;
+            }
+        }
+        batch_passes(plan, re, im, B, 2, sg);
+        return;
+    }
+
+    /* First radix-4 pass (h = 1): slots i .. i+3 hold F0, F2, F1, F3 */
+    real_t c1 = plan->twr[1],  s1 = sg * plan->twi[1];
+    real_t c2 = plan->twr[0],  s2 = sg * plan->twi[0];
+    real_t c3 = plan->tw3r[0], s3 = sg * plan->tw3i[0];
+    for (int i = 0; i < n; i += 4) {
+        const Cplx *x0 = src[rev[i]],     *x2 = src[rev[i + 1]];
+        const Cplx *x1 = src[rev[i + 2]], *x3 = src[rev[i + 3]];
+        size_t st0 = stride[rev[i]],     st2 = stride[rev[i + 1]];
+        size_t st1 = stride[rev[i + 2]], st3 = stride[rev[i + 3]];
+        real_t *f0r = re + (size_t)i * B, *f0i = im + (size_t)i * B;
+        for (int b = 0; b < B; b++) {
+            Cplx u0 = x0[b * st0], u1 = x1[b * st1];
+            Cplx u2 = x2[b * st2], u3 = x3[b * st3];
+            real_t br = c2 * u2.re - s2 * u2.im, bi = c2 * u2.im + s2 * u2.re;
+            real_t cr = c1 * u1.re - s1 * u1.im, ci = c1 * u1.im + s1 * u1.re;
+            real_t dr = c3 * u3.re - s3 * u3.im, di = c3 * u3.im + s3 * u3.re;
+
+            real_t t0r = u0.re + br, t0i = u0.im + bi;
+            real_t t1r = u0.re - br, t1i = u0.im - bi;
+            real_t t2r = cr + dr, t2i = ci + di;
+            real_t t3r = sg * (ci - di), t3i = -sg * (cr - dr);
+
+            f0r[b]         = t0r + t2r;  f0i[b]         = t0i + t2i;
+            f0r[2 * B + b] = t0r - t2r;  f0i[2 * B + b] = t0i - t2i;
+            f0r[B + b]     = t1r + t3r;  f0i[B + b]     = t1i + t3i;
+            f0r[3 * B + b] = t1r - t3r;  f0i[3 * B + b] = t1i - t3i;
+        }
+    }
+    batch_passes(plan, re, im, B, 4, sg);
+}
+
+/* CP removal and FFT of nb received symbols into the group layout */
+static void batch_load(const OfdmParams *p, const Cplx *in, int nb,
+                       real_t *re, real_t *im, Cplx *tmp, CommsArena *ws)
+{
+    int n = p->n_fft, sym = n + p->n_cp;
+    if (batch_fft_ok(p)) {
+        const Cplx *src[BATCH_MAX_FFT];
+        size_t stride[BATCH_MAX_FFT];
+        for (int k = 0; k < n; k++) {
+            src[k] = in + p->n_cp + k;
+            stride[k] = (size_t)sym;
+        }
+        batch_fft_from(p->plan, src, stride, re, im, nb, 0);
+        return;
+    }
+
+    for (int b = 0; b < nb; b++) {
+        const Cplx *x = in + (size_t)b * sym + p->n_cp;
+        if (p->plan) {
+            fft_execute_ws(p->plan, x, tmp, ws);
+        } else {
+            memcpy(tmp, x, n * sizeof(Cplx));
+            fft(tmp, n);
+        }
+        for (int k = 0; k < n; k++) {
+            re[k * nb + b] = tmp[k].re;
+            im[k * nb + b] = tmp[k].im;
+        }
+    }
+}
+
+/* Channel at the data carriers from the pilots of lanes b0 .. b0+cnt−1
+ * (averaged) */
+static void batch_pilots(const OfdmParams *p, const real_t *re,
+                         const real_t *im, int B, int b0, int cnt, Cplx *h)
+{
+    if (p->n_pilot > 0) {
+        Cplx h_pilot[OFDM_MAX_PILOTS];
+        double inv = 1.0 / cnt;
+        for (int i = 0; i < p->n_pilot; i++) {
+            const real_t *pr = re + (size_t)p->pilot_idx[i] * B + b0;
+            const real_t *pi = im + (size_t)p->pilot_idx[i] * B + b0;
+            double sr = 0.0, si = 0.0;
+            for (int b = 0; b < cnt; b++) { sr += pr[b]; si += pi[b]; }
+            h_pilot[i] = pilot_divide(p, cmk(sr * inv, si * inv));
+        }
+        for (int d = 0; d < p->n_data; d++)
+            h[d] = pilot_interp(h_pilot, p->interp[d]);
+    } else {
+        for (int d = 0; d < p->n_data; d++) h[d] = cmk(1.0, 0.0);
+    }
+}
+
+/* One-tap equaliser conj(h) · 1/|h|² as g[d·gs], g_inv[d·gs] */
+static void batch_equaliser(const OfdmParams *p, const Cplx *h, Cplx *g,
+                            double *g_inv, int gs)
+{
+    for (int d = 0; d < p->n_data; d++) {
+        double h_mag2 = h[d].re * h[d].re + h[d].im * h[d].im;
+        if (h_mag2 < 1e-12) h_mag2 = 1e-12;
+        g[(size_t)d * gs] = cconj(h[d]);
+        g_inv[(size_t)d * gs] = 1.0 / h_mag2;
+    }
+}
+
+/* Frame estimate from the first OFDM_FRAME_EST_SYMS symbols — the same
+ * lanes and summation order demod_batch() uses, so bit-identical. */
+static void frame_estimate(const OfdmParams *p, int n_symbols,
+                           const Cplx *in, Cplx *h, CommsArena *ws)
+{
+    int n = p->n_fft;
+    int cnt = n_symbols < OFDM_FRAME_EST_SYMS ? n_symbols
+                                              : OFDM_FRAME_EST_SYMS;
+    Cplx *tmp = (Cplx *)arena_scratch(ws, (size_t)n * sizeof(Cplx) +
+                                          (size_t)2 * n * cnt *
+                                          sizeof(real_t));
+    real_t *re = (real_t *)(tmp + n), *im = re + (size_t)n * cnt;
+    batch_load(p, in, cnt, re, im, tmp, ws);
+    batch_pilots(p, re, im, cnt, 0, cnt, h);
+    arena_scratch_free(ws, tmp);
+}
+
+/* h_frame: a frame estimate computed elsewhere (frame_est only) */
+static int demod_batch(const OfdmParams *p, int n_symbols, const Cplx *in,
+                       Cplx *data_syms, int frame_est, const Cplx *h_frame,
+                       Cplx *h_est, CommsArena *ws)
+{
+    if (n_symbols <= 0) return 0;
+    PROF_BEGIN(ofdm_demodulate_block);
+    int n = p->n_fft, sym = n + p->n_cp, nd = p->n_data;
+    int B = batch_size(p, n_symbols);
+
+    /* g_inv | h | g | tmp | re | im — one block, widest first.
+     * Per-symbol equalisers are kept per lane, g[d·nb + b]. */
+    int ng = frame_est ? 1 : B;
+    size_t bytes = (size_t)nd * (sizeof(Cplx) +
+                                 ng * (sizeof(double) + sizeof(Cplx))) +
+                   (size_t)n * sizeof(Cplx) +
+                   (size_t)2 * n * B * sizeof(real_t);
+    double *g_inv = (double *)arena_scratch(ws, bytes);
+    Cplx *h = (Cplx *)(g_inv + (size_t)nd * ng), *g = h + nd;
+    Cplx *tmp = g + (size_t)nd * ng;
+    real_t *re = (real_t *)(tmp + n);
+    if (frame_est && h_frame) {
+        memcpy(h, h_frame, nd * sizeof(Cplx));
+        batch_equaliser(p, h, g, g_inv, 1);
+    }
+
+    for (int s = 0; s < n_symbols; s += B) {
+        int nb = n_symbols - s < B ? n_symbols - s : B;
+        real_t *im = re + (size_t)n * nb;
+        batch_load(p, in + (size_t)s * sym, nb, re, im, tmp, ws);
+
+        if (!frame_est) {
+            for (int b = 0; b < nb; b++) {
+                batch_pilots(p, re, im, nb, b, 1, h);
+                batch_equaliser(p, h, g + b, g_inv + b, nb);
+            }
+        } else if (s == 0 && !h_frame) {
+            int cnt = nb < OFDM_FRAME_EST_SYMS ? nb : OFDM_FRAME_EST_SYMS;
+            batch_pilots(p, re, im, nb, 0, cnt, h);
+            batch_equaliser(p, h, g, g_inv, 1);
+        }
+
+        /* Equalise carrier by carrier across the group; a frame
+         * equaliser has one lane (stride 0) shared by all symbols */
+        int gs = frame_est ? 1 : nb, gl = frame_est ? 0 : 1;
+        Cplx *out = data_syms + (size_t)s * nd;
+        for (int d = 0; d < nd; d++) {
+            const real_t *yr = re + (size_t)p->data_idx[d] * nb;
+            const real_t *yi = im + (size_t)p->data_idx[d] * nb;
+            const Cplx *gd = g + (size_t)d * gs;
+            const double *gi = g_inv + (size_t)d * gs;
+            for (int b = 0; b < nb; b++) {
+                Cplx y = cmul(cmk(yr[b], yi[b]), gd[b * gl]);
+                out[(size_t)b * nd + d] = cmk(y.re * gi[b * gl],
+                                              y.im * gi[b * gl]);
+            }
+        }
+    }
+
+    if (h_est) memcpy(h_est, h, nd * sizeof(Cplx));
+    arena_scratch_free(ws, g_inv);
+    PROF_END(ofdm_demodulate_block, (long)n_symbols * sym);
+    return n_symbols * nd;
+}
+
+int ofdm_demodulate_block_ws(const OfdmParams *p, int n_symbols,
+                             const Cplx *in, Cplx *data_syms, CommsArena *ws)
+{
+    return demod_batch(p, n_symbols, in, data_syms, 0, NULL, NULL, ws);
+}
+
+int ofdm_demodulate_frame(const OfdmParams *p, int n_symbols,
+                          const Cplx *in, Cplx *data_syms, Cplx *h_est,
+                          CommsArena *ws)
+{
+    return demod_batch(p, n_symbols, in, data_syms, 1, NULL, h_est, ws);
+}
+
+int ofdm_modulate_block_ws(const OfdmParams *p, int n_symbols,
+                           const Cplx *data_syms, Cplx *out, CommsArena *ws)
+{
+    int n = p->n_fft, sym = n + p->n_cp, nd = p->n_data;
+    if (n_symbols <= 0) return 0;
+    if (!batch_fft_ok(p)) {
+        for (int s = 0; s < n_symbols; s++)
+            ofdm_modulate(p, data_syms + (size_t)s * nd,
+                          out + (size_t)s * sym);
+        return n_symbols * sym;
+    }
+
+    PROF_BEGIN(ofdm_modulate_block);
+    int B = batch_size(p, n_symbols);
+
+    /* Subcarrier map as batch input: data carriers step through the
+     * symbols, pilots and nulls repeat one value (stride 0). */
+    static const Cplx zero = { 0, 0 };
+    const Cplx *src[BATCH_MAX_FFT];
+    size_t stride[BATCH_MAX_FFT];
+    for (int k = 0; k < n; k++) { src[k] = &zero; stride[k] = 0; }
+    for (int i = 0; i < p->n_pilot; i++) src[p->pilot_idx[i]] = &p->pilot_val;
+    for (int d = 0; d < nd; d++) stride[p->data_idx[d]] = (size_t)nd;
+
+    real_t *re = (real_t *)arena_scratch(ws, (size_t)2 * n * B *
+                                             sizeof(real_t));
+    double scale = 1.0 / n;
+
+    for (int s = 0; s < n_symbols; s += B) {
+        int nb = n_symbols - s < B ? n_symbols - s : B;
+        real_t *im = re + (size_t)n * nb;
+        for (int d = 0; d < nd; d++)
+            src[p->data_idx[d]] = data_syms + (size_t)s * nd + d;
+        batch_fft_from(p->plan, src, stride, re, im, nb, 1);
+
+        /* Scale and write each symbol with its cyclic prefix in place */
+        for (int b = 0; b < nb; b++) {
+            Cplx *o = out + (size_t)(s + b) * sym;
+            for (int t = 0; t < sym; t++) {
+                int i = t < p->n_cp ? t + n - p->n_cp : t - p->n_cp;
+                o[t] = cmk(re[i * nb + b] * scale, im[i * nb + b] * scale);
+            }
+        }
+    }
+
+    arena_scratch_free(ws, re);
+    PROF_END(ofdm_modulate_block, (long)n_symbols * sym);
+    return n_symbols * sym;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Threaded frame processing
+ *
+ *  Workers sleep on a condition variable between frames.  A frame bumps
+ *  the generation counter, the caller runs range 0 itself and then waits
+ *  for the others to check in.  Ranges are fixed by worker index, so the
+ *  output never depends on scheduling.
+ * ════════════════════════════════════════════════════════════════════ */
+
+typedef void (*PoolFn)(void *ctx, int w);
+
+typedef struct {
+    struct OfdmPoolSync *sync;
+    int                  w;
+} PoolArg;
+
+struct OfdmPoolSync {
+    pthread_mutex_t mu;
+    pthread_cond_t  start, done;
+    unsigned long   gen;             /* frames issued                 */
+    int             busy;            /* workers still running         */
+    int             quit;
+    PoolFn          fn;
+    void           *ctx;
+    int             n_started;
+    pthread_t       threads[OFDM_POOL_MAX_THREADS];
+    PoolArg         args[OFDM_POOL_MAX_THREADS];
+};
+
+static void *pool_worker(void *arg)
+{
+    const PoolArg *a = (const PoolArg *)arg;
+    struct OfdmPoolSync *s = a->sync;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&s->mu);
+    for (;;) {
+        while (!s->quit && s->gen == seen)
+            pthread_cond_wait(&s->start, &s->mu);
+        if (s->quit) break;
+        seen = s->gen;
+        pthread_mutex_unlock(&s->mu);
+
+        s->fn(s->ctx, a->w);
+
+        pthread_mutex_lock(&s->mu);
+        if (--s->busy == 0) pthread_cond_signal(&s->done);
+    }
+    pthread_mutex_unlock(&s->mu);
+    return NULL;
+}
+
+static void pool_stop(struct OfdmPoolSync *s)
+{
+    pthread_mutex_lock(&s->mu);
+    s->quit = 1;
+    pthread_cond_broadcast(&s->start);
+    pthread_mutex_unlock(&s->mu);
+    for (int i = 0; i < s->n_started; i++)
+        pthread_join(s->threads[i], NULL);
+    pthread_cond_destroy(&s->done);
+    pthread_cond_destroy(&s->start);
+    pthread_mutex_destroy(&s->mu);
+    free(s);
+}
+
+int ofdm_pool_init(OfdmPool *pool, int n_threads)
+{
+    memset(pool, 0, sizeof(*pool));
+    if (n_threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = n > 0 ? (int)n : 1;
+    }
+    if (n_threads > OFDM_POOL_MAX_THREADS) n_threads = OFDM_POOL_MAX_THREADS;
+
+    /* Select kernels now rather than racing on first use in the workers */
+    simd_init();
+
+    pool->ws = (CommsArena *)calloc(n_threads, sizeof(CommsArena));
+    if (!pool->ws) return -1;
+    pool->n_threads = n_threads;
+    for (int w = 0; w < n_threads; w++) {
+        if (arena_init(&pool->ws[w], OFDM_POOL_WS_BYTES) != 0) {
+            ofdm_pool_free(pool);
+            return -1;
+        }
+    }
+    if (n_threads == 1) return 0;
+
+    struct OfdmPoolSync *s = (struct OfdmPoolSync *)calloc(1, sizeof(*s));
+    if (!s) { ofdm_pool_free(pool); return -1; }
+    pthread_mutex_init(&s->mu, NULL);
+    pthread_cond_init(&s->start, NULL);
+    pthread_cond_init(&s->done, NULL);
+    for (int w = 1; w < n_threads; w++) {
+        PoolArg *a = &s->args[w - 1];
+        a->sync = s;
+        a->w = w;
+        if (pthread_create(&s->threads[w - 1], NULL, pool_worker, a) != 0) {
+            pool_stop(s);
+            ofdm_pool_free(pool);
+            return -1;
+        }
+        s->n_started++;
+    }
+    pool->sync = s;
+    return 0;
+}
+
+void ofdm_pool_free(OfdmPool *pool)
+{
+    if (pool->sync) pool_stop(pool->sync);
+    if (pool->ws) {
+        for (int w = 0; w < pool->n_threads; w++) arena_free(&pool->ws[w]);
+        free(pool->ws);
+    }
+    memset(pool, 0, sizeof(*pool));
+}
+
+/* fn(ctx, w) for every worker w, the caller taking w = 0 */
+static void pool_run(OfdmPool *pool, PoolFn fn, void *ctx)
+{
+    struct OfdmPoolSync *s = pool->sync;
+    if (!s) { fn(ctx, 0); return; }
+
+    pthread_mutex_lock(&s->mu);
+    s->fn = fn;
+    s->ctx = ctx;
+    s->busy = pool->n_threads - 1;
+    s->gen++;
+    pthread_cond_broadcast(&s->start);
+    pthread_mutex_unlock(&s->mu);
+
+    fn(ctx, 0);
+
+    pthread_mutex_lock(&s->mu);
+    while (s->busy > 0) pthread_cond_wait(&s->done, &s->mu);
+    pthread_mutex_unlock(&s->mu);
+}
+
+typedef struct {
+    OfdmPool         *pool;
+    const OfdmParams *p;
+    int               n_symbols;
+    const Cplx       *in;
+    Cplx             *data_syms;
+    int               frame_est;
+    const Cplx       *h_frame;
+    const OfdmDemap  *demap;
+} DemodJob;
+
+static void demod_job(void *ctx, int w)
+{
+    const DemodJob *j = (const DemodJob *)ctx;
+    int nt = j->pool->n_threads, nd = j->p->n_data;
+    int s0 = (int)((long)j->n_symbols * w / nt);
+    int s1 = (int)((long)j->n_symbols * (w + 1) / nt);
+    if (s1 <= s0) return;
+
+    size_t sym = (size_t)(j->p->n_fft + j->p->n_cp);
+    Cplx *out = j->data_syms + (size_t)s0 * nd;
+    demod_batch(j->p, s1 - s0, j->in + s0 * sym, out, j->frame_est,
+                j->h_frame, NULL, &j->pool->ws[w]);
+
+    const OfdmDemap *dm = j->demap;
+    if (dm) {
+        int ns = (s1 - s0) * nd;
+        size_t off = (size_t)s0 * nd * mod_bits_per_symbol(dm->scheme);
+        if (dm->bits) mod_demodulate(dm->scheme, out, ns, dm->bits + off);
+        if (dm->llr)
+            mod_demodulate_soft(dm->scheme, out, ns, dm->sigma,
+                                dm->llr + off);
+    }
+}
+
+int ofdm_demodulate_block_mt(OfdmPool *pool, const OfdmParams *p,
+                             int n_symbols, const Cplx *in,
+                             Cplx *data_syms, const OfdmDemap *demap)
+{
+    if (n_symbols <= 0) return 0;
+    DemodJob j = { pool, p, n_symbols, in, data_syms, 0, NULL, demap };
+    pool_run(pool, demod_job, &j);
+    return n_symbols * p->n_data;
+}
+
+int ofdm_demodulate_frame_mt(OfdmPool *pool, const OfdmParams *p,
+                             int n_symbols, const Cplx *in,
+                             Cplx *data_syms, Cplx *h_est,
+                             const OfdmDemap *demap)
+{
+    if (n_symbols <= 0) return 0;
+    Cplx *h = (Cplx *)arena_scratch(&pool->ws[0],
+                                    p->n_data * sizeof(Cplx));
+    frame_estimate(p, n_symbols, in, h, &pool->ws[0]);
+    DemodJob j = { pool, p, n_symbols, in, data_syms, 1, h, demap };
+    pool_run(pool, demod_job, &j);
+    if (h_est) memcpy(h_est, h, p->n_data * sizeof(Cplx));
+    arena_scratch_free(&pool->ws[0], h);
+    return n_symbols * p->n_data;
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Frame synchronisation (Schmidl & Cox, IEEE Trans. Commun. 1997)
+ * ════════════════════════════════════════════════════════════════════ */
+
+/* QPSK point ±1 ± j from two bits of a fixed LFSR stream */
+static Cplx sync_pn(uint32_t *lfsr)
+{
+    int b[2];
+    for (int i = 0; i < 2; i++) {
+        b[i] = *lfsr & 1;
+        *lfsr = (*lfsr >> 1) ^ (b[i] ? 0xB4BCD35Cu : 0u);
+    }
+    return cmk(b[0] ? -1.0 : 1.0, b[1] ? -1.0 : 1.0);
+}
+
+/* Training spectra on the used (data and pilot) carriers: X1 on the
+ * even ones only at twice the power, X2 on all at unit power. */
+static void sync_training(const OfdmParams *p, Cplx *x1, Cplx *x2)
+{
+    int n = p->n_fft;
+    uint32_t lfsr = 0x5EED1u;
+    memset(x1, 0, n * sizeof(Cplx));
+    memset(x2, 0, n * sizeof(Cplx));
+    for (int k = 0, d = 0, q = 0; k < n; k++) {
+        int used = 0;
+        if (d < p->n_data && p->data_idx[d] == k)   { used = 1; d++; }
+        if (q < p->n_pilot && p->pilot_idx[q] == k) { used = 1; q++; }
+        if (!used) continue;
+        Cplx c1 = sync_pn(&lfsr), c2 = sync_pn(&lfsr);
+        if (!(k & 1)) x1[k] = c1;
+        x2[k] = cmk(c2.re * sqrt(0.5), c2.im * sqrt(0.5));
+    }
+}
+
+int ofdm_sync_preamble(const OfdmParams *p, Cplx *out)
+{
+    int n = p->n_fft, sym = n + p->n_cp;
+    sync_training(p, out + p->n_cp, out + sym + p->n_cp);
+    for (int i = 0; i < 2; i++) {
+        Cplx *body = out + i * sym + p->n_cp;
+        if (p->plan) ifft_execute(p->plan, body, body);
+        else         ifft(body, n);
+        memcpy(out + i * sym, body + n - p->n_cp, p->n_cp * sizeof(Cplx));
+    }
+    return 2 * sym;
+}
+
+int ofdm_sync_init(OfdmSync *s, const OfdmParams *p, double threshold,
+                   int frame_syms)
+{
+    memset(s, 0, sizeof(*s));
+    int n = p->n_fft, sym = n + p->n_cp;
+    if (n < 4 || (n & 1) || frame_syms < 1) return -1;
+    s->p = p;
+    s->threshold = threshold;
+    s->frame_syms = frame_syms;
+
+    /* History for the metric, the preamble and one detection delay */
+    int len = 1;
+    while (len < 4 * sym) len <<= 1;
+    s->mask = len - 1;
+    s->ring   = (Cplx *)calloc((size_t)len, sizeof(Cplx));
+    s->m_buf  = (real_t *)malloc((size_t)sym * sizeof(real_t));
+    s->x1     = (Cplx *)malloc((size_t)n * sizeof(Cplx));
+    s->x2     = (Cplx *)malloc((size_t)n * sizeof(Cplx));
+    s->even_k = (int *)malloc((size_t)(n / 2) * sizeof(int));
+    s->v      = (Cplx *)malloc((size_t)(n / 2) * sizeof(Cplx));
+    s->ref    = (Cplx *)malloc((size_t)n * sizeof(Cplx));
+    if (!s->ring || !s->m_buf || !s->x1 || !s->x2 || !s->even_k || !s->v ||
+        !s->ref) {
+        ofdm_sync_free(s);
+        return -1;
+    }
+
+    /* conj(X2[k] / X1[k]) on the even carriers, normalised to unit size */
+    sync_training(p, s->x1, s->x2);
+    for (int k = 0; k < n; k += 2) {
+        if (s->x1[k].re == 0 && s->x1[k].im == 0) continue;
+        s->even_k[s->n_even] = k;
+        s->v[s->n_even++] = cmul(s->x2[k], cconj(s->x1[k]));
+    }
+    for (int i = 0; i < s->n_even; i++)
+        s->v[i] = cmk(s->v[i].re * sqrt(0.5), -s->v[i].im * sqrt(0.5));
+
+    for (int k = 0; k < n; k++) s->ref[k] = cconj(s->x1[k]);
+    return 0;
+}
+
+void ofdm_sync_free(OfdmSync *s)
+{
+    free(s->ring);
+    free(s->m_buf);
+    free(s->x1);
+    free(s->x2);
+    free(s->even_k);
+    free(s->v);
+    free(s->ref);
+    memset(s, 0, sizeof(*s));
+}
+
+/* Copy n samples from absolute stream index t0, derotated by the
+ * frequency estimate referenced to the start of training symbol 1. */
+static void sync_fetch(const OfdmSync *s, int64_t t0, int n, Cplx *out)
+{
+    int n_fft = s->p->n_fft;
+    double ph = -2.0 * M_PI * s->cfo * (double)(t0 - s->t1) / n_fft;
+    Cplx rot = cmk(cos(fmod(ph, 2.0 * M_PI)), sin(fmod(ph, 2.0 * M_PI)));
+    for (int i = 0; i < n; i++) {
+        out[i] = cmul(s->ring[(t0 + i) & s->mask], rot);
+        rot = cmul(rot, s->nco_step);
+    }
+}
+
+/* Plateau closed: timing from its centre, fractional offset from arg P */
+static void sync_plateau_done(OfdmSync *s)
+{
+    double lim = 0.9 * s->m_max;
+    int first = 0, last = s->m_len - 1;
+    while (s->m_buf[first] < lim) first++;
+    while (s->m_buf[last] < lim) last--;
+    s->t1 = s->m_d0 + (first + last) / 2 + s->p->n_cp / 2;
+    s->cfo = atan2(s->p_max.im, s->p_max.re) / M_PI;
+    s->m_len = 0;
+    s->state = OFDM_SYNC_TRAINING;
+}
+
+/* Both training symbols buffered: add the even integer offset 2g that
+ * best aligns X1* X2 with the known v = X2 / X1 (Schmidl & Cox eq. 37). */
+static void sync_integer_cfo(OfdmSync *s)
+{
+    const OfdmParams *p = s->p;
+    int n = p->n_fft;
+    s->nco_step = cplx_exp_j(-2.0 * M_PI * s->cfo / n);
+    sync_fetch(s, s->t1, n, s->x1);
+    sync_fetch(s, s->t1 + n + p->n_cp, n, s->x2);
+    if (p->plan) {
+        fft_execute(p->plan, s->x1, s->x1);
+        fft_execute(p->plan, s->x2, s->x2);
+    } else {
+        fft(s->x1, n);
+        fft(s->x2, n);
+    }
+
+    for (int k = 0; k < n; k++)
+        s->x2[k] = cmul(cconj(s->x1[k]), s->x2[k]);
+    int g_max = n / 16, best = 0;
+    double b_best = -1.0;
+    for (int g = -g_max; g <= g_max; g++) {
+        Cplx acc = cmk(0, 0);
+        for (int i = 0; i < s->n_even; i++) {
+            int k = s->even_k[i] + 2 * g;
+            k += k < 0 ? n : k >= n ? -n : 0;
+            acc = cadd(acc, cmul(s->x2[k], s->v[i]));
+        }
+        double b = acc.re * acc.re + acc.im * acc.im;
+        if (b > b_best) { b_best = b; best = g; }
+    }
+    s->cfo += 2 * best;
+    s->nco_step = cplx_exp_j(-2.0 * M_PI * s->cfo / n);
+
+    /* Fine timing: the plateau only brackets the symbol start within the
+     * CP.  Correlating with the known symbol 1 — in the frequency
+     * domain, X1 shifted by the integer offset times conj(X1_ref) — gives
+     * an IFFT peak at the remaining offset, searched over ±n_cp/2. */
+    for (int k = 0; k < n; k++)
+        s->x2[k] = cmul(s->x1[(k + 2 * best + n) % n], s->ref[k]);
+    if (p->plan) ifft_execute(p->plan, s->x2, s->x2);
+    else         ifft(s->x2, n);
+    int w = p->n_cp / 2, d_best = 0;
+    double c_best = -1.0;
+    for (int d = -w; d <= w; d++) {
+        Cplx z = s->x2[(d + n) % n];
+        double c = z.re * z.re + z.im * z.im;
+        if (c > c_best) { c_best = c; d_best = d; }
+    }
+    s->t1 += d_best;
+    s->next = s->t1 + 2 * n + p->n_cp;
+    s->n_out = 0;
+    s->n_frames++;
+    s->state = OFDM_SYNC_DATA;
+}
+
+int ofdm_sync_process(OfdmSync *s, const Cplx *in, int n, Cplx *out)
+{
+    PROF_BEGIN(ofdm_sync);
+    const OfdmParams *p = s->p;
+    int L = p->n_fft / 2, sym = p->n_fft + p->n_cp, n_sym = 0;
+    int mask = s->mask;
+    Cplx *ring = s->ring;
+    Cplx P = s->P;
+    double R = s->R;
+    int64_t t = s->t;
+
+    for (int i = 0; i < n; i++, t++) {
+        Cplx x = in[i];
+        ring[t & mask] = x;
+        R += 0.5 * (x.re * x.re + x.im * x.im);
+        if (t >= L) {
+            Cplx mid = ring[(t - L) & mask];
+            P = cadd(P, cmul(cconj(mid), x));
+            if (t >= 2 * L) {
+                Cplx old = ring[(t - 2 * L) & mask];
+                P = csub(P, cmul(cconj(old), mid));
+                R -= 0.5 * (old.re * old.re + old.im * old.im);
+            }
+        }
+
+        /* Re-sum once per ring cycle so rounding cannot accumulate */
+        if ((t & mask) == mask && t >= 2 * L) {
+            P = cmk(0, 0);
+            R = 0;
+            for (int64_t m = t - L + 1; m <= t; m++) {
+                Cplx a = ring[(m - L) & mask], b = ring[m & mask];
+                P = cadd(P, cmul(cconj(a), b));
+                R += 0.5 * (a.re * a.re + a.im * a.im + b.re * b.re +
+                            b.im * b.im);
+            }
+        }
+
+        if (s->state == OFDM_SYNC_SEARCH) {
+            if (t < 2 * L - 1) continue;
+            double pm = P.re * P.re + P.im * P.im, rr = R * R;
+            if (s->m_len == 0) {
+                if (!(pm > s->threshold * rr)) continue;
+                s->m_d0 = t - 2 * L + 1;
+                s->m_max = 0;
+            }
+            double m = rr > 0 ? pm / rr : 0.0;
+            s->m_buf[s->m_len++] = (real_t)m;
+            if (m > s->m_max) { s->m_max = m; s->p_max = P; }
+            if (m < 0.5 * s->m_max || s->m_len == sym)
+                sync_plateau_done(s);
+        }
+        if (s->state == OFDM_SYNC_TRAINING &&
+            t >= s->t1 + 2 * p->n_fft + p->n_cp - 1)
+            sync_integer_cfo(s);
+        while (s->state == OFDM_SYNC_DATA && t >= s->next + sym - 1) {
+            sync_fetch(s, s->next, sym, out + (size_t)n_sym * sym);
+            n_sym++;
+            s->next += sym;
+            if (++s->n_out == s->frame_syms) s->state = OFDM_SYNC_SEARCH;
+        }
+    }
+    s->P = P;
+    s->R = R;
+    s->t = t;
+    PROF_END(ofdm_sync, n);
+    return n_sym;
+}
@@ -90,10 +90,36 @@ void wifi_scramble(uint8_t init, uint8_t *data, int nbits)
     }
 }
 
+/* RATE field → constellation and punctured code rate (Table 17-4) */
+static int wifi_rate_params(WifiRate rate, ModScheme *mod, ConvRate *code)
+{
+    static const struct { WifiRate rate; ModScheme mod; ConvRate code; }
+    tab[] = {
+        { WIFI_RATE_6,  MOD_BPSK,  CONV_RATE_1_2 },
+        { WIFI_RATE_9,  MOD_BPSK,  CONV_RATE_3_4 },
+        { WIFI_RATE_12, MOD_QPSK,  CONV_RATE_1_2 },
+        { WIFI_RATE_18, MOD_QPSK,  CONV_RATE_3_4 },
+        { WIFI_RATE_24, MOD_16QAM, CONV_RATE_1_2 },
+        { WIFI_RATE_36, MOD_16QAM, CONV_RATE_3_4 },
+        { WIFI_RATE_48, MOD_64QAM, CONV_RATE_2_3 },
+        { WIFI_RATE_54, MOD_64QAM, CONV_RATE_3_4 },
+    };
+    for (int i = 0; i < (int)(sizeof(tab) / sizeof(tab[0])); i++) {
+        if (tab[i].rate == rate) {
+            *mod = tab[i].mod;
+            *code = tab[i].code;
+            return 0;
+        }
+    }
+    return -1;
+}
+
 int wifi_build_ppdu(const uint8_t *payload, int n_bytes, WifiRate rate,
                     Cplx *out)
 {
-    (void)rate; /* TODO: use rate to select modulation/coding */
+    ModScheme mod;
+    ConvRate code;
+    if (wifi_rate_params(rate, &mod, &code) < 0) return -1;
     int pos = 0;
 
     /* 1. Short training sequence (160 samples) */
@@ -110,28 +136,34 @@ int wifi_build_ppdu(const uint8_t *payload, int n_bytes, WifiRate rate,
     memcpy(out + pos, lts, lts_len * sizeof(Cplx));
     pos += lts_len;
 
-    /* 3. SIGNAL + DATA using OFDM (simplified) */
+    /* 3. DATA using OFDM (simplified: no SIGNAL symbol or interleaver) */
     OfdmParams ofdm;
     ofdm_init(&ofdm, 64, 16, 4);
 
-    /* Convert payload to bits */
-    int nbits = n_bytes * 8;
-    uint8_t *bits = (uint8_t *)calloc(nbits + 128, sizeof(uint8_t));
-    bits_from_bytes(payload, n_bytes, bits);
+    /* SERVICE (16 zero bits) + PSDU, scrambled, then 6 zero tail bits */
+    int nbits = 16 + n_bytes * 8 + 6;
+    uint8_t *bits = (uint8_t *)calloc(nbits, sizeof(uint8_t));
+    bits_from_bytes(payload, n_bytes, bits + 16);
+    wifi_scramble(0x5D, bits, nbits - 6);
+
+    /* Convolutional code at the RATE's puncturing, padded with zero bits
+     * to whole OFDM symbols */
+    int bps = mod_bits_per_symbol(mod);
+    int n_cbps = ofdm.n_data * bps;
+    int n_coded = conv_punctured_len(code, 2 * nbits);
+    int nsyms = (n_coded + n_cbps - 1) / n_cbps;
+    uint8_t *coded = (uint8_t *)calloc(nsyms * n_cbps, sizeof(uint8_t));
+    conv_encode_punctured(code, bits, nbits, coded);
 
-    /* Map to BPSK symbols (rate 6 Mbps baseline) */
-    int nsyms = (nbits + ofdm.n_data - 1) / ofdm.n_data;
     Cplx *data_syms = (Cplx *)calloc(nsyms * ofdm.n_data, sizeof(Cplx));
-    for (int i = 0; i < nsyms * ofdm.n_data; i++) {
-        int bit = (i < nbits) ? bits[i] : 0;
-        data_syms[i] = bit ? cplx(-1, 0) : cplx(1, 0);
-    }
+    mod_modulate(mod, coded, nsyms * n_cbps, data_syms);
 
     /* OFDM modulate */
     int ofdm_samples = ofdm_modulate_block(&ofdm, nsyms, data_syms, out + pos);
     pos += ofdm_samples;
 
     free(bits);
+    free(coded);
     free(data_syms);
     return pos;
 }
@@ -267,6 +299,7 @@ void lora_init(LoraParams *lp, int sf, int bw, int cr)
     lp->cr = cr;
     lp->n_fft = 1 << sf;
     lp->fs = bw; /* baseband sample rate = BW */
+    lp->plan = fft_plan_get(lp->n_fft);
 }
 
 void lora_modulate_symbol(const LoraParams *lp, int symbol, Cplx *out)
@@ -295,33 +328,37 @@ int lora_preamble(const LoraParams *lp, int n_pre, Cplx *out)
         pos += N;
     }
 
-    /* 2 downchirps (sync) — conjugate of upchirp */
-    Cplx *upchirp = (Cplx *)malloc(N * sizeof(Cplx));
-    lora_modulate_symbol(lp, 0, upchirp);
-    for (int d = 0; d < 2; d++) {
-        for (int i = 0; i < N; i++)
-            out[pos + i] = cplx_conj(upchirp[i]);
-        pos += N;
-    }
+    /* 2 downchirps (sync) — conjugate of upchirp, built in place */
+    Cplx *down = out + pos;
+    lora_modulate_symbol(lp, 0, down);
+    for (int i = 0; i < N; i++)
+        down[i] = cplx_conj(down[i]);
+    memcpy(down + N, down, N * sizeof(Cplx));
+    pos += 2 * N;
 
-    free(upchirp);
     return pos;
 }
 
 int lora_demodulate_symbol(const LoraParams *lp, const Cplx *in)
+{
+    return lora_demodulate_symbol_ws(lp, in, NULL);
+}
+
+int lora_demodulate_symbol_ws(const LoraParams *lp, const Cplx *in,
+                              CommsArena *ws)
 {
     int N = lp->n_fft;
 
-    /* Dechirp: multiply by conjugate of base upchirp */
-    Cplx *dechirped = (Cplx *)calloc(N, sizeof(Cplx));
-    Cplx *base = (Cplx *)calloc(N, sizeof(Cplx));
-    lora_modulate_symbol(lp, 0, base);
+    /* Dechirp: multiply by conjugate of base upchirp (one buffer) */
+    Cplx *dechirped = (Cplx *)arena_scratch(ws, N * sizeof(Cplx));
+    lora_modulate_symbol(lp, 0, dechirped);
 
     for (int i = 0; i < N; i++)
-        dechirped[i] = cplx_mul(in[i], cplx_conj(base[i]));
+        dechirped[i] = cplx_mul(in[i], cplx_conj(dechirped[i]));
 
     /* FFT and find peak */
-    fft(dechirped, N);
+    if (lp->plan) fft_execute(lp->plan, dechirped, dechirped);
+    else          fft(dechirped, N);
 
     double max_mag = 0;
     int max_idx = 0;
@@ -333,8 +370,7 @@ int lora_demodulate_symbol(const LoraParams *lp, const Cplx *in)
         }
     }
 
-    free(dechirped);
-    free(base);
+    arena_scratch_free(ws, dechirped);
     return max_idx;
 }
 
@@ -394,12 +430,18 @@ void adsb_encode(const AdsbMessage *msg, uint8_t *bits112)
 
 uint32_t adsb_crc24(const uint8_t *bits, int nbits)
 {
-    int nbytes = (nbits + 7) / 8;
-    uint8_t *bytes = (uint8_t *)calloc(nbytes, sizeof(uint8_t));
-    bytes_from_bits(bits, nbits, bytes);
-    uint32_t crc = crc24_adsb(bytes, nbytes);
-    free(bytes);
-    return crc;
+    /* crc24_adsb() over the zero-padded byte stream, packed a stack
+     * block at a time so no copy of the message is allocated. */
+    enum { BLK = 256 };
+    CrcCtx c;
+    uint8_t buf[BLK / 8];
+    crc_init(&c, CRC_24_ADSB);
+    for (int i = 0; i < nbits; i += BLK) {
+        int nb = nbits - i < BLK ? nbits - i : BLK;
+        bytes_from_bits(bits + i, nb, buf);
+        crc_update(&c, buf, (nb + 7) / 8);
+    }
+    return crc_finalize(&c);
 }
 
 int adsb_modulate(const uint8_t *bits112, double *out)
@@ -0,0 +1,214 @@
+/**
+ * @file profile.c
+ * @brief Hot-path instrumentation — counters, report, Chrome trace export.
+ *
+ * TUTORIAL CROSS-REFERENCES:
+ *   Performance notes    → reference/API.md (§ profile.h)
+ *
+ * References:
+ *   Trace Event Format (Chromium project), "X" complete events.
+ *   Intel SDM Vol. 3B §18.17, Time-Stamp Counter.
+ */
+#define _POSIX_C_SOURCE 200112L   /* clock_gettime, pthreads */
+
+#include "../include/profile.h"
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROF_HAVE_TSC 1
+#endif
+
+#if defined(COMMS_PROFILE) || !defined(PROF_HAVE_TSC)
+static uint64_t clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+uint64_t prof_ticks(void)
+{
+#ifdef PROF_HAVE_TSC
+    return __rdtsc();
+#else
+    return clock_ns();
+#endif
+}
+
+#ifdef COMMS_PROFILE
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Counters and trace buffer
+ * ════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    const ProfSite *site;
+    uint64_t        t0, t1;
+} ProfEvent;
+
+/* Instrumented functions run on pool workers too: sites register once
+ * under site_lock, counters are atomic adds and each trace event owns
+ * the slot its fetch-add reserved.  n_events keeps counting past
+ * PROF_TRACE_MAX; readers clamp it. */
+static pthread_mutex_t site_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfSite  *site_list;
+static ProfEvent  events[PROF_TRACE_MAX];
+static uint64_t   n_events;
+
+/* Tick/ns reference point, taken on the first instrumented call */
+static uint64_t   epoch_ticks, epoch_ns;
+
+static int trace_len(void)
+{
+    uint64_t n = __atomic_load_n(&n_events, __ATOMIC_ACQUIRE);
+    return n < PROF_TRACE_MAX ? (int)n : PROF_TRACE_MAX;
+}
+
+uint64_t prof_begin(ProfSite *site)
+{
+    if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&site_lock);
+        if (!site->registered) {
+            site->next = site_list;
+            site_list = site;
+            if (!epoch_ns) {
+                epoch_ns = clock_ns();
+                epoch_ticks = prof_ticks();
+            }
+            __atomic_store_n(&site->registered, 1, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_unlock(&site_lock);
+    }
+    return prof_ticks();
+}
+
+void prof_end(ProfSite *site, uint64_t t0, long samples)
+{
+    uint64_t t1 = prof_ticks();
+    __atomic_fetch_add(&site->calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&site->ticks, t1 - t0, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&site->samples, (uint64_t)samples, __ATOMIC_RELAXED);
+    uint64_t i = __atomic_fetch_add(&n_events, 1, __ATOMIC_RELAXED);
+    if (i < PROF_TRACE_MAX) {
+        events[i].site = site;
+        events[i].t0 = t0;
+        events[i].t1 = t1;
+    }
+}
+
+/* Ticks per nanosecond, measured against CLOCK_MONOTONIC since the
+ * epoch (exactly 1 when ticks are already nanoseconds). */
+static double ticks_per_ns(void)
+{
+#ifdef PROF_HAVE_TSC
+    uint64_t dn = clock_ns() - epoch_ns;
+    uint64_t dt = prof_ticks() - epoch_ticks;
+    return (dn > 0 && dt > 0) ? (double)dt / (double)dn : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+/* ════════════════════════════════════════════════════════════════════
+ *  Output
+ * ════════════════════════════════════════════════════════════════════ */
+
+void prof_report(FILE *fp)
+{
+    double tpn = ticks_per_ns();
+    pthread_mutex_lock(&site_lock);
+    fprintf(fp, "\n%-22s %10s %12s %12s %12s %10s\n", "function", "calls",
+            "ticks", "total ms", "us/call", "Msamp/s");
+    for (const ProfSite *s = site_list; s; s = s->next) {
+        if (!s->calls) continue;
+        double ms = s->ticks / tpn / 1e6;
+        fprintf(fp, "%-22s %10llu %12llu %12.3f %12.3f %10.2f\n", s->name,
+                (unsigned long long)s->calls, (unsigned long long)s->ticks,
+                ms, ms * 1e3 / s->calls,
+                ms > 0 ? s->samples / (ms * 1e3) : 0.0);
+    }
+    pthread_mutex_unlock(&site_lock);
+    if (trace_len() == PROF_TRACE_MAX)
+        fprintf(fp, "(trace buffer full: first %d calls recorded)\n",
+                PROF_TRACE_MAX);
+}
+
+int prof_write_trace(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+
+    double tpn = ticks_per_ns();
+    int n = trace_len();
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (int i = 0; i < n; i++) {
+        const ProfEvent *e = &events[i];
+        fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                    "\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                e->site->name, (double)(e->t0 - epoch_ticks) / tpn / 1e3,
+                (double)(e->t1 - e->t0) / tpn / 1e3,
+                i + 1 < n ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ns\"}\n");
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+void prof_reset(void)
+{
+    pthread_mutex_lock(&site_lock);
+    for (ProfSite *s = site_list; s; s = s->next) {
+        __atomic_store_n(&s->calls, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->ticks, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->samples, 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&n_events, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&site_lock);
+}
+
+const ProfSite *prof_find(const char *name)
+{
+    const ProfSite *found = NULL;
+    pthread_mutex_lock(&site_lock);
+    for (const ProfSite *s = site_list; s && !found; s = s->next)
+        if (strcmp(s->name, name) == 0) found = s;
+    pthread_mutex_unlock(&site_lock);
+    return found;
+}
+
+#else /* !COMMS_PROFILE */
+
+uint64_t prof_begin(ProfSite *site)
+{
+    (void)site;
+    return 0;
+}
+
+void prof_end(ProfSite *site, uint64_t t0, long samples)
+{
+    (void)site; (void)t0; (void)samples;
+}
+
+void prof_report(FILE *fp)
+{
+    fprintf(fp, "profiling disabled (rebuild with -DCOMMS_PROFILE)\n");
+}
+
+int prof_write_trace(const char *path)
+{
+    (void)path;
+    return -1;
+}
+
+void prof_reset(void) {}
+
+const ProfSite *prof_find(const char *name)
+{
+    (void)name;
+    return NULL;
+}
+
+#endif /* COMMS_PROFILE */
@@ -220,9 +220,9 @@ double carrier_pll(CarrierSync *cs, const Cplx *in, int n,
  *  Frame synchronisation
  * ════════════════════════════════════════════════════════════════════ */
 
-int frame_sync_correlate(const double *signal, int sig_len,
+int frame_sync_correlate(const real_t *signal, int sig_len,
                          const int *preamble, int pre_len,
-                         double *corr)
+                         real_t *corr)
 {
     int n_corr = sig_len - pre_len + 1;
     double peak = 0;
@@ -241,7 +241,7 @@ int frame_sync_correlate(const double *signal, int sig_len,
     return peak_idx;
 }
 
-int frame_sync_detect(const double *signal, int sig_len,
+int frame_sync_detect(const real_t *signal, int sig_len,
                       const int *preamble, int pre_len,
                       double threshold)
 {
@@ -281,3 +281,48 @@ void scrambler(uint16_t poly, uint16_t init, uint8_t *bits, int n)
         lfsr = (lfsr << 1) | fb;
     }
 }
+
+/* Run the LFSR 8 steps from `state`: keystream byte (first bit in the
+ * MSB) in bits 16..23, next state in bits 0..15. */
+static uint32_t scrambler_step8(uint16_t poly, uint16_t state)
+{
+    uint32_t ks = 0;
+    for (int i = 0; i < 8; i++) {
+        uint16_t tmp = state & poly, fb = 0;
+        while (tmp) { fb ^= tmp & 1; tmp >>= 1; }
+        ks = (ks << 1) | fb;
+        state = (uint16_t)((state << 1) | fb);
+    }
+    return (ks << 16) | state;
+}
+
+void scrambler_packed(uint16_t poly, uint16_t init, BitVec *bits)
+{
+    /* step8() is linear over GF(2), so split the state into bytes:
+     * step8(s) = lo[s & 0xff] ^ hi[s >> 8]. */
+    uint32_t lo[256], hi[256];
+    lo[0] = hi[0] = 0;
+    for (int b = 0; b < 8; b++) {
+        uint32_t lb = scrambler_step8(poly, (uint16_t)(1u << b));
+        uint32_t hb = scrambler_step8(poly, (uint16_t)(1u << (b + 8)));
+        for (int j = 0; j < (1 << b); j++) {
+            lo[(1 << b) | j] = lo[j] ^ lb;
+            hi[(1 << b) | j] = hi[j] ^ hb;
+        }
+    }
+
+    uint16_t lfsr = init;
+    int n_words = BITVEC_WORDS(bits->n);
+    for (int k = 0; k < n_words; k++) {
+        uint64_t ks = 0;
+        for (int byte = 0; byte < 8; byte++) {
+            uint32_t r = lo[lfsr & 0xff] ^ hi[lfsr >> 8];
+            ks = (ks << 8) | (r >> 16);
+            lfsr = (uint16_t)r;
+        }
+        bits->w[k] ^= ks;
+    }
+
+    int rem = bits->n & 63;
+    if (rem) bits->w[n_words - 1] &= ~0ULL << (64 - rem);
+}
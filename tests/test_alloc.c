@@ -0,0 +1,162 @@
+/**
+ * @file test_alloc.c
+ * @brief Heap-traffic tests: steady-state receive paths must not allocate.
+ *
+ * Linked with -Wl,--wrap=malloc,... so every heap call made by the
+ * library objects goes through the counters below.
+ *
+ * Run with: make test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_framework.h"
+#include "../include/comms_utils.h"
+#include "../include/modulation.h"
+#include "../include/ofdm.h"
+#include "../include/equaliser.h"
+#include "../include/phy.h"
+
+/* ── malloc counting via the linker's --wrap ─────────────────────── */
+
+static long heap_calls;
+
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t sz);
+void *__real_realloc(void *p, size_t n);
+void  __real_free(void *p);
+
+void *__wrap_malloc(size_t n)             { heap_calls++; return __real_malloc(n); }
+void *__wrap_calloc(size_t n, size_t sz)  { heap_calls++; return __real_calloc(n, sz); }
+void *__wrap_realloc(void *p, size_t n)   { heap_calls++; return __real_realloc(p, n); }
+void  __wrap_free(void *p)                { if (p) heap_calls++; __real_free(p); }
+
+int main(void)
+{
+    TEST_SUITE("Allocation-Free Hot Paths");
+    rng_seed(77);
+
+    /* ── Test 1: Arena alignment, exhaustion and LIFO release ── */
+    TEST_CASE_BEGIN("CommsArena aligns, reports exhaustion, releases LIFO")
+    {
+        CommsArena a;
+        int ok = arena_init(&a, 1000) == 0;
+        void *p1 = arena_alloc(&a, 10);
+        void *p2 = arena_alloc(&a, 100);
+        ok = ok && p1 && p2 &&
+             ((uintptr_t)p1 % ARENA_ALIGN) == 0 &&
+             ((uintptr_t)p2 % ARENA_ALIGN) == 0 &&
+             (uint8_t *)p2 - (uint8_t *)p1 == ARENA_ALIGN;
+        ok = ok && arena_alloc(&a, 4096) == NULL;
+
+        /* Scratch falls back to the heap when the arena is full */
+        long before = heap_calls;
+        void *big = arena_scratch(&a, 4096);
+        arena_scratch_free(&a, big);
+        ok = ok && big && heap_calls == before + 2;
+
+        arena_scratch_free(&a, p2);
+        ok = ok && arena_alloc(&a, 1) == p2;
+        arena_reset(&a);
+        ok = ok && a.used == 0;
+        arena_free(&a);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Arena bookkeeping wrong"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 2: _ws variants match the heap versions ────────── */
+    TEST_CASE_BEGIN("ofdm/lora/oqpsk _ws variants match heap versions")
+    {
+        CommsArena ws;
+        arena_init(&ws, 1 << 20);
+
+        OfdmParams p;
+        ofdm_init(&p, 64, 16, 4);
+        Cplx data[OFDM_MAX_CARRIERS], d1[OFDM_MAX_CARRIERS],
+             d2[OFDM_MAX_CARRIERS], td[80];
+        uint8_t bits[2 * OFDM_MAX_CARRIERS];
+        random_bits(bits, 2 * p.n_data);
+        mod_modulate(MOD_QPSK, bits, 2 * p.n_data, data);
+        ofdm_modulate(&p, data, td);
+        ofdm_demodulate(&p, td, d1, NULL);
+        ofdm_demodulate_ws(&p, td, d2, NULL, &ws);
+        int ok = memcmp(d1, d2, p.n_data * sizeof(Cplx)) == 0;
+
+        LoraParams lp;
+        lora_init(&lp, 7, 125000, 1);
+        static Cplx chirp[128];
+        lora_modulate_symbol(&lp, 93, chirp);
+        ok = ok && lora_demodulate_symbol(&lp, chirp) == 93 &&
+             lora_demodulate_symbol_ws(&lp, chirp, &ws) == 93;
+
+        Cplx o1[9 * 4], o2[9 * 4];
+        oqpsk_modulate(bits, 16, 4, o1);
+        oqpsk_modulate_ws(bits, 16, 4, o2, &ws);
+        ok = ok && memcmp(o1, o2, sizeof(o1)) == 0 && ws.used == 0;
+
+        arena_free(&ws);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Workspace variant output differs"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: Steady-state loop makes zero heap calls ─────── */
+    TEST_CASE_BEGIN("Steady-state TX/RX loop makes zero heap calls")
+    {
+        enum { SPS = 4, SPAN = 6, NSYM = 32 };
+        CommsArena ws;
+        arena_init(&ws, 1 << 20);
+
+        OfdmParams p;
+        ofdm_init(&p, 64, 16, 4);
+        LoraParams lp;
+        lora_init(&lp, 8, 125000, 1);
+        RlsEqualiser rls;
+        eq_rls_init(&rls, 5, 0.99, 100.0);
+
+        static Cplx data[OFDM_MAX_CARRIERS], eq_out[OFDM_MAX_CARRIERS],
+                    td[80], chirp[256], gfsk[NSYM * SPS], oq[(NSYM / 2 + 1) * SPS];
+        static real_t h[SPAN * SPS + 1], syms[NSYM],
+                      shaped[NSYM * SPS + SPAN * SPS], filt[1024];
+        static uint8_t bits[2 * OFDM_MAX_CARRIERS], adsb[112];
+        int hlen = root_raised_cosine(0.35, SPS, SPAN, h);
+        FastConv fc;
+        fastconv_init_real(&fc, h, hlen, 0);
+        random_bits(bits, 2 * p.n_data);
+        mod_modulate(MOD_QPSK, bits, 2 * p.n_data, data);
+        nrz_encode(bits, NSYM, syms);
+        lora_modulate_symbol(&lp, 200, chirp);
+        memcpy(adsb, bits, 112);
+
+        heap_calls = 0;
+        int ok = 1;
+        for (int it = 0; it < 20; it++) {
+            ofdm_modulate(&p, data, td);
+            ofdm_demodulate_ws(&p, td, eq_out, NULL, &ws);
+            if (lora_demodulate_symbol_ws(&lp, chirp, &ws) != 200) ok = 0;
+            for (int i = 0; i < p.n_data; i++)
+                eq_rls_step(&rls, eq_out[i], data[i], NULL);
+            pulse_shape(syms, NSYM, h, hlen, SPS, shaped);
+            gfsk_modulate(bits, NSYM, SPS, 0.5, 0.32, gfsk);
+            oqpsk_modulate_ws(bits, NSYM, SPS, oq, &ws);
+            adsb_crc24(adsb, 112);
+            int nf = fastconv_process_real(&fc, shaped, NSYM * SPS, filt);
+            fastconv_flush_real(&fc, filt + nf);
+        }
+        long calls = heap_calls;
+
+        eq_rls_free(&rls);
+        fastconv_free(&fc);
+        arena_free(&ws);
+        if (ok && calls == 0) { TEST_PASS_STMT; }
+        else {
+            printf("(%ld heap calls) ", calls);
+            TEST_FAIL_STMT("Hot path touched the heap");
+        }
+    }
+    TEST_CASE_END();
+
+    TEST_SUMMARY();
+}
@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include "test_framework.h"
 #include "../include/comms_utils.h"
@@ -163,5 +164,274 @@ int main(void)
     }
     TEST_CASE_END();
 
+    /* ── Test 9: Packed encoder and interleaver ──────────────── */
+    TEST_CASE_BEGIN("conv_encode_packed / interleaver_*_packed match unpacked")
+    {
+        enum { N = 301 };
+        uint8_t info[N], coded[2 * N], out[2 * N];
+        BitVec vin, vcoded, vitl, vback;
+        bitvec_init(&vin, N);
+        bitvec_init(&vcoded, 2 * N);
+        bitvec_init(&vitl, 2 * N);
+        bitvec_init(&vback, 2 * N);
+
+        random_bits(info, N);
+        conv_encode(info, N, coded);
+        bitvec_from_bits(&vin, info, N);
+        conv_encode_packed(&vin, &vcoded);
+        bitvec_to_bits(&vcoded, out);
+        int ok = vcoded.n == 2 * N && memcmp(coded, out, 2 * N) == 0;
+
+        Interleaver itl;
+        interleaver_init(&itl, 20, 30);
+        interleaver_apply(&itl, coded, out, 2 * N);
+        interleaver_apply_packed(&itl, &vcoded, &vitl);
+        for (int i = 0; i < 600 && ok; i++)
+            if (bitvec_get(&vitl, i) != out[i]) ok = 0;
+        interleaver_deapply_packed(&itl, &vitl, &vback);
+        for (int i = 0; i < 600 && ok; i++)
+            if (bitvec_get(&vback, i) != coded[i]) ok = 0;
+        interleaver_free(&itl);
+
+        /* A short input still fills a whole block, so out needs the
+         * full rows·cols capacity */
+        enum { SHORT = 10, BLOCK = 8 * 16 };
+        uint8_t sbits[BLOCK] = { 0 }, sref[BLOCK] = { 0 };
+        BitVec vshort, vsmall, vblock;
+        bitvec_init(&vshort, SHORT);
+        bitvec_init(&vsmall, SHORT);
+        bitvec_init(&vblock, BLOCK);
+        random_bits(sbits, SHORT);
+        bitvec_from_bits(&vshort, sbits, SHORT);
+        interleaver_init(&itl, 8, 16);
+        interleaver_apply(&itl, sbits, sref, SHORT);
+        ok = ok && interleaver_apply_packed(&itl, &vshort, &vsmall) == -1 &&
+             interleaver_apply_packed(&itl, &vshort, &vblock) == 0 &&
+             vblock.n == BLOCK;
+        for (int i = 0; i < BLOCK && ok; i++)
+            if (bitvec_get(&vblock, i) != sref[i]) ok = 0;
+        ok = ok && interleaver_deapply_packed(&itl, &vblock, &vback) == 0;
+        for (int i = 0; i < SHORT && ok; i++)
+            if (bitvec_get(&vback, i) != sbits[i]) ok = 0;
+        interleaver_free(&itl);
+
+        bitvec_free(&vin);
+        bitvec_free(&vcoded);
+        bitvec_free(&vitl);
+        bitvec_free(&vback);
+        bitvec_free(&vshort);
+        bitvec_free(&vsmall);
+        bitvec_free(&vblock);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Packed coding output differs"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 10: Streaming Viterbi on a long frame ──────────── */
+    TEST_CASE_BEGIN("Streaming Viterbi: any length, chunking-invariant")
+    {
+        enum { N = 20000 };
+        static uint8_t info[N], coded[2 * N], hard[2 * N];
+        static uint8_t d_frame[N], d_stream[N + 2 * VITERBI_DEPTH],
+                       d_hard[N + 2 * VITERBI_DEPTH];
+        static real_t llr[2 * N];
+        random_bits(info, N);
+        conv_encode(info, N, coded);
+        for (int i = 0; i < 2 * N; i++) {
+            llr[i] = (coded[i] ? -1.0 : 1.0) + 0.6 * rng_gaussian();
+            hard[i] = coded[i];
+        }
+
+        /* Whole-frame call no longer stops at 256 bits */
+        int ok = viterbi_decode_soft(llr, 2 * N, d_frame) == N;
+        int errs = 0;
+        for (int i = 0; i < N; i++) errs += d_frame[i] != info[i];
+        ok = ok && errs < 10;
+
+        /* Same bits fed in uneven (odd) chunks */
+        ViterbiDecoder v;
+        ok = viterbi_init(&v, 0) == 0 && ok && v.depth == VITERBI_DEPTH;
+        int m = 0;
+        for (int i = 0, c = 1; i < 2 * N; i += c, c = c * 7 % 997 + 1) {
+            if (c > 2 * N - i) c = 2 * N - i;
+            m += viterbi_process_soft(&v, llr + i, c, d_stream + m);
+        }
+        m += viterbi_flush(&v, d_stream + m);
+        ok = ok && m == N && memcmp(d_frame, d_stream, N) == 0;
+
+        /* Hard input, short depth, error-free channel: exact */
+        viterbi_free(&v);
+        ok = viterbi_init(&v, 40) == 0 && ok;
+        m = 0;
+        for (int i = 0; i < 2 * N; i += 333) {
+            int c = 2 * N - i < 333 ? 2 * N - i : 333;
+            m += viterbi_process(&v, hard + i, c, d_hard + m);
+        }
+        m += viterbi_flush(&v, d_hard + m);
+        ok = ok && m == N && memcmp(d_hard, info, N) == 0 &&
+             v.t == 0;
+        viterbi_free(&v);
+        if (!ok) printf("(errs=%d) ", errs);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Streaming Viterbi differs"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 11: Byte-table encoder ─────────────────────────── */
+    TEST_CASE_BEGIN("conv_encode_bytes matches bitwise encoder across calls")
+    {
+        enum { NB = 157 };
+        uint8_t bytes[NB], info[8 * NB], coded[16 * NB], out[2 * NB];
+        for (int i = 0; i < NB; i++) bytes[i] = (uint8_t)(rng_uniform() * 256);
+        bits_from_bytes(bytes, NB, info);
+        conv_encode(info, 8 * NB, coded);
+
+        /* Split the stream unevenly, carrying the state */
+        unsigned int state = 0;
+        for (int i = 0; i < NB; i += 13) {
+            int c = NB - i < 13 ? NB - i : 13;
+            state = conv_encode_bytes(state, bytes + i, c, out + 2 * i);
+        }
+        int ok = 1;
+        for (int i = 0; i < 16 * NB && ok; i++)
+            ok = ((out[i >> 3] >> (7 - (i & 7))) & 1) == coded[i];
+
+        /* Branch table against the generator polynomials directly */
+        const uint8_t *br = conv_branch_table();
+        for (unsigned int r = 0; r < 2 * CONV_STATES && ok; r++)
+            ok = br[r] == ((__builtin_popcount(r & CONV_G0) & 1) << 1 |
+                           (__builtin_popcount(r & CONV_G1) & 1));
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Byte-table encoder output differs"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 12: Punctured rates ────────────────────────────── */
+    TEST_CASE_BEGIN("Punctured 2/3, 3/4, 5/6: lengths, erasures, decode")
+    {
+        enum { N = 1003 };
+        static const int keep_num[] = { 1, 3, 2, 3 };
+        static const int keep_den[] = { 1, 4, 3, 5 };
+        static uint8_t info[N], mother[2 * N], tx[2 * N], tx2[2 * N],
+                       dec[N], dref[N];
+        static real_t llr[2 * N], dep[2 * N + 2];
+        random_bits(info, N);
+        conv_encode(info, N, mother);
+        int ok = 1;
+        for (int r = CONV_RATE_1_2; r < CONV_N_RATES && ok; r++) {
+            int n = conv_encode_punctured((ConvRate)r, info, N, tx);
+            int m = conv_puncture((ConvRate)r, mother, 2 * N, tx2);
+            ok = n == m && memcmp(tx, tx2, n) == 0 &&
+                 n == conv_punctured_len((ConvRate)r, 2 * N) &&
+                 abs(n * keep_den[r] - 2 * N * keep_num[r]) < keep_den[r] &&
+                 conv_depunctured_len((ConvRate)r, n) == 2 * N;
+
+            /* Erasures come back as zero LLRs, kept bits in place */
+            for (int i = 0; i < n; i++)
+                llr[i] = (tx[i] ? -1.0 : 1.0) + 0.3 * rng_gaussian();
+            ok = ok && conv_depuncture((ConvRate)r, llr, n, dep) == 2 * N;
+            int kept = 0;
+            for (int i = 0; i < 2 * N && ok; i++) {
+                if (dep[i] == 0.0) continue;
+                ok = mother[i] == tx[kept] && dep[i] == llr[kept];
+                kept++;
+            }
+            ok = ok && kept == n;
+
+            /* Same bits as the full-frame decoder on the depunctured
+             * frame, and error-free */
+            int d = viterbi_decode_punctured((ConvRate)r, llr, n, dec);
+            viterbi_decode_soft(dep, 2 * N, dref);
+            ok = ok && d == N && memcmp(dec, dref, N) == 0 &&
+                 memcmp(dec, info, N) == 0;
+            if (!ok) printf("(rate %d) ", r);
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Puncturing round trip failed"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 13: CRC engines ────────────────────────────────── */
+    TEST_CASE_BEGIN("CRC check values, streaming splits, crc32_combine")
+    {
+        /* Catalogue check values, and a real Mode-S frame whose last
+         * three bytes are the CRC of the first eleven */
+        const uint8_t *chk = (const uint8_t *)"123456789";
+        static const uint8_t adsb[14] = {
+            0x8D, 0x48, 0x40, 0xD6, 0x20, 0x2C, 0xC3,
+            0x71, 0xC3, 0x2C, 0xE0, 0x57, 0x60, 0x98
+        };
+        int ok = crc32(chk, 9) == 0xCBF43926u &&
+                 crc16_ccitt(chk, 9) == 0x29B1 &&
+                 crc24_adsb(adsb, 11) == 0x576098u;
+
+        /* Any split through the incremental API, and merged halves */
+        enum { NC = 1031 };
+        uint8_t data[NC];
+        for (int i = 0; i < NC; i++) data[i] = (uint8_t)(rng_uniform() * 256);
+        uint32_t whole[CRC_N_KINDS] = {
+            crc16_ccitt(data, NC), crc32(data, NC), crc24_adsb(data, NC)
+        };
+        for (int k = 0; k < CRC_N_KINDS && ok; k++) {
+            CrcCtx c;
+            crc_init(&c, (CrcKind)k);
+            for (int i = 0, step = 1; i < NC; step = step * 3 % 23 + 1) {
+                crc_update(&c, data + i, NC - i < step ? NC - i : step);
+                i += step;
+            }
+            ok = crc_finalize(&c) == whole[k];
+        }
+        for (int cut = 0; cut <= NC && ok; cut += 103)
+            ok = crc32_combine(crc32(data, cut), crc32(data + cut, NC - cut),
+                               NC - cut) == whole[CRC_32];
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("CRC value or split mismatch"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 14: Canonical, length-limited Huffman ──────────── */
+    TEST_CASE_BEGIN("Huffman: canonical, length-limited, table decode")
+    {
+        /* Geometric source: unlimited Huffman would need 39 bits */
+        enum { NS = 40, NM = 5000 };
+        static HuffmanTable ht;
+        double probs[NS], kraft = 0;
+        for (int i = 0; i < NS; i++) probs[i] = ldexp(1.0, -(i + 1));
+        int ok = huffman_build(probs, NS, &ht) == 0 &&
+                 ht.max_len == HUFFMAN_MAX_CODELEN;
+        for (int i = 0; i < NS && ok; i++) {
+            kraft += ldexp(1.0, -ht.lengths[i]);
+            /* Canonical: longer codes sort after shorter ones */
+            if (i > 0 && ht.lengths[i] == ht.lengths[i - 1])
+                ok = ht.codes[i] == ht.codes[i - 1] + 1;
+            else if (i > 0)
+                ok = ht.codes[i] >> (ht.lengths[i] - ht.lengths[i - 1]) >
+                     ht.codes[i - 1];
+        }
+        ok = ok && kraft == 1.0;
+
+        /* Round trips through both bit layouts, across subtables */
+        static uint8_t sym[NM], dec[NM], packed[NM * 2], bits[NM * 16];
+        for (int i = 0; i < NM; i++) sym[i] = (uint8_t)(i * 7 % NS);
+        int nb = huffman_encode_packed(&ht, sym, NM, packed, sizeof(packed));
+        ok = ok && nb > 0 &&
+             huffman_decode_packed(&ht, packed, nb, dec, NM) == NM &&
+             memcmp(sym, dec, NM) == 0;
+        ok = ok && huffman_encode(&ht, sym, NM, bits, sizeof(bits)) == nb &&
+             huffman_decode(&ht, bits, nb, dec, NM) == NM &&
+             memcmp(sym, dec, NM) == 0;
+        for (int i = 0; i < nb && ok; i++)
+            ok = ((packed[i >> 3] >> (7 - (i & 7))) & 1) == bits[i];
+
+        /* Zero-probability symbols have no code */
+        double p3[3] = { 0.5, 0.0, 0.5 };
+        uint8_t bad = 1;
+        ok = ok && huffman_build(p3, 3, &ht) == 0 && ht.lengths[1] == 0 &&
+             huffman_encode_packed(&ht, &bad, 1, packed, 4) == -1;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Huffman code or round trip wrong"); }
+    }
+    TEST_CASE_END();
+
     TEST_SUMMARY();
 }
@@ -0,0 +1,258 @@
+/**
+ * @file test_comms_utils.c
+ * @brief Unit tests for core utilities (PRNG, bit helpers).
+ *
+ * Run with: make test
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "test_framework.h"
+#include "../include/comms_utils.h"
+#include "../include/channel.h"
+
+int main(void)
+{
+    TEST_SUITE("Core Utilities");
+    rng_seed(1);
+
+    /* ── Test 1: Reentrant state matches global stream ───────── */
+    TEST_CASE_BEGIN("RngState reproduces the global generator")
+    {
+        RngState rng;
+        rng_state_seed(&rng, 42);
+        rng_seed(42);
+
+        int ok = 1;
+        for (int i = 0; i < 1000 && ok; i++) {
+            if (rng_uniform_r(&rng) != rng_uniform()) ok = 0;
+            if (rng_gaussian_r(&rng) != rng_gaussian()) ok = 0;
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Reentrant stream differs from global"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 2: Independent states do not interfere ─────────── */
+    TEST_CASE_BEGIN("Interleaved RngStates stay independent")
+    {
+        RngState a, b, ref;
+        rng_state_seed(&a, 7);
+        rng_state_seed(&b, 8);
+        rng_state_seed(&ref, 7);
+
+        int ok = 1;
+        for (int i = 0; i < 256 && ok; i++) {
+            uint64_t va = rng_next_r(&a);
+            rng_next_r(&b);
+            if (va != rng_next_r(&ref)) ok = 0;
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("State b disturbed state a"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: Jump is deterministic and leaves the stream ─── */
+    TEST_CASE_BEGIN("rng_jump gives a deterministic, disjoint stream")
+    {
+        enum { N = 1024 };
+        static uint64_t base[N], jumped[N];
+        RngState s0, s1, s2;
+        rng_state_seed(&s0, 2024);
+        s1 = s0;
+        s2 = s0;
+        rng_jump(&s1);
+        rng_jump(&s2);
+
+        int ok = (memcmp(&s1, &s2, sizeof(s1)) == 0);
+        for (int i = 0; i < N; i++) {
+            base[i] = rng_next_r(&s0);
+            jumped[i] = rng_next_r(&s1);
+        }
+        for (int i = 0; i < N && ok; i++)
+            for (int j = 0; j < N; j++)
+                if (base[i] == jumped[j]) { ok = 0; break; }
+
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Jumped stream overlaps or is not repeatable"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 4: Long jump differs from jump ─────────────────── */
+    TEST_CASE_BEGIN("rng_long_jump differs from rng_jump")
+    {
+        RngState a, b;
+        rng_state_seed(&a, 5);
+        b = a;
+        rng_jump(&a);
+        rng_long_jump(&b);
+        if (memcmp(&a, &b, sizeof(a)) != 0) { TEST_PASS_STMT; }
+        else { TEST_FAIL_STMT("Jump and long jump landed on same state"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 5: random_bits_r is balanced and reproducible ──── */
+    TEST_CASE_BEGIN("random_bits_r matches random_bits, ~50% ones")
+    {
+        enum { N = 4096 };
+        uint8_t a[N], b[N];
+        RngState rng;
+        rng_state_seed(&rng, 99);
+        rng_seed(99);
+        random_bits_r(&rng, a, N);
+        random_bits(b, N);
+
+        int ones = 0;
+        for (int i = 0; i < N; i++) ones += a[i];
+        int ok = (memcmp(a, b, N) == 0) && abs(ones - N / 2) < 200;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("random_bits_r mismatch or biased"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 6: Reentrant AWGN is bit-reproducible ──────────── */
+    TEST_CASE_BEGIN("channel_awgn_r is bit-reproducible per stream")
+    {
+        enum { N = 256 };
+        Cplx tx[N], rx1[N], rx2[N];
+        for (int i = 0; i < N; i++) tx[i] = cplx(1.0, -1.0);
+
+        RngState r1, r2;
+        rng_state_seed(&r1, 3);
+        rng_state_seed(&r2, 3);
+        channel_awgn_r(&r1, tx, N, 10.0, rx1);
+        channel_awgn_r(&r2, tx, N, 10.0, rx2);
+
+        if (memcmp(rx1, rx2, sizeof(rx1)) == 0) { TEST_PASS_STMT; }
+        else { TEST_FAIL_STMT("Same seed produced different noise"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 7: Ziggurat bulk Gaussian moments ──────────────── */
+    TEST_CASE_BEGIN("rng_gaussian_fill: mean 0, var 1, kurtosis 3, tails")
+    {
+        enum { N = 200000 };
+        static double g[N];
+        RngState rng;
+        rng_state_seed(&rng, 11);
+        rng_gaussian_fill_r(&rng, g, N);
+
+        double m1 = 0, m2 = 0, m4 = 0;
+        int tail = 0;
+        for (int i = 0; i < N; i++) {
+            m1 += g[i];
+            m2 += g[i] * g[i];
+            m4 += g[i] * g[i] * g[i] * g[i];
+            if (fabs(g[i]) > 3.0) tail++;
+        }
+        m1 /= N; m2 /= N; m4 /= N;
+        double p_tail = (double)tail / N;   /* 2Q(3) = 0.0027 */
+
+        int ok = fabs(m1) < 0.01 && fabs(m2 - 1.0) < 0.02 &&
+                 fabs(m4 / (m2 * m2) - 3.0) < 0.1 &&
+                 p_tail > 0.0020 && p_tail < 0.0034;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Ziggurat output is not N(0,1)"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 8: CplxBuf kernels match Cplx reference ────────── */
+    TEST_CASE_BEGIN("CplxBuf mac/dot/mag2/rotate match Cplx arithmetic")
+    {
+        enum { N = 200 };
+        Cplx a[N], b[N], y[N];
+        CplxBuf A, B, Y;
+        cplxbuf_alloc(&A, N);
+        cplxbuf_alloc(&B, N);
+        cplxbuf_alloc(&Y, N);
+        for (int i = 0; i < N; i++) {
+            a[i] = cplx(rng_gaussian(), rng_gaussian());
+            b[i] = cplx(rng_gaussian(), rng_gaussian());
+            y[i] = cplx(rng_gaussian(), rng_gaussian());
+        }
+        cplxbuf_from_cplx(&A, a, N);
+        cplxbuf_from_cplx(&B, b, N);
+        cplxbuf_from_cplx(&Y, y, N);
+
+        double err = 0;
+        Cplx dot_ref = cplx(0, 0);
+        for (int i = 0; i < N; i++) {
+            dot_ref = cplx_add(dot_ref, cplx_mul(a[i], b[i]));
+            y[i] = cplx_add(y[i], cplx_mul(a[i], b[i]));
+        }
+        err += cplx_mag2(cplx_sub(cplxbuf_dot(&A, &B, N), dot_ref));
+
+        cplxbuf_mac(&Y, &A, &B, N);
+        Cplx yo[N];
+        cplxbuf_to_cplx(&Y, yo, N);
+        for (int i = 0; i < N; i++)
+            err += cplx_mag2(cplx_sub(yo[i], y[i]));
+
+        double m2[N];
+        cplxbuf_mag2(&A, m2, N);
+        for (int i = 0; i < N; i++)
+            err += fabs(m2[i] - cplx_mag2(a[i]));
+
+        /* Rotate in two chunks to check phasor continuation */
+        double dphi = 0.37;
+        Cplx ph = cplxbuf_rotate(&A, 77, cplx(1, 0), cplx_exp_j(dphi));
+        CplxBuf tail = { A.re + 77, A.im + 77, N - 77 };
+        cplxbuf_rotate(&tail, N - 77, ph, cplx_exp_j(dphi));
+        cplxbuf_to_cplx(&A, yo, N);
+        for (int i = 0; i < N; i++)
+            err += cplx_mag2(cplx_sub(yo[i],
+                                      cplx_mul(a[i], cplx_exp_j(dphi * i))));
+
+        cplxbuf_free(&A);
+        cplxbuf_free(&B);
+        cplxbuf_free(&Y);
+        if (err < 1e-18) { TEST_PASS_STMT; }
+        else { TEST_FAIL_STMT("SoA kernel mismatch"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 9: Packed bitstream helpers ────────────────────── */
+    TEST_CASE_BEGIN("BitVec packing, random_bits_packed, bit_errors_packed")
+    {
+        enum { N = 1000 };
+        uint8_t a[N], b[N], bytes[N / 8], back[N];
+        BitVec va, vb, vbytes;
+        bitvec_init(&va, N);
+        bitvec_init(&vb, N);
+        bitvec_init(&vbytes, N);
+
+        random_bits(a, N);
+        for (int i = 0; i < N; i++) b[i] = a[i] ^ (rng_uniform() < 0.1);
+        bitvec_from_bits(&va, a, N);
+        bitvec_from_bits(&vb, b, N);
+        bitvec_to_bits(&va, back);
+        int ok = memcmp(a, back, N) == 0 &&
+                 bit_errors_packed(&va, &vb) == bit_errors(a, b, N);
+
+        for (int i = 0; i < N / 8; i++) bytes[i] = (uint8_t)(37 * i + 5);
+        bits_from_bytes(bytes, N / 8, a);
+        bitvec_from_bytes(&vbytes, bytes, N / 8);
+        for (int i = 0; i < N && ok; i++)
+            if (bitvec_get(&vbytes, i) != a[i]) ok = 0;
+
+        /* Odd length: tail bits beyond n must stay clear */
+        RngState rng;
+        rng_state_seed(&rng, 17);
+        va.n = N - 3;
+        random_bits_packed_r(&rng, &va);
+        int ones = 0;
+        for (int i = 0; i < va.n; i++) ones += bitvec_get(&va, i);
+        if ((va.w[BITVEC_WORDS(va.n) - 1] & 7) != 0 || abs(ones - N / 2) > 100)
+            ok = 0;
+
+        bitvec_free(&va);
+        bitvec_free(&vb);
+        bitvec_free(&vbytes);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Packed bit helpers disagree with unpacked"); }
+    }
+    TEST_CASE_END();
+
+    TEST_SUMMARY();
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_cpu_dispatch.c
+ * @brief Tests for runtime SIMD level selection and the kernel table.
+ *
+ * Every level the host supports must give bit-identical results to the
+ * generic kernels, which in turn must match the scalar loops they replaced.
+ *
+ * Run with: make test
+ */
+#define _POSIX_C_SOURCE 200112L   /* setenv / unsetenv */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "test_framework.h"
+#include "../include/cpu_dispatch.h"
+#include "../include/modulation.h"
+#include "../include/coding.h"
+#include "../include/ofdm.h"
+
+enum { NFFT = 1024, FRAME = 200, NSYM = 300, HLEN = 41, SPS = 8, NOFDM = 20,
+       ACS_STEPS = 40 };
+
+/* Outputs of every dispatched path for one run */
+typedef struct {
+    real_t  fre[NFFT], fim[NFFT];
+    uint8_t dec[FRAME], dec_hard[FRAME];
+    real_t  llr[6 * NSYM];
+    real_t  shaped[NSYM * SPS + HLEN - 1];
+    real_t  mre[NFFT], mim[NFFT];
+    Cplx    dot;
+    Cplx    ofdm_tx[NOFDM * 80], ofdm_rx[NOFDM * 64];
+    uint32_t crc[4];
+    uint8_t  acs_pm[64];
+    uint64_t acs_dec[ACS_STEPS];
+} KernelOut;
+
+static CplxBuf  fin;
+static Cplx     syms[NSYM];
+static real_t   soft_in[2 * FRAME], pam[NSYM], taps[HLEN];
+static uint8_t  hard_in[2 * FRAME];
+static OfdmParams ofdm;
+static Cplx     ofdm_data[NOFDM * 64];
+static uint8_t  crc_data[1000];
+static int8_t   acs_llr[2 * ACS_STEPS];
+static uint8_t  acs_br[32];
+
+static void run_all(KernelOut *o)
+{
+    memcpy(o->fre, fin.re, sizeof(o->fre));
+    memcpy(o->fim, fin.im, sizeof(o->fim));
+    CplxBuf x = { o->fre, o->fim, NFFT };
+    fft_soa(&x, NFFT);
+
+    viterbi_decode_soft(soft_in, 2 * FRAME, o->dec);
+    viterbi_decode(hard_in, 2 * FRAME, o->dec_hard);
+    mod_demodulate_soft(MOD_64QAM, syms, NSYM, 0.3, o->llr);
+    pulse_shape(pam, NSYM, taps, HLEN, SPS, o->shaped);
+
+    memset(o->mre, 0, sizeof(o->mre));
+    memset(o->mim, 0, sizeof(o->mim));
+    CplxBuf acc = { o->mre, o->mim, NFFT };
+    cplxbuf_mac(&acc, &fin, &x, NFFT);
+    o->dot = cplxbuf_dot(&fin, &x, NFFT);
+
+    /* Batched 64-point OFDM: one full 16-symbol group and a partial one */
+    memset(o->ofdm_rx, 0, sizeof(o->ofdm_rx));
+    ofdm_modulate_block(&ofdm, NOFDM, ofdm_data, o->ofdm_tx);
+    ofdm_demodulate_block(&ofdm, NOFDM, o->ofdm_tx, o->ofdm_rx);
+
+    /* CRC-32 below, at and above the 64-byte fold threshold, with a
+     * 16-byte remainder and a byte tail */
+    static const int crc_len[4] = { 63, 64, 131, 1000 };
+    for (int k = 0; k < 4; k++) o->crc[k] = crc32(crc_data, crc_len[k]);
+
+    /* ACS driven onto the uint8 rail: metrics and LLRs far outside the
+     * decoder's range must saturate alike at every level */
+    for (int s = 0; s < 64; s++)
+        o->acs_pm[s] = (uint8_t)(s & 1 ? 255 - s : 200 + s / 2);
+    comms_kernels()->viterbi_acs8(o->acs_pm, acs_llr, ACS_STEPS, acs_br,
+                                  o->acs_dec);
+}
+
+/* The add-compare-select loop viterbi_decode_soft used before dispatch */
+static void ref_viterbi_soft(const real_t *llr, int n, uint8_t *out)
+{
+    static int path[FRAME][CONV_STATES];
+    double pm_old[CONV_STATES], pm_new[CONV_STATES];
+    for (int s = 0; s < CONV_STATES; s++) pm_old[s] = 1e30;
+    pm_old[0] = 0;
+    for (int t = 0; t < n; t++) {
+        for (int s = 0; s < CONV_STATES; s++) pm_new[s] = 1e30;
+        for (int s = 0; s < CONV_STATES; s++) {
+            if (pm_old[s] >= 1e30) continue;
+            for (int bit = 0; bit <= 1; bit++) {
+                unsigned int full = (s << 1) | bit;
+                int ns = full & (CONV_STATES - 1);
+                int e0 = __builtin_popcount(full & CONV_G0) & 1;
+                int e1 = __builtin_popcount(full & CONV_G1) & 1;
+                double bm = (e0 ? -llr[2 * t] : llr[2 * t]) +
+                            (e1 ? -llr[2 * t + 1] : llr[2 * t + 1]);
+                if (pm_old[s] - bm < pm_new[ns]) {
+                    pm_new[ns] = pm_old[s] - bm;
+                    path[t][ns] = s;
+                }
+            }
+        }
+        memcpy(pm_old, pm_new, sizeof(pm_old));
+    }
+    int state = 0;
+    for (int s = 1; s < CONV_STATES; s++)
+        if (pm_old[s] < pm_old[state]) state = s;
+    for (int t = n - 1; t >= 0; t--) {
+        out[t] = state & 1;
+        state = path[t][state];
+    }
+}
+
+int main(void)
+{
+    TEST_SUITE("CPU Feature Dispatch");
+    rng_seed(1010);
+
+    static uint8_t info[FRAME], coded[2 * FRAME], qam_bits[6 * NSYM];
+    cplxbuf_alloc(&fin, NFFT);
+    for (int i = 0; i < NFFT; i++) {
+        fin.re[i] = rng_gaussian();
+        fin.im[i] = rng_gaussian();
+    }
+    random_bits(info, FRAME);
+    conv_encode(info, FRAME, coded);
+    for (int i = 0; i < 2 * FRAME; i++) {
+        /* On the decoder's 1/VITERBI_LLR_SCALE input grid, so its uint8
+         * metrics are an exact scaling of the double reference */
+        soft_in[i] = round(((coded[i] ? -1.0 : 1.0) + 0.8 * rng_gaussian()) *
+                           VITERBI_LLR_SCALE) / VITERBI_LLR_SCALE;
+        hard_in[i] = soft_in[i] < 0;
+    }
+    random_bits(qam_bits, 6 * NSYM);
+    mod_modulate(MOD_64QAM, qam_bits, 6 * NSYM, syms);
+    for (int i = 0; i < NSYM; i++) {
+        syms[i] = cplx_add(syms[i], cplx(0.1 * rng_gaussian(),
+                                         0.1 * rng_gaussian()));
+        pam[i] = (i & 1) ? -1.0 : 1.0;
+    }
+    for (int i = 0; i < HLEN; i++) taps[i] = rng_gaussian();
+    ofdm_init(&ofdm, 64, 16, 4);
+    for (int i = 0; i < NOFDM * ofdm.n_data; i++)
+        ofdm_data[i] = cplx(rng_gaussian(), rng_gaussian());
+    for (int i = 0; i < (int)sizeof(crc_data); i++)
+        crc_data[i] = (uint8_t)(rng_uniform() * 256);
+    for (int i = 0; i < 2 * ACS_STEPS; i++)
+        acs_llr[i] = (int8_t)((rng_uniform() - 0.5) * 254);
+    for (int i = 0; i < 32; i++) acs_br[i] = (uint8_t)(rng_uniform() * 4);
+
+    unsetenv("COMMS_SIMD");
+    SimdLevel detected = cpu_detect_simd();
+    printf("  (detected %s)\n", simd_level_name(detected));
+
+    /* ── Test 1: Default selection is the detected level ─────── */
+    TEST_CASE_BEGIN("simd_init picks the highest supported level")
+    {
+        int ok = simd_init() == detected && simd_level() == detected &&
+                 comms_kernels()->level == detected &&
+                 strcmp(simd_level_name(SIMD_N_LEVELS), "unknown") == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Active level differs from cpuid"); }
+    }
+    TEST_CASE_END();
+
+    static KernelOut ref, out;
+    simd_set_level(SIMD_GENERIC);
+    run_all(&ref);
+
+    /* ── Test 2: Generic kernels match the scalar originals ──── */
+    TEST_CASE_BEGIN("Generic Viterbi ACS and LLRs match scalar loops")
+    {
+        static uint8_t dref[FRAME];
+        ref_viterbi_soft(soft_in, FRAME, dref);
+        int ok = memcmp(dref, ref.dec, FRAME) == 0;
+
+        /* Per-bit max-log scan as in the original demapper */
+        Cplx pts[64];
+        mod_constellation(MOD_64QAM, pts);
+        for (int i = 0; i < NSYM && ok; i++) {
+            for (int b = 0; b < 6; b++) {
+                double max0 = -1e30, max1 = -1e30;
+                for (int j = 0; j < 64; j++) {
+                    double m = -cplx_mag2(cplx_sub(syms[i], pts[j])) /
+                               (2.0 * 0.3 * 0.3);
+                    if ((j >> (5 - b)) & 1) max1 = m > max1 ? m : max1;
+                    else                    max0 = m > max0 ? m : max0;
+                }
+                real_t l = max0 - max1;
+                ok = ok && memcmp(&l, &ref.llr[6 * i + b], sizeof(l)) == 0;
+            }
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Dispatched kernels changed the results"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: Every supported level is bit-identical ──────── */
+    TEST_CASE_BEGIN("All supported ISA levels produce identical output")
+    {
+        int ok = 1;
+        for (int l = SIMD_SSE42; l <= (int)detected; l++) {
+            ok = ok && simd_set_level((SimdLevel)l) == (SimdLevel)l;
+            run_all(&out);
+            int same = memcmp(&ref, &out, sizeof(ref)) == 0;
+            if (!same) printf("(%s differs) ", simd_level_name(l));
+            ok = ok && same;
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("ISA variants disagree"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 4: COMMS_SIMD override and clamping ────────────── */
+    TEST_CASE_BEGIN("COMMS_SIMD selects a level, requests are clamped")
+    {
+        setenv("COMMS_SIMD", "generic", 1);
+        int ok = simd_init() == SIMD_GENERIC &&
+                 comms_kernels()->level == SIMD_GENERIC;
+        setenv("COMMS_SIMD", "bogus", 1);
+        ok = ok && simd_init() == detected;
+        unsetenv("COMMS_SIMD");
+        ok = ok && simd_set_level(SIMD_AVX512) == detected &&
+             simd_set_level(SIMD_GENERIC) == SIMD_GENERIC;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Override or clamp misbehaved"); }
+    }
+    TEST_CASE_END();
+
+    simd_init();
+    cplxbuf_free(&fin);
+    TEST_SUMMARY();
+}
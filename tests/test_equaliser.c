@@ -112,5 +112,53 @@ int main(void)
     }
     TEST_CASE_END();
 
+    /* ── Test 6: Adaptation on complex symbols ───────────────── */
+    TEST_CASE_BEGIN("LMS, decision-directed LMS and DFE converge on QPSK")
+    {
+        /* A complex post-cursor: the weight updates must follow the
+         * y = w^H·x output, or the imaginary parts run away */
+        enum { N = 4000, TAIL = 500 };
+        static Cplx s[N], rx[N];
+        Cplx h1 = cplx(0.3, 0.25);
+        for (int i = 0; i < N; i++) {
+            s[i] = cplx(rng_gaussian() < 0 ? -1 : 1,
+                        rng_gaussian() < 0 ? -1 : 1);
+            rx[i] = i ? cplx_add(s[i], cplx_mul(h1, s[i - 1])) : s[i];
+        }
+
+        /* Trained LMS (centre tap 3), then decision-directed */
+        LmsEqualiser lms;
+        eq_lms_init(&lms, 7, 0.01);
+        double mse_lms = 0, mse_dd = 0, mse_dfe = 0;
+        Cplx e;
+        for (int i = 0; i < N; i++) {
+            eq_lms_step(&lms, rx[i], i >= 3 ? s[i - 3] : cplx(0, 0), &e);
+            if (i >= N - TAIL) mse_lms += cplx_mag2(e) / TAIL;
+        }
+        for (int i = 0; i < N; i++) {
+            eq_lms_dd_step(&lms, rx[i], &e);
+            if (i >= N - TAIL) mse_dd += cplx_mag2(e) / TAIL;
+        }
+        eq_lms_free(&lms);
+
+        /* DFE: 5 feedforward taps (centre 2), 3 feedback */
+        DfeEqualiser dfe;
+        eq_dfe_init(&dfe, 5, 3, 0.01);
+        for (int i = 0; i < N; i++) {
+            eq_dfe_step(&dfe, rx[i], i >= 2 ? s[i - 2] : cplx(0, 0), &e);
+            if (i >= N - TAIL) mse_dfe += cplx_mag2(e) / TAIL;
+        }
+        eq_dfe_free(&dfe);
+
+        if (mse_lms < 0.01 && mse_dd < 0.01 && mse_dfe < 0.05) {
+            TEST_PASS_STMT;
+        } else {
+            printf("(MSE lms %.2e dd %.2e dfe %.2e) ", mse_lms, mse_dd,
+                   mse_dfe);
+            TEST_FAIL_STMT("Adaptive equaliser diverged on complex data");
+        }
+    }
+    TEST_CASE_END();
+
     TEST_SUMMARY();
 }
@@ -0,0 +1,236 @@
+/**
+ * @file test_fixed_point.c
+ * @brief Unit tests for the Q15/Q31 fixed-point datapath.
+ *
+ * Run with: make test
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include "test_framework.h"
+#include "../include/fixed_point.h"
+#include "../include/modulation.h"
+#include "../include/coding.h"
+#include "../include/channel.h"
+#include "../include/ofdm.h"
+#include "../include/sync.h"
+
+int main(void)
+{
+    TEST_SUITE("Fixed-Point (Q15/Q31)");
+    rng_seed(1515);
+
+    /* ── Test 1: Saturating arithmetic ───────────────────────── */
+    TEST_CASE_BEGIN("Q15/Q31 add, sub and mul saturate")
+    {
+        int ok = q15_add(30000, 10000) == Q15_MAX &&
+                 q15_sub(-30000, 10000) == Q15_MIN &&
+                 q15_mul(Q15_MIN, Q15_MIN) == Q15_MAX &&
+                 q15_mul(16384, 16384) == 8192 &&
+                 q31_add(Q31_MAX, 1) == Q31_MAX &&
+                 q31_mul(Q31_MIN, Q31_MIN) == Q31_MAX;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Saturation or rounding wrong"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 2: Q15 mapping matches double mapping ──────────── */
+    TEST_CASE_BEGIN("mod_modulate_q15 matches mod_modulate (QPSK, 64-QAM)")
+    {
+        enum { NB = 600 };
+        uint8_t bits[NB];
+        Cplx ref[NB];
+        CplxQ15 q[NB];
+        random_bits(bits, NB);
+
+        int ok = 1;
+        ModScheme schemes[2] = { MOD_QPSK, MOD_64QAM };
+        for (int m = 0; m < 2; m++) {
+            int ns = mod_modulate(schemes[m], bits, NB, ref);
+            int nq = mod_modulate_q15(schemes[m], bits, NB, q);
+            if (ns != nq || fxp_sqnr_db(ref, q, ns, FXP_SYM_ONE) < 80.0)
+                ok = 0;
+        }
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Q15 constellation mismatch"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: Q15 pulse shaping tracks double reference ───── */
+    TEST_CASE_BEGIN("pulse_shape_q15 SQNR > 60 dB vs pulse_shape")
+    {
+        enum { NS = 64, SPS = 4, SPAN = 8 };
+        real_t h[SPAN * SPS + 1], syms[NS];
+        real_t ref[NS * SPS + SPAN * SPS];
+        q15_t hq[SPAN * SPS + 1], sq[NS], outq[NS * SPS + SPAN * SPS];
+        uint8_t bits[NS];
+
+        int hlen = root_raised_cosine(0.35, SPS, SPAN, h);
+        random_bits(bits, NS);
+        nrz_encode(bits, NS, syms);
+
+        /* Taps in Q14 (peak ≈ 1.2), symbols at FXP_SYM_ONE */
+        fxp_quantise(h, hlen, 16384.0, hq);
+        fxp_quantise(syms, NS, FXP_SYM_ONE, sq);
+        int n = pulse_shape(syms, NS, h, hlen, SPS, ref);
+        int nq = pulse_shape_q15(sq, NS, hq, hlen, SPS, outq);
+
+        /* Output scale: FXP_SYM_ONE · 2^14 / 2^15 */
+        double scale = FXP_SYM_ONE * 0.5, sig = 0, err = 0;
+        for (int i = 0; i < n; i++) {
+            double d = ref[i] - outq[i] / scale;
+            sig += ref[i] * ref[i];
+            err += d * d;
+        }
+        double sqnr = 10 * log10(sig / err);
+        if (n == nq && sqnr > 60.0) { TEST_PASS_STMT; }
+        else {
+            printf("(SQNR %.1f dB) ", sqnr);
+            TEST_FAIL_STMT("Q15 pulse shaping too noisy");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 4: Block-floating-point FFT ────────────────────── */
+    TEST_CASE_BEGIN("fft_q15 SQNR > 50 dB, ifft_q15 round-trip")
+    {
+        enum { N = 256 };
+        Cplx x[N], ref[N], back[N];
+        CplxQ15 q[N];
+        for (int i = 0; i < N; i++)
+            x[i] = cplx(0.5 * (rng_uniform() * 2 - 1),
+                        0.5 * (rng_uniform() * 2 - 1));
+        cplxq15_from_cplx(x, N, 32768.0, q);
+
+        for (int i = 0; i < N; i++) ref[i] = x[i];
+        fft(ref, N);
+        int e = fft_q15(q, N);
+        double sqnr_fwd = fxp_sqnr_db(ref, q, N, 32768.0 / ldexp(1.0, e));
+
+        e += ifft_q15(q, N);   /* exponents accumulate across transforms */
+        cplxq15_to_cplx(q, N, 32768.0 / ldexp(1.0, e), back);
+        double sig = 0, err = 0;
+        for (int i = 0; i < N; i++) {
+            sig += cplx_mag2(x[i]);
+            err += cplx_mag2(cplx_sub(x[i], back[i]));
+        }
+        double sqnr_rt = 10 * log10(sig / err);
+
+        if (sqnr_fwd > 50.0 && sqnr_rt > 40.0) { TEST_PASS_STMT; }
+        else {
+            printf("(fwd %.1f dB, round-trip %.1f dB) ", sqnr_fwd, sqnr_rt);
+            TEST_FAIL_STMT("BFP FFT precision too low");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 5: Q15 Costas loop tracks a frequency offset ───── */
+    TEST_CASE_BEGIN("Q15 Costas loop locks like the double loop, stays bounded")
+    {
+        enum { N = 4000 };
+        static uint8_t bits[2 * N];
+        static Cplx tx[N], rx[N], out[N];
+        static CplxQ15 rxq[N], outq[N];
+        double f_off = 0.005;   /* rad/sample */
+
+        random_bits(bits, 2 * N);
+        mod_modulate(MOD_QPSK, bits, 2 * N, tx);
+        for (int i = 0; i < N; i++)
+            rx[i] = cplx_mul(tx[i], cplx_exp_j(f_off * i + 0.3));
+        cplxq15_from_cplx(rx, N, FXP_SYM_ONE, rxq);
+
+        /* Feed the double loop the same real values the Q15 loop sees
+         * (FXP_SYM_ONE / 2^15), so both have the same detector gain. */
+        for (int i = 0; i < N; i++)
+            rx[i] = cplx_scale(rx[i], FXP_SYM_ONE / 32768.0);
+
+        CarrierSync cs;
+        CarrierSyncQ15 csq;
+        carrier_init(&cs, 0.02, 0.707);
+        carrier_init_q15(&csq, 0.02, 0.707);
+        double f_ref = carrier_costas_qpsk(&cs, rx, N, out);
+        double f_q15 = carrier_costas_qpsk_q15(&csq, rxq, N, outq);
+
+        /* Wide loop on full-scale noise: the integrator must saturate
+         * at ±π/2 rather than overflow */
+        CarrierSyncQ15 wild;
+        carrier_init_q15(&wild, 0.5, 0.707);
+        for (int i = 0; i < N; i++) {
+            rxq[i].re = (q15_t)((rng_uniform() < 0.5) ? Q15_MIN : Q15_MAX);
+            rxq[i].im = (q15_t)((rng_uniform() < 0.5) ? Q15_MIN : Q15_MAX);
+        }
+        double f_wild = carrier_costas_qpsk_q15(&wild, rxq, N, outq);
+
+        if (fabs(f_q15 - f_off) < 5e-4 && fabs(f_q15 - f_ref) < 5e-4 &&
+            fabs(f_wild) <= M_PI / 2)
+            { TEST_PASS_STMT; }
+        else {
+            printf("(f_ref %.5f, f_q15 %.5f, f_wild %.3f) ",
+                   f_ref, f_q15, f_wild);
+            TEST_FAIL_STMT("Q15 Costas loop did not lock");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 6: Quantisation loss of the soft Viterbi path ──── */
+    TEST_CASE_BEGIN("viterbi_decode_soft_q15 BER within 10% of double")
+    {
+        enum { FRAME = 200, N_FRAMES = 200 };
+        uint8_t info[FRAME], coded[2 * FRAME], d_ref[FRAME], d_q[FRAME];
+        Cplx s[2 * FRAME], r[2 * FRAME];
+        real_t llr[2 * FRAME];
+        q15_t llr_q[2 * FRAME];
+        double snr = ebn0_to_snr(2.5 + 10 * log10(0.5), 1, 1.0, 1);
+        double sigma = sqrt(0.5 / db_to_linear(snr));
+
+        int e_ref = 0, e_q = 0;
+        for (int f = 0; f < N_FRAMES; f++) {
+            random_bits(info, FRAME);
+            conv_encode(info, FRAME, coded);
+            mod_modulate(MOD_BPSK, coded, 2 * FRAME, s);
+            channel_awgn(s, 2 * FRAME, snr, r);
+            mod_demodulate_soft(MOD_BPSK, r, 2 * FRAME, sigma, llr);
+
+            /* LLR magnitudes here are ≲ 40: 2^9 per unit keeps headroom */
+            fxp_quantise(llr, 2 * FRAME, 512.0, llr_q);
+            viterbi_decode_soft(llr, 2 * FRAME, d_ref);
+            viterbi_decode_soft_q15(llr_q, 2 * FRAME, d_q);
+            for (int i = 0; i < FRAME; i++) {
+                e_ref += info[i] != d_ref[i];
+                e_q   += info[i] != d_q[i];
+            }
+        }
+        if (e_q <= e_ref * 1.1 + 5) { TEST_PASS_STMT; }
+        else {
+            printf("(errors double %d, Q15 %d) ", e_ref, e_q);
+            TEST_FAIL_STMT("Q15 Viterbi quantisation loss too high");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 7: Q15 Viterbi beyond the survivor ring ─────────── */
+    TEST_CASE_BEGIN("viterbi_decode_soft_q15 decodes long frames whole")
+    {
+        enum { N = 5003 };
+        static uint8_t info[N], coded[2 * N], dec[N];
+        static Cplx s[2 * N], r[2 * N];
+        static real_t llr[2 * N];
+        static q15_t llr_q[2 * N];
+        double snr = ebn0_to_snr(7.0 + 10 * log10(0.5), 1, 1.0, 1);
+        double sigma = sqrt(0.5 / db_to_linear(snr));
+        random_bits(info, N);
+        conv_encode(info, N, coded);
+        mod_modulate(MOD_BPSK, coded, 2 * N, s);
+        channel_awgn(s, 2 * N, snr, r);
+        mod_demodulate_soft(MOD_BPSK, r, 2 * N, sigma, llr);
+        fxp_quantise(llr, 2 * N, 512.0, llr_q);
+        int m = viterbi_decode_soft_q15(llr_q, 2 * N, dec);
+        int ok = m == N && memcmp(dec, info, N) == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Long Q15 frame not decoded intact"); }
+    }
+    TEST_CASE_END();
+
+    TEST_SUMMARY();
+}
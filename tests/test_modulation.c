@@ -134,5 +134,31 @@ int main(void)
     }
     TEST_CASE_END();
 
+    /* ── Test 8: Packed-bit mapping ──────────────────────────── */
+    TEST_CASE_BEGIN("mod_modulate_packed matches mod_modulate")
+    {
+        enum { NB = 600 };
+        uint8_t bits[NB];
+        Cplx ref[NB], out[NB];
+        BitVec v;
+        bitvec_init(&v, NB);
+        random_bits(bits, NB);
+        bitvec_from_bits(&v, bits, NB);
+
+        int ok = 1;
+        ModScheme schemes[4] = { MOD_BPSK, MOD_QPSK, MOD_8PSK, MOD_64QAM };
+        for (int m = 0; m < 4; m++) {
+            int ns = mod_modulate(schemes[m], bits, NB, ref);
+            int np = mod_modulate_packed(schemes[m], &v, out);
+            if (ns != np) ok = 0;
+            for (int i = 0; i < ns && ok; i++)
+                if (out[i].re != ref[i].re || out[i].im != ref[i].im) ok = 0;
+        }
+        bitvec_free(&v);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Packed mapping differs"); }
+    }
+    TEST_CASE_END();
+
     TEST_SUMMARY();
 }
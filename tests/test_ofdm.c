@@ -1,12 +1,14 @@
 /**
  * @file test_ofdm.c
- * @brief Unit tests for OFDM and FFT functions.
+ * @brief Unit tests for OFDM functions.
  *
  * Run with: make test
  */
 
 #include <stdio.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "test_framework.h"
 #include "../include/comms_utils.h"
 #include "../include/ofdm.h"
@@ -18,49 +20,10 @@
 
 int main(void)
 {
-    TEST_SUITE("OFDM & FFT");
+    TEST_SUITE("OFDM");
     rng_seed(55);
 
-    /* ── Test 1: FFT of DC signal ────────────────────────────── */
-    TEST_CASE_BEGIN("FFT: DC signal -> all energy in bin 0")
-    {
-        Cplx x[8];
-        for (int i = 0; i < 8; i++) x[i] = cplx(1.0, 0.0);
-        fft(x, 8);
-
-        int ok = (fabs(x[0].re - 8.0) < 0.001);
-        for (int i = 1; i < 8; i++)
-            if (cplx_mag2(x[i]) > 0.001) ok = 0;
-
-        if (ok) { TEST_PASS_STMT; }
-        else    { TEST_FAIL_STMT("DC signal FFT failed"); }
-    }
-    TEST_CASE_END();
-
-    /* ── Test 2: FFT→IFFT round-trip ─────────────────────────── */
-    TEST_CASE_BEGIN("FFT -> IFFT recovers original signal")
-    {
-        Cplx x[16], orig[16];
-        for (int i = 0; i < 16; i++) {
-            x[i] = cplx(rng_uniform() * 2 - 1, rng_uniform() * 2 - 1);
-            orig[i] = x[i];
-        }
-        fft(x, 16);
-        ifft(x, 16);
-
-        int ok = 1;
-        for (int i = 0; i < 16; i++) {
-            if (fabs(x[i].re - orig[i].re) > 0.001 ||
-                fabs(x[i].im - orig[i].im) > 0.001) {
-                ok = 0; break;
-            }
-        }
-        if (ok) { TEST_PASS_STMT; }
-        else    { TEST_FAIL_STMT("FFT->IFFT round-trip failed"); }
-    }
-    TEST_CASE_END();
-
-    /* ── Test 3: OFDM init creates valid params ──────────────── */
+    /* ── Test 1: OFDM init creates valid params ──────────────── */
     TEST_CASE_BEGIN("OFDM init: 64-pt, CP=16, 4 pilots")
     {
         OfdmParams ofdm;
@@ -73,7 +36,7 @@ int main(void)
     }
     TEST_CASE_END();
 
-    /* ── Test 4: OFDM modulate → demodulate round-trip ───────── */
+    /* ── Test 2: OFDM modulate → demodulate round-trip ───────── */
     TEST_CASE_BEGIN("OFDM single symbol round-trip (BPSK)")
     {
         OfdmParams ofdm;
@@ -101,19 +64,291 @@ int main(void)
     }
     TEST_CASE_END();
 
-    /* ── Test 5: FFT impulse → flat spectrum ─────────────────── */
-    TEST_CASE_BEGIN("FFT impulse gives flat magnitude spectrum")
+    /* ── Test 3: OFDM with a 1536-point FFT ──────────────────── */
+    TEST_CASE_BEGIN("OFDM round-trip with n_fft = 1536")
+    {
+        static OfdmParams ofdm;
+        ofdm_init(&ofdm, 1536, 108, 16);
+        static uint8_t bits[2 * OFDM_MAX_CARRIERS], rx_bits[2 * OFDM_MAX_CARRIERS];
+        static Cplx data[OFDM_MAX_CARRIERS], td[1536 + 108],
+                    rx[OFDM_MAX_CARRIERS];
+        random_bits(bits, 2 * ofdm.n_data);
+        mod_modulate(MOD_QPSK, bits, 2 * ofdm.n_data, data);
+        ofdm_modulate(&ofdm, data, td);
+        int nd = ofdm_demodulate(&ofdm, td, rx, NULL);
+        mod_demodulate(MOD_QPSK, rx, nd, rx_bits);
+
+        int ok = ofdm.plan && ofdm.plan->n == 1536 && nd == ofdm.n_data &&
+                 memcmp(bits, rx_bits, 2 * nd) == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("1536-point OFDM symbol corrupted"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 4: Batched blocks match the per-symbol path ─────── */
+    TEST_CASE_BEGIN("Batched block mod/demod bit-identical to per symbol")
+    {
+        /* 2^even, 2^odd, cache-bound and mixed-radix sizes; 37 symbols
+         * leave a partial last group */
+        static const int sizes[] = { 64, 128, 1024, 1200 };
+        enum { NS = 37 };
+        static Cplx data[NS * OFDM_MAX_CARRIERS], rx[NS * OFDM_MAX_CARRIERS],
+                    ref[NS * OFDM_MAX_CARRIERS];
+        static Cplx td[NS * 1500], td_ref[NS * 1500];
+        static OfdmParams ofdm;
+        CommsArena ws;
+        int ok = arena_init(&ws, 1 << 20) == 0;
+        for (int t = 0; t < 4 && ok; t++) {
+            int n = sizes[t], sym = n + n / 4;
+            ofdm_init(&ofdm, n, n / 4, n <= 128 ? n / 16 : 32);
+            for (int i = 0; i < NS * ofdm.n_data; i++)
+                data[i] = cplx(rng_gaussian(), rng_gaussian());
+
+            for (int s = 0; s < NS; s++)
+                ofdm_modulate(&ofdm, data + s * ofdm.n_data, td_ref + s * sym);
+            ok = ok && ofdm_modulate_block_ws(&ofdm, NS, data, td, &ws) ==
+                       NS * sym &&
+                 memcmp(td, td_ref, NS * sym * sizeof(Cplx)) == 0;
+
+            for (int s = 0; s < NS; s++)
+                ofdm_demodulate(&ofdm, td + s * sym, ref + s * ofdm.n_data,
+                                NULL);
+            ok = ok && ofdm_demodulate_block_ws(&ofdm, NS, td, rx, &ws) ==
+                       NS * ofdm.n_data &&
+                 memcmp(rx, ref, NS * ofdm.n_data * sizeof(Cplx)) == 0 &&
+                 ws.used == 0;
+            if (!ok) printf("(n=%d) ", n);
+        }
+        arena_free(&ws);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Batched output differs"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 5: Frame demodulation reuses one estimate ───────── */
+    TEST_CASE_BEGIN("Frame demod through a static 2-tap channel")
+    {
+        enum { NS = 200, N = 64, CP = 16 };
+        static OfdmParams ofdm;
+        ofdm_init(&ofdm, N, CP, 4);
+        static uint8_t bits[2 * NS * N], rx_bits[2 * NS * N];
+        static Cplx data[NS * N], td[NS * (N + CP)], ch[NS * (N + CP)],
+                    rx[NS * N];
+        int nbits = 2 * NS * ofdm.n_data;
+        random_bits(bits, nbits);
+        mod_modulate(MOD_QPSK, bits, nbits, data);
+        ofdm_modulate_block(&ofdm, NS, data, td);
+
+        Cplx h0 = cplx(1.0, 0.0), h1 = cplx(0.2, 0.1);
+        ch[0] = cplx_mul(h0, td[0]);
+        for (int i = 1; i < NS * (N + CP); i++)
+            ch[i] = cplx_add(cplx_mul(h0, td[i]), cplx_mul(h1, td[i - 1]));
+
+        /* Noiseless: the frame estimate equals the first symbol's */
+        Cplx h_frame[N], h_sym[N], first[N];
+        ofdm_demodulate_frame(&ofdm, NS, ch, rx, h_frame, NULL);
+        ofdm_demodulate(&ofdm, ch, first, h_sym);
+        int ok = 1;
+        for (int d = 0; d < ofdm.n_data; d++)
+            ok = ok && cplx_mag(cplx_sub(h_frame[d], h_sym[d])) < 1e-9;
+
+        /* With noise every QPSK decision still comes out right */
+        for (int i = 0; i < NS * (N + CP); i++)
+            ch[i] = cplx_add(ch[i], cplx(0.005 * rng_gaussian(),
+                                         0.005 * rng_gaussian()));
+        int nd = ofdm_demodulate_frame(&ofdm, NS, ch, rx, NULL, NULL);
+        mod_demodulate(MOD_QPSK, rx, nd, rx_bits);
+        ok = ok && nd == NS * ofdm.n_data &&
+             memcmp(bits, rx_bits, nbits) == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Frame estimate or decisions wrong"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 6: Precomputed pilot taps and pilot averaging ──── */
+    TEST_CASE_BEGIN("Pilot interpolation table, averaged estimates")
     {
-        Cplx x[8] = {{1,0},{0,0},{0,0},{0,0},{0,0},{0,0},{0,0},{0,0}};
-        fft(x, 8);
+        /* Taps match a brute-force search for the bracketing pilots */
+        static OfdmParams ofdm;
+        int ok = 1;
+        static const int cfg[][2] = { { 64, 4 }, { 128, 8 }, { 1024, 32 },
+                                      { 64, 1 } };
+        for (int c = 0; c < 4; c++) {
+            ofdm_init(&ofdm, cfg[c][0], cfg[c][0] / 4, cfg[c][1]);
+            for (int d = 0; d < ofdm.n_data; d++) {
+                int k = ofdm.data_idx[d], lo = -1, hi = -1;
+                for (int i = 0; i < ofdm.n_pilot; i++) {
+                    if (ofdm.pilot_idx[i] <= k) lo = i;
+                    if (ofdm.pilot_idx[i] >= k && hi < 0) hi = i;
+                }
+                if (lo < 0) lo = hi;
+                if (hi < 0) hi = lo;
+                double w = lo == hi ? 0.0 :
+                    (double)(k - ofdm.pilot_idx[lo]) /
+                    (ofdm.pilot_idx[hi] - ofdm.pilot_idx[lo]);
+                OfdmInterp t = ofdm.interp[d];
+                ok = ok && t.lo == lo && t.hi == hi && fabs(t.w - w) < 1e-12;
+            }
+        }
+
+        /* Averaging over a static channel beats per-symbol estimates */
+        enum { NS = 64, N = 64, CP = 16 };
+        ofdm_init(&ofdm, N, CP, 8);
+        static Cplx data[NS * N], td[NS * (N + CP)], rx[N];
+        for (int i = 0; i < NS * ofdm.n_data; i++)
+            data[i] = cplx(rng_gaussian(), rng_gaussian());
+        ofdm_modulate_block(&ofdm, NS, data, td);
+        for (int i = NS * (N + CP) - 1; i > 0; i--)
+            td[i] = cplx_add(td[i], cplx_scale(td[i - 1], 0.3));
+        Cplx h_ref[N], h_sym[N], h_avg[N];
+        ofdm_demodulate(&ofdm, td + (N + CP), rx, h_ref);
+        for (int i = 0; i < NS * (N + CP); i++)
+            td[i] = cplx_add(td[i], cplx(0.05 * rng_gaussian(),
+                                         0.05 * rng_gaussian()));
+
+        OfdmPilotAvg avg;
+        ofdm_pilot_avg_init(&avg, 0.1);
+        double e_sym = 0.0, e_avg = 0.0;
+        for (int s = 0; s < NS; s++) {
+            const Cplx *in = td + s * (N + CP);
+            ofdm_demodulate(&ofdm, in, rx, h_sym);
+            ofdm_demodulate_avg(&ofdm, in, rx, h_avg, &avg, NULL);
+            if (s < NS / 2) continue;
+            for (int d = 0; d < ofdm.n_data; d++) {
+                e_sym += cplx_mag2(cplx_sub(h_sym[d], h_ref[d]));
+                e_avg += cplx_mag2(cplx_sub(h_avg[d], h_ref[d]));
+            }
+        }
+        ok = ok && avg.n_symbols == NS && e_avg * 4.0 < e_sym;
+        if (!ok) printf("(mse sym %.3g avg %.3g) ", e_sym, e_avg);
 
+        /* alpha = 1 is the per-symbol estimate */
+        ofdm_pilot_avg_init(&avg, 1.0);
+        ofdm_demodulate_avg(&ofdm, td, rx, h_avg, &avg, NULL);
+        ofdm_demodulate(&ofdm, td, rx, h_sym);
+        ok = ok && memcmp(h_avg, h_sym, ofdm.n_data * sizeof(Cplx)) == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Interpolation taps or averaging wrong"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 7: Streaming Schmidl-Cox acquisition ───────────── */
+    TEST_CASE_BEGIN("Sync: timing, CFO and data through a streamed frame")
+    {
+        enum { N = 64, CP = 16, SYM = N + CP, NS = 12, GAP = 300,
+               FRAME = 2 * SYM + NS * SYM, LEN = 2 * (GAP + FRAME) + GAP };
+        static OfdmParams ofdm;
+        ofdm_init(&ofdm, N, CP, 8);
+        static uint8_t bits[2 * NS * N], rx_bits[2 * NS * N];
+        static Cplx data[NS * N], stream[LEN], syms[2 * NS * SYM],
+                    rx[NS * N];
+        int nbits = 2 * NS * ofdm.n_data;
+        random_bits(bits, nbits);
+        mod_modulate(MOD_QPSK, bits, nbits, data);
+
+        /* noise | preamble data | noise | preamble data | noise */
+        memset(stream, 0, sizeof(stream));
+        for (int f = 0; f < 2; f++) {
+            Cplx *fr = stream + GAP + f * (GAP + FRAME);
+            ofdm_sync_preamble(&ofdm, fr);
+            ofdm_modulate_block(&ofdm, NS, data, fr + 2 * SYM);
+        }
+        double cfo = 3.3;     /* subcarrier spacings: 2·2 − 0.7 */
+        for (int i = 0; i < LEN; i++)
+            stream[i] = cplx_add(
+                cplx_mul(stream[i], cplx_exp_j(2 * M_PI * cfo * i / N + 0.4)),
+                cplx(0.01 * rng_gaussian(), 0.01 * rng_gaussian()));
+
+        OfdmSync sync;
+        int ok = ofdm_sync_init(&sync, &ofdm, 0.5, NS) == 0;
+        int got = 0, first_t1 = -1;
+        for (int i = 0; ok && i < LEN; i += 37) {
+            int len = LEN - i < 37 ? LEN - i : 37;
+            got += ofdm_sync_process(&sync, stream + i, len,
+                                     syms + got * SYM);
+            if (first_t1 < 0 && sync.n_frames == 1) first_t1 = (int)sync.t1;
+        }
+        ok = ok && got == 2 * NS && sync.n_frames == 2 &&
+             first_t1 == GAP + CP &&
+             fabs(sync.cfo - cfo) < 0.02;
+        if (!ok) printf("(got %d, t1 %d, cfo %.3f) ", got, first_t1, sync.cfo);
+
+        for (int f = 0; ok && f < 2; f++) {
+            int nd = ofdm_demodulate_block(&ofdm, NS, syms + f * NS * SYM, rx);
+            mod_demodulate(MOD_QPSK, rx, nd, rx_bits);
+            ok = memcmp(bits, rx_bits, nbits) == 0;
+        }
+        ofdm_sync_free(&sync);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Frame not acquired or data corrupted"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 8: Threaded frame processing ────────────────────── */
+    TEST_CASE_BEGIN("Worker pool output identical to single-threaded")
+    {
+        enum { NS = 24, NMAX = 4096, CPMAX = 256 };
+        static Cplx data[NS * NMAX], td[NS * (NMAX + CPMAX)],
+                    ref[NS * NMAX], out[NS * NMAX];
+        static uint8_t bits[2 * NS * NMAX], ref_bits[2 * NS * NMAX];
+        static real_t llr[2 * NS * NMAX], ref_llr[2 * NS * NMAX];
+        static OfdmParams op;
+        const int cfg[2][4] = { { 4096, 256, 32, NS }, { 64, 16, 4, 19 } };
+        const int threads[3] = { 1, 3, 8 };
         int ok = 1;
-        for (int k = 0; k < 8; k++) {
-            double mag = sqrt(cplx_mag2(x[k]));
-            if (fabs(mag - 1.0) > 0.001) { ok = 0; break; }
+        for (int c = 0; c < 2 && ok; c++) {
+            ofdm_init(&op, cfg[c][0], cfg[c][1], cfg[c][2]);
+            int ns = cfg[c][3], nd = op.n_data;
+            int sym = op.n_fft + op.n_cp;
+            for (int i = 0; i < ns * nd; i++)
+                data[i] = cplx(rng_gaussian() < 0 ? -1 : 1,
+                               rng_gaussian() < 0 ? -1 : 1);
+            ofdm_modulate_block(&op, ns, data, td);
+            double sn = 0.01 / sqrt(op.n_fft);   /* 0.01 per carrier */
+            for (int i = 0; i < ns * sym; i++)
+                td[i] = cplx_add(cplx_mul(td[i], cplx(0.8, -0.3)),
+                                 cplx(sn * rng_gaussian(),
+                                      sn * rng_gaussian()));
+
+            for (int t = 0; t < 3 && ok; t++) {
+                OfdmPool pool;
+                ok = ofdm_pool_init(&pool, threads[t]) == 0 &&
+                     pool.n_threads == threads[t];
+                OfdmDemap dm = { MOD_QPSK, 0.1, bits, llr };
+                for (int frame = 0; frame < 2 && ok; frame++) {
+                    Cplx h_ref[NMAX], h_mt[NMAX];
+                    int m;
+                    if (frame) {
+                        ofdm_demodulate_frame(&op, ns, td, ref, h_ref, NULL);
+                        m = ofdm_demodulate_frame_mt(&pool, &op, ns, td, out,
+                                                     h_mt, &dm);
+                        ok = memcmp(h_ref, h_mt, nd * sizeof(Cplx)) == 0;
+                    } else {
+                        ofdm_demodulate_block(&op, ns, td, ref);
+                        m = ofdm_demodulate_block_mt(&pool, &op, ns, td, out,
+                                                     &dm);
+                    }
+                    int nb = mod_demodulate(MOD_QPSK, ref, m, ref_bits);
+                    mod_demodulate_soft(MOD_QPSK, ref, m, 0.1, ref_llr);
+                    ok = ok && m == ns * nd &&
+                         memcmp(ref, out, m * sizeof(Cplx)) == 0 &&
+                         memcmp(ref_bits, bits, nb) == 0 &&
+                         memcmp(ref_llr, llr, nb * sizeof(real_t)) == 0;
+                    if (!ok) printf("(n=%d threads=%d frame=%d) ",
+                                    op.n_fft, threads[t], frame);
+                }
+                /* Fewer symbols than workers */
+                ofdm_demodulate_block(&op, 2, td, ref);
+                ok = ok && ofdm_demodulate_block_mt(&pool, &op, 2, td, out,
+                                                    NULL) == 2 * nd &&
+                     memcmp(ref, out, 2 * nd * sizeof(Cplx)) == 0;
+                ofdm_pool_free(&pool);
+            }
+            for (int i = 0; ok && i < ns * nd; i++)
+                ok = cplx_mag(cplx_sub(ref[i], data[i])) < 0.2;
         }
         if (ok) { TEST_PASS_STMT; }
-        else    { TEST_FAIL_STMT("Impulse should give flat spectrum"); }
+        else    { TEST_FAIL_STMT("Threaded demodulation differs"); }
     }
     TEST_CASE_END();
 
@@ -11,6 +11,9 @@
 #include "test_framework.h"
 #include "../include/comms_utils.h"
 #include "../include/phy.h"
+#include "../include/coding.h"
+#include "../include/modulation.h"
+#include "../include/ofdm.h"
 
 int main(void)
 {
@@ -167,5 +170,50 @@ int main(void)
     }
     TEST_CASE_END();
 
+    /* ── Test 11: Wi-Fi rates select modulation and puncturing ── */
+    TEST_CASE_BEGIN("Wi-Fi PPDU length follows the rate, 54 Mbit/s decodes")
+    {
+        enum { NB = 100, NBITS = 16 + 8 * NB + 6, PRE = 320 };
+        static const WifiRate rates[] = {
+            WIFI_RATE_6, WIFI_RATE_9, WIFI_RATE_12, WIFI_RATE_18,
+            WIFI_RATE_24, WIFI_RATE_36, WIFI_RATE_48, WIFI_RATE_54
+        };
+        static Cplx ppdu[PRE + 64 * 80];
+        static uint8_t payload[NB], bits[NBITS], dec[NBITS];
+        for (int i = 0; i < NB; i++) payload[i] = (uint8_t)(37 * i + 5);
+
+        /* 6 Mbit/s: 1644 coded bits on 42 BPSK carriers → 40 symbols */
+        int ok = wifi_build_ppdu(payload, NB, WIFI_RATE_6, ppdu) ==
+                 PRE + 40 * 80 &&
+                 wifi_build_ppdu(payload, NB, (WifiRate)0x2, ppdu) == -1;
+        int prev = 1 << 30;
+        for (int i = 0; i < 8 && ok; i++) {
+            int len = wifi_build_ppdu(payload, NB, rates[i], ppdu);
+            ok = len > PRE && (len - PRE) % 80 == 0 && len <= prev;
+            prev = len;
+        }
+
+        /* 54 Mbit/s back to the PSDU: 64-QAM LLRs, rate-3/4 decode,
+         * descramble */
+        OfdmParams ofdm;
+        ofdm_init(&ofdm, 64, 16, 4);
+        int nsyms = ok ? (prev - PRE) / 80 : 0;
+        static Cplx syms[64 * 64];
+        static real_t llr[6 * 64 * 64];
+        ofdm_demodulate_block(&ofdm, nsyms, ppdu + PRE, syms);
+        mod_demodulate_soft(MOD_64QAM, syms, nsyms * ofdm.n_data, 0.1, llr);
+        int n = conv_punctured_len(CONV_RATE_3_4, 2 * NBITS);
+        ok = ok && viterbi_decode_punctured(CONV_RATE_3_4, llr, n, dec) ==
+                   NBITS;
+        memcpy(bits, dec, NBITS);
+        wifi_scramble(0x5D, bits, NBITS);
+        uint8_t psdu[8 * NB];
+        bits_from_bytes(payload, NB, psdu);
+        ok = ok && memcmp(bits + 16, psdu, 8 * NB) == 0;
+        if (ok) { TEST_PASS_STMT; }
+        else { TEST_FAIL_STMT("Rate-dependent PPDU wrong"); }
+    }
+    TEST_CASE_END();
+
     TEST_SUMMARY();
 }
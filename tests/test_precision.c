@@ -0,0 +1,191 @@
+/**
+ * @file test_precision.c
+ * @brief Sample-precision regression tests (real_t = double or float).
+ *
+ * Built twice: against the default double library (test_precision) and
+ * against the -DCOMMS_USE_FLOAT library (test_precision_f32).  Both
+ * builds must reproduce the theoretical BER curves within tolerance.
+ *
+ * Run with: make test
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "test_framework.h"
+#include "../include/comms_utils.h"
+#include "../include/modulation.h"
+#include "../include/coding.h"
+#include "../include/channel.h"
+#include "../include/ofdm.h"
+#include "../include/equaliser.h"
+
+#define N_BITS 120000
+
+static uint8_t tx_bits[N_BITS], rx_bits[N_BITS];
+static Cplx    tx_syms[N_BITS], rx_syms[N_BITS];
+
+/* Simulated uncoded BER over AWGN at the given Eb/N0 (dB) */
+static double simulate_ber(ModScheme scheme, double ebn0_db)
+{
+    int bps = mod_bits_per_symbol(scheme);
+    int nbits = (N_BITS / bps) * bps;
+    random_bits(tx_bits, nbits);
+    int nsyms = mod_modulate(scheme, tx_bits, nbits, tx_syms);
+    channel_awgn(tx_syms, nsyms, ebn0_to_snr(ebn0_db, bps, 1.0, 1), rx_syms);
+    mod_demodulate(scheme, rx_syms, nsyms, rx_bits);
+    return (double)bit_errors(tx_bits, rx_bits, nbits) / nbits;
+}
+
+/* |log(sim / theory)| within tol at every Eb/N0 point */
+static int ber_curve_ok(ModScheme scheme, double (*theory)(double),
+                        const double *ebn0_db, int n_pts, double tol)
+{
+    for (int i = 0; i < n_pts; i++) {
+        double sim = simulate_ber(scheme, ebn0_db[i]);
+        double th  = theory(db_to_linear(ebn0_db[i]));
+        if (sim <= 0.0 || fabs(log(sim / th)) > tol) {
+            printf("(Eb/N0 %.1f dB: sim %.3e, theory %.3e) ", ebn0_db[i],
+                   sim, th);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void)
+{
+    TEST_SUITE(sizeof(real_t) == sizeof(float) ? "Precision (float32)"
+                                               : "Precision (float64)");
+    rng_seed(404);
+
+    static const double ebn0_pts[] = { 2.0, 4.0, 6.0 };
+
+    /* ── Test 1: BPSK BER curve ──────────────────────────────── */
+    TEST_CASE_BEGIN("BPSK BER within 20% of theory (2–6 dB)")
+    {
+        if (ber_curve_ok(MOD_BPSK, ber_bpsk_theory, ebn0_pts, 3, 0.2))
+            { TEST_PASS_STMT; }
+        else
+            { TEST_FAIL_STMT("BPSK BER off theory"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 2: QPSK BER curve ──────────────────────────────── */
+    TEST_CASE_BEGIN("QPSK BER within 20% of theory (2–6 dB)")
+    {
+        if (ber_curve_ok(MOD_QPSK, ber_qpsk_theory, ebn0_pts, 3, 0.2))
+            { TEST_PASS_STMT; }
+        else
+            { TEST_FAIL_STMT("QPSK BER off theory"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: 16-QAM BER curve ────────────────────────────── */
+    TEST_CASE_BEGIN("16-QAM BER within 25% of theory (4–8 dB)")
+    {
+        static const double pts[] = { 4.0, 6.0, 8.0 };
+        if (ber_curve_ok(MOD_16QAM, ber_16qam_theory, pts, 3, 0.25))
+            { TEST_PASS_STMT; }
+        else
+            { TEST_FAIL_STMT("16-QAM BER off theory"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 4: Soft Viterbi coding gain ────────────────────── */
+    TEST_CASE_BEGIN("Soft-decision Viterbi at 4 dB: BER < 1e-3")
+    {
+        enum { FRAME = 200, N_FRAMES = 100 };
+        uint8_t info[FRAME], coded[2 * FRAME], dec[FRAME];
+        Cplx s[2 * FRAME], r[2 * FRAME];
+        real_t llr[2 * FRAME];
+        double snr = ebn0_to_snr(4.0 + 10 * log10(0.5), 1, 1.0, 1);
+        double sigma = sqrt(0.5 / db_to_linear(snr));
+
+        int errs = 0;
+        for (int f = 0; f < N_FRAMES; f++) {
+            random_bits(info, FRAME - 6);
+            for (int i = FRAME - 6; i < FRAME; i++) info[i] = 0;  /* flush */
+            conv_encode(info, FRAME, coded);
+            mod_modulate(MOD_BPSK, coded, 2 * FRAME, s);
+            channel_awgn(s, 2 * FRAME, snr, r);
+            mod_demodulate_soft(MOD_BPSK, r, 2 * FRAME, sigma, llr);
+            viterbi_decode_soft(llr, 2 * FRAME, dec);
+
+            /* Compare allowing the decoder's fixed traceback delay */
+            int best = FRAME;
+            for (int d = 0; d <= 6; d++) {
+                int e = 0;
+                for (int i = 0; i + d < FRAME - 6; i++)
+                    e += (info[i] != dec[i + d]);
+                if (e < best) best = e;
+            }
+            errs += best;
+        }
+        double ber = (double)errs / (N_FRAMES * (FRAME - 12));
+        if (ber < 1e-3) { TEST_PASS_STMT; }
+        else {
+            printf("(BER %.3e) ", ber);
+            TEST_FAIL_STMT("Soft Viterbi lost its coding gain");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 5: OFDM round-trip error ───────────────────────── */
+    TEST_CASE_BEGIN("OFDM 64-pt mod/demod round-trip, EVM < -60 dB")
+    {
+        OfdmParams p;
+        ofdm_init(&p, 64, 16, 4);
+        Cplx data[OFDM_MAX_CARRIERS], out[OFDM_MAX_CARRIERS];
+        Cplx td[64 + 16];
+        uint8_t bits[2 * OFDM_MAX_CARRIERS];
+        random_bits(bits, 2 * p.n_data);
+        mod_modulate(MOD_QPSK, bits, 2 * p.n_data, data);
+        ofdm_modulate(&p, data, td);
+        ofdm_demodulate(&p, td, out, NULL);
+
+        double err = 0, ref = 0;
+        for (int i = 0; i < p.n_data; i++) {
+            err += cplx_mag2(cplx_sub(out[i], data[i]));
+            ref += cplx_mag2(data[i]);
+        }
+        double evm_db = 10 * log10(err / ref + 1e-30);
+        if (evm_db < -60.0) { TEST_PASS_STMT; }
+        else {
+            printf("(EVM %.1f dB) ", evm_db);
+            TEST_FAIL_STMT("OFDM round-trip lost precision");
+        }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 6: LMS equaliser converges ─────────────────────── */
+    TEST_CASE_BEGIN("LMS equaliser converges on 2-tap ISI channel")
+    {
+        enum { N = 3000 };
+        LmsEqualiser eq;
+        eq_lms_init(&eq, 7, 0.01);
+        uint8_t b[2 * N];
+        Cplx s[N];
+        random_bits(b, 2 * N);
+        mod_modulate(MOD_QPSK, b, 2 * N, s);
+
+        double mse = 0;
+        Cplx prev = cplx(0, 0);
+        for (int i = 0; i < N; i++) {
+            Cplx rx = cplx_add(s[i], cplx_scale(prev, 0.4));
+            prev = s[i];
+            Cplx e;
+            eq_lms_step(&eq, rx, i >= 3 ? s[i - 3] : cplx(0, 0), &e);
+            if (i >= N - 500) mse += cplx_mag2(e);
+        }
+        eq_lms_free(&eq);
+        mse /= 500;
+        if (mse < 0.01) { TEST_PASS_STMT; }
+        else {
+            printf("(MSE %.3e) ", mse);
+            TEST_FAIL_STMT("LMS did not converge");
+        }
+    }
+    TEST_CASE_END();
+
+    TEST_SUMMARY();
+}
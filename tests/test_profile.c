@@ -0,0 +1,170 @@
+/**
+ * @file test_profile.c
+ * @brief Tests for the -DCOMMS_PROFILE instrumentation layer.
+ *
+ * Built against the instrumented object tree.  With a path argument
+ * (`make profile`) the Chrome trace is kept there and the report printed.
+ *
+ * Run with: make test
+ */
+#define _POSIX_C_SOURCE 200112L   /* pthreads */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "test_framework.h"
+#include "../include/profile.h"
+#include "../include/modulation.h"
+#include "../include/coding.h"
+#include "../include/channel.h"
+#include "../include/ofdm.h"
+#include "../include/equaliser.h"
+
+/* Test 5: instrumented calls from several threads at once */
+enum { PROF_THREADS = 4, PROF_CALLS = 20000, PROF_SYMS = 8 };
+
+static void *demod_worker(void *arg)
+{
+    (void)arg;
+    Cplx rx[PROF_SYMS];
+    uint8_t bits[PROF_SYMS];
+    for (int i = 0; i < PROF_SYMS; i++) rx[i] = cplx(i & 1 ? 1 : -1, 0);
+    for (int i = 0; i < PROF_CALLS; i++)
+        mod_demodulate(MOD_BPSK, rx, PROF_SYMS, bits);
+    return NULL;
+}
+
+static int count_trace_events(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int events = 0;
+    while (fp && fgets(line, sizeof(line), fp))
+        if (strstr(line, "\"ph\":\"X\"")) events++;
+    if (fp) fclose(fp);
+    return events;
+}
+
+int main(int argc, char **argv)
+{
+    TEST_SUITE("Profiling Instrumentation");
+    rng_seed(808);
+
+    enum { N_ITER = 10, FRAME = 200 };
+    static uint8_t info[FRAME], coded[2 * FRAME], dec[FRAME];
+    static Cplx tx[2 * FRAME], rx[2 * FRAME], fbuf[256];
+    static real_t llr[2 * FRAME];
+
+    prof_reset();
+    for (int it = 0; it < N_ITER; it++) {
+        random_bits(info, FRAME);
+        conv_encode(info, FRAME, coded);
+        mod_modulate(MOD_BPSK, coded, 2 * FRAME, tx);
+        channel_awgn(tx, 2 * FRAME, 6.0, rx);
+        mod_demodulate(MOD_BPSK, rx, 2 * FRAME, coded);
+        mod_demodulate_soft(MOD_BPSK, rx, 2 * FRAME, 0.5, llr);
+        viterbi_decode(coded, 2 * FRAME, dec);
+        viterbi_decode_soft(llr, 2 * FRAME, dec);
+        fft(fbuf, 256);
+    }
+
+    /* ── Test 1: Call and sample counts ──────────────────────── */
+    TEST_CASE_BEGIN("Per-function call and sample counts are exact")
+    {
+        const ProfSite *f = prof_find("fft");
+        const ProfSite *v = prof_find("viterbi_decode_soft");
+        const ProfSite *a = prof_find("channel_awgn");
+        const ProfSite *m = prof_find("mod_demodulate");
+        int ok = f && v && a && m &&
+                 f->calls == N_ITER && f->samples == 256 * N_ITER &&
+                 v->calls == N_ITER && v->samples == 2 * FRAME * N_ITER &&
+                 a->calls == N_ITER && m->samples == 2 * FRAME * N_ITER &&
+                 v->ticks > 0 && prof_find("eq_rls_step") == NULL;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Counters do not match the calls made"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 2: Nested calls are both attributed ────────────── */
+    TEST_CASE_BEGIN("ofdm_demodulate and its inner fft both counted")
+    {
+        OfdmParams p;
+        ofdm_init(&p, 64, 16, 4);
+        Cplx td[80], data[OFDM_MAX_CARRIERS];
+        for (int i = 0; i < 80; i++) td[i] = cplx(rng_gaussian(), 0);
+
+        uint64_t fft_before = prof_find("fft")->calls;
+        ofdm_demodulate(&p, td, data, NULL);
+        ofdm_demodulate(&p, td, data, NULL);
+        const ProfSite *o = prof_find("ofdm_demodulate");
+        int ok = o && o->calls == 2 && o->samples == 160 &&
+                 prof_find("fft")->calls == fft_before + 2;
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Nested instrumentation lost a call"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 3: Chrome trace export ─────────────────────────── */
+    TEST_CASE_BEGIN("prof_write_trace emits one X event per call")
+    {
+        const char *path = argc > 1 ? argv[1] : "test_profile_trace.json";
+        int ok = prof_write_trace(path) == 0;
+
+        FILE *fp = fopen(path, "r");
+        char line[256];
+        int events = 0, header = 0;
+        while (fp && fgets(line, sizeof(line), fp)) {
+            if (strncmp(line, "{\"traceEvents\":[", 16) == 0) header = 1;
+            if (strstr(line, "\"ph\":\"X\"")) events++;
+        }
+        if (fp) fclose(fp);
+        if (argc <= 1) remove(path);
+
+        /* 6 instrumented calls per iteration + 2 ofdm + 2 inner fft */
+        ok = ok && header && events == 6 * N_ITER + 4;
+        if (ok) { TEST_PASS_STMT; }
+        else {
+            printf("(%d events) ", events);
+            TEST_FAIL_STMT("Trace file malformed");
+        }
+    }
+    TEST_CASE_END();
+
+    if (argc > 1) prof_report(stdout);
+
+    /* ── Test 4: Reset clears counters ───────────────────────── */
+    TEST_CASE_BEGIN("prof_reset zeroes all counters")
+    {
+        prof_reset();
+        const ProfSite *f = prof_find("fft");
+        if (f && f->calls == 0 && f->ticks == 0) { TEST_PASS_STMT; }
+        else { TEST_FAIL_STMT("Counters survived reset"); }
+    }
+    TEST_CASE_END();
+
+    /* ── Test 5: Concurrent callers ──────────────────────────── */
+    TEST_CASE_BEGIN("Counters exact and trace bounded under threads")
+    {
+        /* More calls in total than PROF_TRACE_MAX */
+        pthread_t tid[PROF_THREADS];
+        int ok = 1;
+        for (int t = 0; t < PROF_THREADS; t++)
+            ok = ok && pthread_create(&tid[t], NULL, demod_worker,
+                                      NULL) == 0;
+        for (int t = 0; t < PROF_THREADS; t++) pthread_join(tid[t], NULL);
+
+        const ProfSite *m = prof_find("mod_demodulate");
+        const char *path = "test_profile_mt.json";
+        ok = ok && m && m->calls == PROF_THREADS * PROF_CALLS &&
+             m->samples == (uint64_t)PROF_THREADS * PROF_CALLS * PROF_SYMS &&
+             prof_write_trace(path) == 0 &&
+             count_trace_events(path) == PROF_TRACE_MAX;
+        remove(path);
+        prof_reset();
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Lost or overflowing profile records"); }
+    }
+    TEST_CASE_END();
+
+    TEST_SUMMARY();
+}
@@ -98,5 +98,30 @@ int main(void)
     }
     TEST_CASE_END();
 
+    /* ── Test 6: Packed scrambler matches bit-serial ─────────── */
+    TEST_CASE_BEGIN("scrambler_packed matches scrambler")
+    {
+        enum { N = 1003 };
+        uint8_t bits[N], back[N];
+        BitVec v;
+        bitvec_init(&v, N);
+
+        int ok = 1;
+        uint16_t polys[2] = { 0x48, 0x6000 };   /* 802.11 and a 15-bit LFSR */
+        for (int p = 0; p < 2; p++) {
+            random_bits(bits, N);
+            bitvec_from_bits(&v, bits, N);
+            scrambler(polys[p], 0x5D, bits, N);
+            scrambler_packed(polys[p], 0x5D, &v);
+            bitvec_to_bits(&v, back);
+            for (int i = 0; i < N; i++)
+                if (bits[i] != back[i]) { ok = 0; break; }
+        }
+        bitvec_free(&v);
+        if (ok) { TEST_PASS_STMT; }
+        else    { TEST_FAIL_STMT("Packed keystream differs"); }
+    }
+    TEST_CASE_END();
+
     TEST_SUMMARY();
 }